@@ -0,0 +1,315 @@
+/*
+ * alloc.c: Memory allocator throughput benchmark
+ *
+ * Author: Michal Novotny <minovotn@redhat.com>
+ *
+ * Copyright (C) 2010 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+ *
+ */
+
+#include "utils.h"
+
+/* Time of one run in nanoseconds */
+#define ALLOC_TIME				100000000ULL
+/* Operations done between the checks of the stop flag */
+#define ALLOC_BATCH				256
+/* Live objects kept by every thread, each operation replaces a random one */
+#define ALLOC_SLOTS				4096
+/* Objects in flight from the producer to the consumer thread */
+#define ALLOC_QUEUE				1024
+#define ALLOC_LINE				128
+
+static const char *allocWorkloadNames[] = { "malloc", "realloc", "memalign", "cross-thread" };
+
+/* Single producer and single consumer ring of the objects freed by the other thread */
+typedef struct {
+	void *slot[ALLOC_QUEUE];
+	unsigned long head __attribute__((aligned(ALLOC_LINE)));
+	unsigned long tail __attribute__((aligned(ALLOC_LINE)));
+} __attribute__((aligned(ALLOC_LINE))) tAllocQueue;
+
+typedef struct {
+	tThread thread;
+	int workload;
+	int *stop;
+	tAllocQueue *queues;
+	unsigned long rss;
+	unsigned long ops;
+	unsigned long long ns;
+} tAllocThread;
+
+static unsigned int alloc_random(unsigned int *seed)
+{
+	*seed ^= *seed << 13;
+	*seed ^= *seed >> 17;
+	*seed ^= *seed << 5;
+
+	return *seed;
+}
+
+/*
+ * Returns the size of the object, most of the objects are small like in the real programs: 70% of them have
+ * 16 to 128 bytes, 20% up to 1 KiB, 8% up to 8 KiB and 2% up to 64 KiB
+ */
+static size_t alloc_size(unsigned int *seed)
+{
+	unsigned int r = alloc_random(seed);
+	unsigned int pct = r % 100;
+
+	r >>= 8;
+	if (pct < 70)
+		return 16 + r % 113;
+	if (pct < 90)
+		return 128 + r % 897;
+	if (pct < 98)
+		return 1024 + r % 7169;
+
+	return 8192 + r % 57345;
+}
+
+static void alloc_touch(char *p, size_t size)
+{
+	if (p != NULL) {
+		p[0] = 1;
+		p[size - 1] = 1;
+	}
+}
+
+static int alloc_queue_push(tAllocQueue *q, void *p)
+{
+	unsigned long tail = q->tail;
+
+	if (tail - __atomic_load_n(&q->head, __ATOMIC_ACQUIRE) >= ALLOC_QUEUE)
+		return 0;
+
+	q->slot[tail % ALLOC_QUEUE] = p;
+	__atomic_store_n(&q->tail, tail + 1, __ATOMIC_RELEASE);
+	return 1;
+}
+
+static void *alloc_queue_pop(tAllocQueue *q)
+{
+	unsigned long head = q->head;
+	void *p;
+
+	if (head == __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE))
+		return NULL;
+
+	p = q->slot[head % ALLOC_QUEUE];
+	__atomic_store_n(&q->head, head + 1, __ATOMIC_RELEASE);
+	return p;
+}
+
+/* Returns the resident set size of the process in KiB */
+static unsigned long alloc_rss(void)
+{
+	unsigned long size, rss = 0;
+	FILE *fp;
+
+	if ((fp = fopen("/proc/self/statm", "r")) == NULL)
+		return 0;
+	if (fscanf(fp, "%lu %lu", &size, &rss) != 2)
+		rss = 0;
+	fclose(fp);
+
+	return rss * (sysconf(_SC_PAGESIZE) >> 10);
+}
+
+/* Replaces the random live object by a new one of a random size */
+static void alloc_local(int workload, void **slots, unsigned int *seed)
+{
+	unsigned int idx = alloc_random(seed) % ALLOC_SLOTS;
+	size_t size = alloc_size(seed);
+	void *p;
+
+	switch (workload) {
+		case ALLOC_MALLOC:
+			free(slots[idx]);
+			slots[idx] = malloc(size);
+			break;
+		case ALLOC_REALLOC:
+			if ((p = realloc(slots[idx], size)) == NULL)
+				return;
+			slots[idx] = p;
+			break;
+		case ALLOC_MEMALIGN:
+			free(slots[idx]);
+			if (posix_memalign(&slots[idx], 16 << (alloc_random(seed) % 8), size) != 0)
+				slots[idx] = NULL;
+			break;
+	}
+
+	alloc_touch((char *)slots[idx], size);
+}
+
+/*
+ * Every thread either keeps its own set of the live objects or, for the cross-thread workload, allocates the
+ * objects for the next thread and frees the objects received from the previous one. The first thread stops
+ * all the threads once the time is over and gets the RSS with all the objects still allocated.
+ */
+static void *alloc_thread(void *arg)
+{
+	tAllocThread *t = (tAllocThread *)arg;
+	tAllocQueue *next, *own;
+	unsigned long long tm;
+	unsigned int seed;
+	void **slots = NULL;
+	size_t size;
+	void *p;
+	int i;
+
+	seed = 2463534242U + t->thread.idx * 7919;
+	own = &t->queues[t->thread.idx];
+	next = &t->queues[(t->thread.idx + 1) % t->thread.num];
+	if ((t->workload != ALLOC_CROSS) && ((slots = (void **)calloc(ALLOC_SLOTS, sizeof(void *))) == NULL))
+		__atomic_store_n(t->stop, 1, __ATOMIC_RELAXED);
+
+	tm = nanotime();
+	while (!__atomic_load_n(t->stop, __ATOMIC_RELAXED)) {
+		for (i = 0; i < ALLOC_BATCH; i++) {
+			if (t->workload != ALLOC_CROSS) {
+				alloc_local(t->workload, slots, &seed);
+				continue;
+			}
+
+			size = alloc_size(&seed);
+			p = malloc(size);
+			alloc_touch((char *)p, size);
+			if (!alloc_queue_push(next, p))
+				free(p);
+			free(alloc_queue_pop(own));
+		}
+		t->ops += ALLOC_BATCH;
+
+		if ((t->thread.idx == 0) && (nanotime() - tm >= ALLOC_TIME))
+			__atomic_store_n(t->stop, 1, __ATOMIC_RELAXED);
+	}
+	t->ns = nanotime() - tm;
+
+	pthread_barrier_wait(t->thread.barrier);
+	if (t->thread.idx == 0)
+		t->rss = alloc_rss();
+	pthread_barrier_wait(t->thread.barrier);
+
+	if (slots != NULL) {
+		for (i = 0; i < ALLOC_SLOTS; i++)
+			free(slots[i]);
+		free(slots);
+	}
+
+	return NULL;
+}
+
+/*
+ * Runs the allocator workload in the threads and stores the throughput in millions of the operations (an
+ * allocation and a free, or a realloc) per second to mops and the resident set size in KiB at the end of
+ * the run to rss.
+ */
+int alloc_get(int workload, int threads, float *mops, unsigned long *rss)
+{
+	tAllocThread *t;
+	tAllocQueue *queues;
+	unsigned long long ns = 0;
+	double ops = 0.0;
+	int i, rc, stop = 0;
+	void *p;
+
+	if ((workload < 0) || (workload >= ALLOC_WORKLOADS) || (threads <= 0))
+		return -EINVAL;
+
+	if (posix_memalign((void **)&queues, ALLOC_LINE, threads * sizeof(tAllocQueue)) != 0)
+		return -ENOMEM;
+
+	t = (tAllocThread *)malloc( threads * sizeof(tAllocThread) );
+	if (t == NULL) {
+		free(queues);
+		return -ENOMEM;
+	}
+
+	memset(queues, 0, threads * sizeof(tAllocQueue));
+	memset(t, 0, threads * sizeof(tAllocThread));
+	for (i = 0; i < threads; i++) {
+		t[i].workload = workload;
+		t[i].stop = &stop;
+		t[i].queues = queues;
+	}
+
+	rc = cpu_threads_run(threads, alloc_thread, t, sizeof(tAllocThread));
+	if (rc == 0) {
+		for (i = 0; i < threads; i++) {
+			ops += t[i].ops;
+			if (t[i].ns > ns)
+				ns = t[i].ns;
+		}
+
+		*mops = (ns > 0) ? ops * 1000.0 / ns : 0.0;
+		*rss = t[0].rss;
+	}
+
+	/* The objects left in flight when the threads stopped */
+	for (i = 0; i < threads; i++)
+		while ((p = alloc_queue_pop(&queues[i])) != NULL)
+			free(p);
+
+	free(queues);
+	free(t);
+
+	return rc;
+}
+
+/* Returns the peak resident set size of the process in KiB */
+unsigned long alloc_peak_rss(void)
+{
+	struct rusage usage;
+
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0;
+
+	return usage.ru_maxrss;
+}
+
+/* Gets the name of the allocator, i.e. of a known allocator library mapped to the process or glibc */
+char *alloc_name(char *buf, int len)
+{
+	static const char *libs[] = { "jemalloc", "tcmalloc", "mimalloc", "hoard", "snmalloc", NULL };
+	char line[1024];
+	FILE *fp;
+	int i;
+
+	snprintf(buf, len, "glibc");
+	if ((fp = fopen("/proc/self/maps", "r")) == NULL)
+		return buf;
+
+	while (fgets(line, sizeof(line), fp) != NULL)
+		for (i = 0; libs[i] != NULL; i++)
+			if (strstr(line, libs[i]) != NULL) {
+				snprintf(buf, len, "%s", libs[i]);
+				fclose(fp);
+				return buf;
+			}
+
+	fclose(fp);
+	return buf;
+}
+
+const char *alloc_workload_name(int workload)
+{
+	if ((workload < 0) || (workload >= ALLOC_WORKLOADS))
+		return NULL;
+
+	return allocWorkloadNames[workload];
+}
@@ -23,12 +23,143 @@
 
 #include "utils.h"
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+/* Time of the TSC calibration against the system clock in nanoseconds */
+#define TIMER_CALIBRATE_NS		20000000ULL
+/* Number of the timer reads to measure the overhead and resolution */
+#define TIMER_MEASURE_LOOPS		100000
+
+static const char *timerSourceNames[] = { "clock", "tsc" };
+
+static int timerSource = -1;
+static double timerTscScale;			/* nanoseconds per TSC tick */
+static unsigned long long timerTscBase;
+static unsigned long long timerNsBase;
+static double timerResolution;
+static double timerOverhead;
+
+static unsigned long long timer_clock_ns(void)
+{
+	struct timespec ts;
+
+#ifdef CLOCK_MONOTONIC_RAW
+	clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+#else
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+	return ((unsigned long long)ts.tv_sec * NSEC_PER_SEC) + ts.tv_nsec;
+}
+
+/* The TSC can be used as the wall clock only when it runs at the constant rate in all the P- and C-states */
+static int timer_tsc_invariant(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	unsigned int eax, ebx, ecx, edx;
+
+	if ((__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) == 0) || (eax < 0x80000007))
+		return 0;
+	if (__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) == 0)
+		return 0;
+
+	return (edx >> 8) & 1;
+#else
+	return 0;
+#endif
+}
+
+static int timer_tsc_calibrate(void)
+{
+	unsigned long long ns0, ns1, tsc0, tsc1;
+
+	ns0 = timer_clock_ns();
+	tsc0 = rdtsc();
+	while ((ns1 = timer_clock_ns()) - ns0 < TIMER_CALIBRATE_NS)
+		;
+	tsc1 = rdtsc();
+
+	if (tsc1 <= tsc0)
+		return -EINVAL;
+
+	timerTscScale = (double)(ns1 - ns0) / (tsc1 - tsc0);
+	timerTscBase = tsc1;
+	timerNsBase = ns1;
+
+	return 0;
+}
+
+/* Measures the mean cost of one nanotime() call and the smallest step it can return */
+static void timer_measure(void)
+{
+	unsigned long long t0, t1, step = ~0ULL;
+	int i;
+
+	t0 = nanotime();
+	for (i = 0; i < TIMER_MEASURE_LOOPS; i++)
+		nanotime();
+	timerOverhead = (double)(nanotime() - t0) / (TIMER_MEASURE_LOOPS + 1);
+
+	for (i = 0; i < 100; i++) {
+		t0 = nanotime();
+		while ((t1 = nanotime()) == t0)
+			;
+		if (t1 - t0 < step)
+			step = t1 - t0;
+	}
+	timerResolution = step;
+}
+
+/*
+ * Selects the source of nanotime(). TIMER_SOURCE_AUTO selects the TSC when it's invariant and the system clock
+ * (CLOCK_MONOTONIC_RAW) otherwise. The TSC is calibrated against the system clock and both of the sources share
+ * the same time base so the values can be compared even across the change of the source. Returns the selected
+ * source, the system clock is used when the TSC was requested but it cannot be used.
+ */
+int timer_init(int source)
+{
+	timerSource = TIMER_SOURCE_CLOCK;
+	if ((source != TIMER_SOURCE_CLOCK) && timer_tsc_invariant() && (timer_tsc_calibrate() == 0))
+		timerSource = TIMER_SOURCE_TSC;
+
+	timer_measure();
+	return timerSource;
+}
+
+/* Returns the source of nanotime(), its resolution and overhead in nanoseconds and the TSC frequency in MHz */
+int timer_info_get(double *resolution, double *overhead, double *tscMHz)
+{
+	if (timerSource < 0)
+		timer_init(TIMER_SOURCE_AUTO);
+
+	if (resolution != NULL)
+		*resolution = timerResolution;
+	if (overhead != NULL)
+		*overhead = timerOverhead;
+	if (tscMHz != NULL)
+		*tscMHz = (timerSource == TIMER_SOURCE_TSC) ? 1000.0 / timerTscScale : 0.0;
+
+	return timerSource;
+}
+
+const char *timer_source_name(int source)
+{
+	if ((source < 0) || (source > TIMER_SOURCE_TSC))
+		return NULL;
+
+	return timerSourceNames[source];
+}
+
+/* Returns the monotonic time in nanoseconds */
 unsigned long long nanotime(void)
 {
-	struct timeval tv;
+	if (timerSource == TIMER_SOURCE_TSC)
+		return timerNsBase + (unsigned long long)((double)(rdtsc() - timerTscBase) * timerTscScale);
+	if (timerSource < 0)
+		timer_init(TIMER_SOURCE_AUTO);
 
-	gettimeofday(&tv, NULL);
-	return (((unsigned long long)tv.tv_sec * 1000000) + tv.tv_usec);
+	return timer_clock_ns();
 }
 
 float calc_cpu_usage(float cpu, float tm)
@@ -0,0 +1,236 @@
+/*
+ * copy.c: Memory copy and fill throughput benchmark
+ *
+ * Author: Michal Novotny <minovotn@redhat.com>
+ *
+ * Copyright (C) 2010 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+ *
+ */
+
+#include "utils.h"
+
+/* Non-temporal stores are available on x86 with SSE2 only */
+#ifdef __SSE2__
+#define COPY_STREAM_STORES
+#include <emmintrin.h>
+#endif
+
+/* Bytes processed by one sample at least and the number of the samples, the best sample is taken */
+#define COPY_BYTES				(32ULL << 20)
+#define COPY_SAMPLES			3
+/* Buffers start at this alignment before the offsets are applied */
+#define COPY_ALIGN				4096
+/* Distance of the destination from the source of memmove(), the regions overlap for the bigger sizes */
+#define COPY_SHIFT				256
+/* Smaller blocks are not worth streaming around the caches */
+#define COPY_NT_MIN				256
+
+static const char *copyFuncNames[] = { "memcpy", "memcpy-nt", "memmove", "memset", "memset-nt" };
+/* Source and destination offsets from the page boundary */
+static const int copyAlignSrc[] = { 0, 0, 1, 8 };
+static const int copyAlignDst[] = { 0, 1, 0, 8 };
+
+/* Copies n bytes by the non-temporal stores, the destination is aligned to 16 bytes by a regular copy first */
+static void copy_memcpy_nt(char *dst, const char *src, size_t n)
+{
+#ifdef COPY_STREAM_STORES
+	size_t head;
+
+	if (n < COPY_NT_MIN) {
+		memcpy(dst, src, n);
+		return;
+	}
+
+	head = (16 - ((uintptr_t)dst & 15)) & 15;
+	memcpy(dst, src, head);
+	dst += head;
+	src += head;
+	n -= head;
+
+	for (; n >= 64; n -= 64, dst += 64, src += 64) {
+		_mm_stream_si128((__m128i *)dst, _mm_loadu_si128((const __m128i *)src));
+		_mm_stream_si128((__m128i *)(dst + 16), _mm_loadu_si128((const __m128i *)(src + 16)));
+		_mm_stream_si128((__m128i *)(dst + 32), _mm_loadu_si128((const __m128i *)(src + 32)));
+		_mm_stream_si128((__m128i *)(dst + 48), _mm_loadu_si128((const __m128i *)(src + 48)));
+	}
+	_mm_sfence();
+	memcpy(dst, src, n);
+#else
+	memcpy(dst, src, n);
+#endif
+}
+
+static void copy_memset_nt(char *dst, int c, size_t n)
+{
+#ifdef COPY_STREAM_STORES
+	__m128i v = _mm_set1_epi8((char)c);
+	size_t head;
+
+	if (n < COPY_NT_MIN) {
+		memset(dst, c, n);
+		return;
+	}
+
+	head = (16 - ((uintptr_t)dst & 15)) & 15;
+	memset(dst, c, head);
+	dst += head;
+	n -= head;
+
+	for (; n >= 64; n -= 64, dst += 64) {
+		_mm_stream_si128((__m128i *)dst, v);
+		_mm_stream_si128((__m128i *)(dst + 16), v);
+		_mm_stream_si128((__m128i *)(dst + 32), v);
+		_mm_stream_si128((__m128i *)(dst + 48), v);
+	}
+	_mm_sfence();
+	memset(dst, c, n);
+#else
+	memset(dst, c, n);
+#endif
+}
+
+/* The compiler barrier keeps the calls with the same arguments from being merged */
+static void copy_loop(int func, char *dst, char *src, size_t size, unsigned long loops)
+{
+	unsigned long i;
+
+	for (i = 0; i < loops; i++) {
+		switch (func) {
+			case COPY_MEMCPY:
+				memcpy(dst, src, size);
+				break;
+			case COPY_MEMCPY_NT:
+				copy_memcpy_nt(dst, src, size);
+				break;
+			case COPY_MEMMOVE:
+				memmove(dst, src, size);
+				break;
+			case COPY_MEMSET:
+				memset(dst, (int)i, size);
+				break;
+			case COPY_MEMSET_NT:
+				copy_memset_nt(dst, (int)i, size);
+				break;
+		}
+		__asm__ __volatile__("" : : "r"(dst) : "memory");
+	}
+}
+
+/*
+ * Gets the throughput in GB/s of the function on blocks of size bytes for every alignment case. The source and
+ * destination buffers are allocated by the caller to hold maxsize bytes and the block is processed repeatedly,
+ * so the small blocks stay in the caches unless non-temporal stores are used. memmove() moves the block within
+ * the source buffer by COPY_SHIFT bytes up, i.e. the regions overlap and it has to copy backwards.
+ */
+static void copy_size_get(int func, char *src, char *dst, size_t size, float *gbps)
+{
+	unsigned long long tm;
+	unsigned long loops;
+	char *s, *d;
+	double val;
+	int a, i;
+
+	loops = (size < COPY_BYTES) ? COPY_BYTES / size : 1;
+	for (a = 0; a < COPY_ALIGNS; a++) {
+		s = src + copyAlignSrc[a];
+		d = (func == COPY_MEMMOVE) ? src + COPY_SHIFT + copyAlignDst[a] : dst + copyAlignDst[a];
+
+		gbps[a] = 0.0;
+		copy_loop(func, d, s, size, 1);
+		for (i = 0; i < COPY_SAMPLES; i++) {
+			tm = nanotime();
+			copy_loop(func, d, s, size, loops);
+			tm = nanotime() - tm;
+
+			val = (tm > 0) ? (double)size * loops / tm : 0.0;
+			if (val > gbps[a])
+				gbps[a] = val;
+		}
+	}
+}
+
+/*
+ * Runs all the functions for the block sizes from COPY_MIN_SIZE up to maxsize growing by a factor of
+ * COPY_SIZE_STEP, the maxsize itself is the last size when it doesn't fit the steps. Up to num results are
+ * stored to res and the number of the sizes is returned, or a negative errno value on error.
+ */
+int copy_get(unsigned long long maxsize, tCopyResults *res, int num)
+{
+	unsigned long long size;
+	char *src, *dst;
+	size_t len;
+	int f, n = 0;
+
+	if ((maxsize < COPY_MIN_SIZE) || (res == NULL) || (num <= 0))
+		return -EINVAL;
+
+	len = maxsize + COPY_SHIFT + COPY_ALIGN;
+	if (posix_memalign((void **)&src, COPY_ALIGN, len) != 0)
+		return -ENOMEM;
+	if (posix_memalign((void **)&dst, COPY_ALIGN, len) != 0) {
+		free(src);
+		return -ENOMEM;
+	}
+
+	/* Fault the buffers in so the page faults are not measured */
+	memset(src, 1, len);
+	memset(dst, 2, len);
+
+	for (size = COPY_MIN_SIZE; n < num; size *= COPY_SIZE_STEP) {
+		if (size > maxsize)
+			size = maxsize;
+
+		res[n].size = size;
+		for (f = 0; f < COPY_FUNCS; f++)
+			copy_size_get(f, src, dst, size, res[n].gbps[f]);
+		n++;
+
+		if (size == maxsize)
+			break;
+	}
+
+	free(src);
+	free(dst);
+	return n;
+}
+
+/* Returns the number of the sizes copy_get() runs for maxsize */
+int copy_sizes(unsigned long long maxsize)
+{
+	unsigned long long size;
+	int n = 0;
+
+	for (size = COPY_MIN_SIZE; size < maxsize; size *= COPY_SIZE_STEP)
+		n++;
+
+	return n + 1;
+}
+
+const char *copy_func_name(int func)
+{
+	if ((func < 0) || (func >= COPY_FUNCS))
+		return NULL;
+
+	return copyFuncNames[func];
+}
+
+/* Gets the source and destination offsets of the alignment case */
+void copy_align_get(int align, int *src, int *dst)
+{
+	*src = copyAlignSrc[align];
+	*dst = copyAlignDst[align];
+}
@@ -23,16 +23,52 @@
 
 /*
  * The MEASURE_TIMEVAL constant defines the time value between measuring is done.  The value is being
- * presented in nanoseconds and the value 1000000 (1s) is the most precise value, any higher value just
- * slows it down with no real effect. Setting up lower values than 10000 (10 ms) may produce inaccurate
+ * presented in nanoseconds and the value 1000000000 (1s) is the most precise value, any higher value just
+ * slows it down with no real effect. Setting up lower values than 10000000 (10 ms) may produce inaccurate
  * and very fluctuating results!
- * If you don't need the precision to 1/100th of the Mhz the optimal value is 50ms (i.e. value 50000).
+ * If you don't need the precision to 1/100th of the Mhz the optimal value is 50ms (i.e. value 50000000).
  */
 
-#define MEASURE_TIMEVAL 50000
+#define MEASURE_TIMEVAL 50000000ULL
+
+/* Highest number of the CPUs the CPU sets may grow to */
+#define CPUSET_MAX_CPUS			65536
+
+/* Time of one frequency measurement in nanoseconds */
+#define FREQ_MEASURE_TIME		100000000ULL
+/* Iterations of the dependent-add loop between the checks of the time */
+#define FREQ_CHUNK				10000
+/* Round trips of the cache line per core-to-core sample, the first sample is the warm-up */
+#define C2C_ROUNDS				5000
+#define C2C_SAMPLES				6
+#define C2C_LINE				128
+/* APERF and MPERF model specific registers */
+#define MSR_IA32_MPERF			0xe7
+#define MSR_IA32_APERF			0xe8
 
 #include "utils.h"
 
+static const char *cpuFreqMethods[] = { "aperf-mperf", "dependent-add" };
+
+/* The line bounced between the threads, aligned and padded so nothing else shares it or its prefetch pair */
+typedef struct {
+	int seq;
+	char pad[C2C_LINE - sizeof(int)];
+} __attribute__((aligned(C2C_LINE))) tC2CLine;
+
+typedef struct {
+	tThread thread;
+	tC2CLine *line;
+	double ns;
+} tC2CThread;
+
+typedef struct {
+	tThread thread;
+	int method;
+	double tscMHz;
+	float mhz;
+} tFreqThread;
+
 uint32_t cpu_get_count(void)
 {
 	long conf, online;
@@ -64,47 +100,579 @@ float cpu_get_speed_mhz(void)
 
 	diff1 = (unsigned long long)( (unsigned long long)val22 - (unsigned long long)val21 );
 	diff2 = (unsigned long long)( (unsigned long long)val12 - (unsigned long long)val11 );
-	return ((float)diff1 / diff2);
+	return ((float)diff1 * 1000.0 / diff2);
+}
+
+/* Returns the default number of the CPUs for the sets, at least CPU_SETSIZE and all the configured CPUs */
+static int cpu_set_default_max(void)
+{
+	int conf = sysconf(_SC_NPROCESSORS_CONF);
+
+	return (conf > CPU_SETSIZE) ? conf : CPU_SETSIZE;
+}
+
+/*
+ * Allocates the empty set of CPUs for CPUs 0 to max - 1 (or the default number of the CPUs if max is not
+ * positive). The set has to be freed by cpu_set_free().
+ */
+int cpu_set_init(tCpuSet *set, int max)
+{
+	if (max <= 0)
+		max = cpu_set_default_max();
+
+	set->set = CPU_ALLOC(max);
+	if (set->set == NULL)
+		return -ENOMEM;
+
+	set->size = CPU_ALLOC_SIZE(max);
+	set->max = set->size * 8;
+	CPU_ZERO_S(set->size, set->set);
+
+	return 0;
+}
+
+void cpu_set_free(tCpuSet *set)
+{
+	if (set->set != NULL)
+		CPU_FREE(set->set);
+
+	set->set = NULL;
+	set->size = 0;
+	set->max = 0;
+}
+
+/* Adds the CPU to the set, the set grows when the CPU doesn't fit it */
+int cpu_set_add(tCpuSet *set, int cpu)
+{
+	tCpuSet tmp;
+	int rc;
+
+	if ((cpu < 0) || (cpu >= CPUSET_MAX_CPUS))
+		return -EINVAL;
+
+	if (cpu >= set->max) {
+		if ((rc = cpu_set_init(&tmp, cpu + 1)) != 0)
+			return rc;
+
+		memcpy(tmp.set, set->set, set->size);
+		cpu_set_free(set);
+		*set = tmp;
+	}
+
+	CPU_SET_S(cpu, set->size, set->set);
+	return 0;
+}
+
+int cpu_set_isset(const tCpuSet *set, int cpu)
+{
+	return (cpu >= 0) && (cpu < set->max) && CPU_ISSET_S(cpu, set->size, set->set);
+}
+
+int cpu_set_count(const tCpuSet *set)
+{
+	return CPU_COUNT_S(set->size, set->set);
+}
+
+/* Returns the first CPU of the set after the CPU (use -1 to get the first one), -1 when there is none */
+int cpu_set_next(const tCpuSet *set, int cpu)
+{
+	for (cpu++; cpu < set->max; cpu++)
+		if (CPU_ISSET_S(cpu, set->size, set->set))
+			return cpu;
+
+	return -1;
+}
+
+/*
+ * Formats the set as the list of CPUs like "0-15,64-79" when list is set or as the hexadecimal mask like
+ * "0xff0000000000ffff" otherwise. The returned string has to be freed by the caller.
+ */
+char *cpu_set_format(const tCpuSet *set, int list)
+{
+	char *str, *p;
+	int cpu, last, digit, len;
+
+	len = list ? set->max * 12 + 1 : set->max / 4 + 3;
+	if ((str = (char *)malloc(len)) == NULL)
+		return NULL;
+
+	p = str;
+	*p = 0;
+	if (list) {
+		for (cpu = cpu_set_next(set, -1); cpu >= 0; cpu = cpu_set_next(set, last)) {
+			for (last = cpu; cpu_set_isset(set, last + 1); last++)
+				;
+
+			p += sprintf(p, (p != str) ? ",%d" : "%d", cpu);
+			if (last > cpu)
+				p += sprintf(p, "-%d", last);
+		}
+
+		return str;
+	}
+
+	p += sprintf(p, "0x");
+	for (digit = (set->max - 1) / 4; digit >= 0; digit--) {
+		int val = 0;
+
+		for (cpu = 0; cpu < 4; cpu++)
+			if (cpu_set_isset(set, digit * 4 + cpu))
+				val |= 1 << cpu;
+
+		/* Leave out the leading zeros but the last digit */
+		if ((val != 0) || (p - str > 2) || (digit == 0))
+			p += sprintf(p, "%x", val);
+	}
+
+	return str;
+}
+
+/*
+ * Parses the list of CPUs (or NUMA nodes) in the sysfs format, e.g. "0-3,8,10-11", to the initialized set.
+ * Returns the number of the entries in the list or -EINVAL when the list is invalid.
+ */
+int cpu_list_parse(const char *list, tCpuSet *set)
+{
+	char *end;
+	long first, last;
+	int num = 0;
+
+	CPU_ZERO_S(set->size, set->set);
+	while ((*list != 0) && (*list != '\n')) {
+		first = last = strtol(list, &end, 10);
+		if ((end == list) || (first < 0))
+			return -EINVAL;
+		if (*end == '-') {
+			list = end + 1;
+			last = strtol(list, &end, 10);
+			if ((end == list) || (last < first))
+				return -EINVAL;
+		}
+
+		for (; first <= last; first++, num++)
+			if (cpu_set_add(set, first) != 0)
+				return -EINVAL;
+
+		list = end;
+		if (*list == ',')
+			list++;
+	}
+
+	return num;
+}
+
+/*
+ * Parses the CPUs for the affinity to the initialized set. The CPUs are either the hexadecimal mask of any
+ * length starting with 0x (commas between the 32-bit words are allowed as in /proc), the list like
+ * "0-15,64-79" or the decimal mask for up to 64 CPUs. Returns the number of the CPUs or -EINVAL.
+ */
+int cpu_set_parse(const char *str, tCpuSet *set)
+{
+	const char *p;
+	int i, bit = 0, val;
+
+	if (strncmp(str, "0x", 2) != 0) {
+		unsigned long long mask;
+		char *end;
+
+		if (strpbrk(str, ",-") != NULL)
+			return cpu_list_parse(str, set);
+
+		mask = strtoull(str, &end, 10);
+		if ((end == str) || (*end != 0))
+			return -EINVAL;
+
+		CPU_ZERO_S(set->size, set->set);
+		for (bit = 0; bit < 64; bit++)
+			if (mask & (1ULL << bit))
+				cpu_set_add(set, bit);
+
+		return cpu_set_count(set);
+	}
+
+	CPU_ZERO_S(set->size, set->set);
+	for (p = str + strlen(str) - 1; p >= str + 2; p--) {
+		if (*p == ',')
+			continue;
+		if (!isxdigit(*p))
+			return -EINVAL;
+
+		val = isdigit(*p) ? *p - '0' : tolower(*p) - 'a' + 10;
+		for (i = 0; i < 4; i++)
+			if ((val & (1 << i)) && (cpu_set_add(set, bit + i) != 0))
+				return -EINVAL;
+		bit += 4;
+	}
+
+	return cpu_set_count(set);
 }
 
-int cpu_affinity_get(pid_t pid, uint64_t *cmask)
+/*
+ * Gets the affinity of the process (or thread) to the set which is allocated here, large enough for all the
+ * CPUs of the kernel, and has to be freed by cpu_set_free(). Returns the number of the CPUs in the set.
+ */
+int cpu_affinity_get(pid_t pid, tCpuSet *set)
 {
-	cpu_set_t mask;
-	int i;
-	int cpucount = sysconf(_SC_NPROCESSORS_ONLN);
-	int nrcpus = cpucount;
+	int max, rc;
+
+	for (max = cpu_set_default_max(); ; max *= 2) {
+		if ((rc = cpu_set_init(set, max)) != 0)
+			return rc;
+		if (sched_getaffinity(pid, set->size, set->set) == 0)
+			return cpu_set_count(set);
 
-	if (cmask == NULL)
-		return nrcpus;
+		/* The set is smaller than the CPU mask of the kernel */
+		rc = -errno;
+		cpu_set_free(set);
+		if ((rc != -EINVAL) || (max >= CPUSET_MAX_CPUS))
+			return rc;
+	}
+}
 
-	if ( sched_getaffinity(pid, sizeof(mask), &mask) == -1 )
+int cpu_affinity_set(pid_t pid, const tCpuSet *set)
+{
+	if ( sched_setaffinity(pid, set->size, set->set) == -1 )
 		return -errno;
 
-	*cmask = 0;
-	for ( i = 0; i < nrcpus; i++ )
-		if ( CPU_ISSET(i, &mask) )
-			*cmask |= (1 << i);
+	return 0;
+}
 
-	return nrcpus;
+/* Pins the process (or thread) to the single CPU */
+int cpu_affinity_set_cpu(pid_t pid, int cpu)
+{
+	tCpuSet set;
+	int rc;
+
+	if ((rc = cpu_set_init(&set, cpu + 1)) != 0)
+		return rc;
+
+	if ((rc = cpu_set_add(&set, cpu)) == 0)
+		rc = cpu_affinity_set(pid, &set);
+
+	cpu_set_free(&set);
+	return rc;
 }
 
-int cpu_affinity_set(pid_t pid, uint64_t cmask)
+int cpu_thread_count(void)
 {
-	cpu_set_t mask;
+	tCpuSet set;
+	int num;
+
+	num = cpu_affinity_get(0, &set);
+	if (num >= 0)
+		cpu_set_free(&set);
+
+	return num;
+}
+
+/*
+ * Returns the CPU the idx-th benchmark thread should be pinned to. CPUs are taken from the affinity
+ * mask of the process in ascending order and wrapped around if there are more threads than CPUs.
+ */
+int cpu_thread_get_cpu(int idx)
+{
+	tCpuSet set;
+	int cpu, count;
+
+	if ( (count = cpu_affinity_get(0, &set)) < 0 )
+		return -1;
+
+	cpu = -1;
+	if (count > 0)
+		for (idx %= count, cpu = cpu_set_next(&set, -1); idx > 0; idx--)
+			cpu = cpu_set_next(&set, cpu);
+
+	cpu_set_free(&set);
+	return cpu;
+}
+
+struct tThreadGate {
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	int state;
+};
+
+static void *cpu_thread_start(void *arg)
+{
+	tThread *t = (tThread *)arg;
+	int state;
+
+	if (t->cpu >= 0)
+		cpu_affinity_set_cpu(syscall(SYS_gettid), t->cpu);
+
+	pthread_mutex_lock(&t->gate->lock);
+	while (t->gate->state == 0)
+		pthread_cond_wait(&t->gate->cond, &t->gate->lock);
+	state = t->gate->state;
+	pthread_mutex_unlock(&t->gate->lock);
+
+	/* Thread creation failed for some of the threads so don't run at all */
+	if (state < 0)
+		return NULL;
+
+	pthread_barrier_wait(t->barrier);
+	return t->func(arg);
+}
+
+/*
+ * Runs func() in num threads at once. The args array holds num elements of argsize bytes each and every
+ * element has to start with the tThread structure which is filled here. All the threads are pinned to
+ * their CPUs first and they are released together once all of them are created. The threads are pinned
+ * to the CPUs from the cpus array, or to the CPUs given by cpu_thread_get_cpu() when it's NULL.
+ */
+int cpu_threads_run_on(int num, int *cpus, void *(*func)(void *), void *args, size_t argsize)
+{
+	pthread_t *tids;
+	pthread_barrier_t barrier;
+	tThreadGate gate;
+	int i, created, rc = 0;
+
+	if ((num <= 0) || (func == NULL) || (args == NULL))
+		return -EINVAL;
+
+	tids = (pthread_t *)malloc( num * sizeof(pthread_t) );
+	if (tids == NULL)
+		return -ENOMEM;
+
+	pthread_barrier_init(&barrier, NULL, num);
+	pthread_mutex_init(&gate.lock, NULL);
+	pthread_cond_init(&gate.cond, NULL);
+	gate.state = 0;
+
+	for (created = 0; created < num; created++) {
+		tThread *t = (tThread *)((char *)args + created * argsize);
+
+		t->idx = created;
+		t->num = num;
+		t->cpu = (cpus != NULL) ? cpus[created] : cpu_thread_get_cpu(created);
+		t->barrier = &barrier;
+		t->func = func;
+		t->gate = &gate;
+
+		if ((rc = pthread_create(&tids[created], NULL, cpu_thread_start, t)) != 0) {
+			rc = -rc;
+			break;
+		}
+	}
+
+	pthread_mutex_lock(&gate.lock);
+	gate.state = (rc == 0) ? 1 : -1;
+	pthread_cond_broadcast(&gate.cond);
+	pthread_mutex_unlock(&gate.lock);
+
+	for (i = 0; i < created; i++)
+		pthread_join(tids[i], NULL);
+
+	pthread_cond_destroy(&gate.cond);
+	pthread_mutex_destroy(&gate.lock);
+	pthread_barrier_destroy(&barrier);
+	free(tids);
+
+	return rc;
+}
+
+int cpu_threads_run(int num, void *(*func)(void *), void *args, size_t argsize)
+{
+	return cpu_threads_run_on(num, NULL, func, args, argsize);
+}
+
+/*
+ * Adds done by one iteration of cpu_freq_spin(), every add depends on the previous one and takes one cycle.
+ * The register operand is used as the chains of the immediate adds are folded by some of the newer CPUs.
+ */
+#define FREQ_ADDS				64
+#define FREQ_ADD				"add %1, %0\n\t"
+#define FREQ_ADD_GENERIC		x += y; __asm__ volatile("" : "+r" (x));
+#define FREQ_ADD_GENERIC8		FREQ_ADD_GENERIC FREQ_ADD_GENERIC FREQ_ADD_GENERIC FREQ_ADD_GENERIC \
+								FREQ_ADD_GENERIC FREQ_ADD_GENERIC FREQ_ADD_GENERIC FREQ_ADD_GENERIC
+
+static unsigned long cpu_freq_spin(long iters)
+{
+	unsigned long x = 0, y = 1;
+
+	/* Hide the value of y from the compiler to keep the register operand */
+	__asm__ volatile("" : "+r" (y));
+	while (iters-- > 0) {
+#if defined(__x86_64__) || defined(__i386__)
+		__asm__ volatile(".rept 64\n\t" FREQ_ADD ".endr" : "+r" (x) : "r" (y));
+#else
+		FREQ_ADD_GENERIC8 FREQ_ADD_GENERIC8 FREQ_ADD_GENERIC8 FREQ_ADD_GENERIC8
+		FREQ_ADD_GENERIC8 FREQ_ADD_GENERIC8 FREQ_ADD_GENERIC8 FREQ_ADD_GENERIC8
+#endif
+	}
+
+	return x;
+}
+
+static int cpu_msr_open(int cpu)
+{
+	char path[64];
+
+	snprintf(path, sizeof(path), "/dev/cpu/%d/msr", cpu);
+	return open(path, O_RDONLY);
+}
+
+static int cpu_msr_read(int fd, unsigned int msr, uint64_t *val)
+{
+	return (pread(fd, val, sizeof(*val), msr) == sizeof(*val)) ? 0 : -EIO;
+}
+
+static void *cpu_freq_thread(void *arg)
+{
+	tFreqThread *t = (tFreqThread *)arg;
+	uint64_t aperf0 = 0, mperf0 = 0, aperf1 = 0, mperf1 = 0;
+	unsigned long long tm;
+	long iters = 0;
+	int fd = -1;
+
+	if (t->method == CPU_FREQ_MSR) {
+		if ((fd = cpu_msr_open(t->thread.cpu)) < 0)
+			return NULL;
+		cpu_msr_read(fd, MSR_IA32_APERF, &aperf0);
+		cpu_msr_read(fd, MSR_IA32_MPERF, &mperf0);
+	}
+
+	tm = nanotime();
+	do {
+		cpu_freq_spin(FREQ_CHUNK);
+		iters += FREQ_CHUNK;
+	} while (nanotime() - tm < FREQ_MEASURE_TIME);
+	tm = nanotime() - tm;
+
+	if (fd >= 0) {
+		cpu_msr_read(fd, MSR_IA32_APERF, &aperf1);
+		cpu_msr_read(fd, MSR_IA32_MPERF, &mperf1);
+		close(fd);
+
+		/* APERF counts at the actual clock and MPERF at the TSC rate, both in C0 only */
+		if (mperf1 > mperf0)
+			t->mhz = t->tscMHz * (double)(aperf1 - aperf0) / (mperf1 - mperf0);
+	}
+	else
+		t->mhz = (double)iters * FREQ_ADDS * 1000.0 / tm;
+
+	return NULL;
+}
+
+/*
+ * Returns the method of the effective frequency measurement, APERF/MPERF when the MSRs of the CPU can be read
+ * (root and the msr kernel module are needed) or the dependent-add loop otherwise
+ */
+int cpu_freq_method(int cpu)
+{
+	uint64_t val;
+	int fd, rc;
+
+	if ((fd = cpu_msr_open(cpu)) < 0)
+		return CPU_FREQ_LOOP;
+
+	rc = cpu_msr_read(fd, MSR_IA32_MPERF, &val);
+	close(fd);
+
+	return (rc == 0) ? CPU_FREQ_MSR : CPU_FREQ_LOOP;
+}
+
+const char *cpu_freq_method_name(int method)
+{
+	if ((method < 0) || (method > CPU_FREQ_LOOP))
+		return NULL;
+
+	return cpuFreqMethods[method];
+}
+
+/*
+ * Measures the effective frequency of num CPUs from the cpus array loaded all at once by the busy loop. The
+ * frequency in MHz of each of the CPUs is stored to mhz[]. The method is one of CPU_FREQ_MSR or CPU_FREQ_LOOP,
+ * tscMHz is the TSC frequency needed by the former.
+ */
+int cpu_freq_get(int num, int *cpus, int method, double tscMHz, float *mhz)
+{
+	tFreqThread *t;
 	int i, rc;
-	int nrcpus;
 
-	rc = 0;
-	nrcpus = sysconf(_SC_NPROCESSORS_ONLN);
+	if ((num <= 0) || (cpus == NULL) || (mhz == NULL))
+		return -EINVAL;
 
-	CPU_ZERO(&mask);
-	for (i = 0; i < nrcpus; i++)
-		if (cmask & (1 << i))
-			CPU_SET(i, &mask);
+	t = (tFreqThread *)malloc( num * sizeof(tFreqThread) );
+	if (t == NULL)
+		return -ENOMEM;
 
-	if ( sched_setaffinity(pid, sizeof(mask), &mask) == -1 )
-		rc = -errno;
+	memset(t, 0, num * sizeof(tFreqThread));
+	for (i = 0; i < num; i++) {
+		t[i].method = method;
+		t[i].tscMHz = tscMHz;
+	}
 
+	rc = cpu_threads_run_on(num, cpus, cpu_freq_thread, t, sizeof(tFreqThread));
+	for (i = 0; (rc == 0) && (i < num); i++)
+		mhz[i] = t[i].mhz;
+
+	free(t);
 	return rc;
 }
 
+/*
+ * Bounces the cache line between the two threads: the first one writes the odd sequence number and waits
+ * for the even one written by the second thread in reply. The one-way latency is a half of the round trip.
+ */
+static void *cpu_c2c_thread(void *arg)
+{
+	tC2CThread *t = (tC2CThread *)arg;
+	int *seq = &t->line->seq;
+	unsigned long long tm;
+	int i, s, val;
+	double ns;
+
+	for (s = 0, val = 0; s < C2C_SAMPLES; s++) {
+		tm = nanotime();
+		for (i = 0; i < C2C_ROUNDS; i++, val += 2) {
+			if (t->thread.idx == 0) {
+				__atomic_store_n(seq, val + 1, __ATOMIC_RELEASE);
+				while (__atomic_load_n(seq, __ATOMIC_ACQUIRE) != val + 2)
+					;
+			}
+			else {
+				while (__atomic_load_n(seq, __ATOMIC_ACQUIRE) != val + 1)
+					;
+				__atomic_store_n(seq, val + 2, __ATOMIC_RELEASE);
+			}
+		}
+		tm = nanotime() - tm;
+
+		ns = tm / (2.0 * C2C_ROUNDS);
+		if ((s > 0) && ((t->ns == 0.0) || (ns < t->ns)))
+			t->ns = ns;
+	}
+
+	return NULL;
+}
+
+/*
+ * Gets the one-way latency in nanoseconds of the cache line transfer between two different CPUs. The best
+ * of the samples is taken as the interrupts and the other tasks may only make the round trips slower.
+ */
+int cpu_c2c_latency_get(int cpu1, int cpu2, double *ns)
+{
+	tC2CThread t[2];
+	tC2CLine *line;
+	int cpus[2], rc;
+
+	if ((cpu1 == cpu2) || (ns == NULL))
+		return -EINVAL;
+
+	if (posix_memalign((void **)&line, C2C_LINE, sizeof(tC2CLine)) != 0)
+		return -ENOMEM;
+
+	memset(line, 0, sizeof(tC2CLine));
+	memset(t, 0, sizeof(t));
+	t[0].line = t[1].line = line;
+	cpus[0] = cpu1;
+	cpus[1] = cpu2;
+
+	rc = cpu_threads_run_on(2, cpus, cpu_c2c_thread, t, sizeof(tC2CThread));
+	if (rc == 0)
+		*ns = t[0].ns;
+
+	free(line);
+	return rc;
+}
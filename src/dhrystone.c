@@ -170,20 +170,21 @@
  *
  */
 
-#include <stdlib.h>
-#include <stdio.h>
+#include "utils.h"
 #include <limits.h>
-#include <string.h>
 
 /* Accuracy of timings and human fatigue controlled by next two lines */
 #define LOOPS	50000000
+/* Loops between the samples of a sustained run, a power of two minus one */
+#define STEADY_LOOPS_MASK	0xffff
 
 /* Compiler dependent options */
 #undef	NOENUM			/* Define if compiler has no enum's */
 #undef	NOSTRUCTASSIGN		/* Define if compiler can't assign structures */
 /* define only one of the next three defines */
-#define TIMES			/* Use times(2) time function */
+//*#define TIMES			/* Use times(2) time function */
 //*#define TIME			/* Use time(2) time function */
+#define NANOTIME		/* Use nanotime() wall clock, valid per thread */
 
 /* define the granularity of your times(2) function (when used) */
 //#define HZ	CLK_TCK		/* on SGI, use this! */
@@ -191,10 +192,11 @@
 #define HZ	100		/* times(2) returns 1/100 second (WECo) */
 
 
-/* Variables */
-unsigned long uLoops;
-unsigned long uTime;
-unsigned long uDhrystone;
+/* Variables, thread local to allow running several instances at once */
+static __thread unsigned long uLoops;
+static __thread unsigned long uTime;
+static __thread unsigned long uDhrystone;
+static __thread tSteady *uSteady;
 
 #ifdef	NOSTRUCTASSIGN
 #define	structassign(d, s)	memcpy(&(d), &(s), sizeof(d))
@@ -270,17 +272,121 @@ void cpu_dhrystone_get(unsigned long *dhry, unsigned long *loops, unsigned long
 		*dhry = uDhrystone;
 }
 
+typedef struct {
+	tThread thread;
+	unsigned long dhry;
+} tDhryThread;
+
+static void *cpu_dhrystone_thread(void *arg)
+{
+	tDhryThread *t = (tDhryThread *)arg;
+
+	cpu_dhrystone_get(&t->dhry, NULL, NULL);
+	return NULL;
+}
+
+typedef struct {
+	tThread thread;
+	unsigned long long duration;
+	tSteady steady;
+} tDhrySteadyThread;
+
+static void *cpu_dhrystone_steady_thread(void *arg)
+{
+	tDhrySteadyThread *t = (tDhrySteadyThread *)arg;
+
+	uSteady = &t->steady;
+	while (nanotime() - t->steady.start < t->duration)
+		cpu_dhrystone_get(NULL, NULL, NULL);
+	uSteady = NULL;
+
+	return NULL;
+}
+
+/*
+ * Runs the Dhrystone benchmark in threads pinned to their CPUs for duration nanoseconds and stores the loops
+ * done by all of them in every interval to s, which is initialized here and freed by the caller. The run ends
+ * with the benchmark pass running at the end of the duration, its work after the end is not accounted.
+ */
+int cpu_dhrystone_steady(int threads, unsigned long long duration, unsigned long long interval, tSteady *s)
+{
+	tDhrySteadyThread *t;
+	unsigned long long start;
+	int i, rc;
+
+	if (threads <= 0)
+		return -EINVAL;
+
+	t = (tDhrySteadyThread *)malloc( threads * sizeof(tDhrySteadyThread) );
+	if (t == NULL)
+		return -ENOMEM;
+	memset(t, 0, threads * sizeof(tDhrySteadyThread));
+
+	start = nanotime();
+	if ((rc = steady_init(s, start, duration, interval)) != 0) {
+		free(t);
+		return rc;
+	}
+	for (i = 0; (rc == 0) && (i < threads); i++) {
+		t[i].duration = duration;
+		rc = steady_init(&t[i].steady, start, duration, interval);
+	}
+
+	if (rc == 0)
+		rc = cpu_threads_run(threads, cpu_dhrystone_steady_thread, t, sizeof(tDhrySteadyThread));
+
+	for (i = 0; i < threads; i++) {
+		steady_merge(s, &t[i].steady);
+		steady_free(&t[i].steady);
+	}
+	free(t);
+
+	if (rc != 0)
+		steady_free(s);
+	return rc;
+}
+
+/*
+ * Runs threads instances of the Dhrystone benchmark at once, each pinned to its own CPU. The
+ * Dhrystone score of each thread is stored to dhry[] and the CPU it was running on to cpus[].
+ */
+int cpu_dhrystone_threads_get(int threads, int *cpus, unsigned long *dhry)
+{
+	tDhryThread *t;
+	int i, rc;
+
+	if (threads <= 0)
+		return -EINVAL;
+
+	t = (tDhryThread *)malloc( threads * sizeof(tDhryThread) );
+	if (t == NULL)
+		return -ENOMEM;
+	memset(t, 0, threads * sizeof(tDhryThread));
+
+	rc = cpu_threads_run(threads, cpu_dhrystone_thread, t, sizeof(tDhryThread));
+
+	for (i = 0; i < threads; i++) {
+		if (cpus != NULL)
+			cpus[i] = t[i].thread.cpu;
+		if (dhry != NULL)
+			dhry[i] = t[i].dhry;
+	}
+
+	free(t);
+	return rc;
+}
+
 /*chh
  * Package 1
  */
-int		IntGlob;
-boolean		BoolGlob;
-char		Char1Glob;
-char		Char2Glob;
-Array1Dim	Array1Glob;
-Array2Dim	Array2Glob;
-RecordPtr	PtrGlb;
-RecordPtr	PtrGlbNext;
+static __thread int		IntGlob;
+static __thread boolean		BoolGlob;
+static __thread char		Char1Glob;
+static __thread char		Char2Glob;
+static __thread Array1Dim	Array1Glob;
+static __thread Array2Dim	Array2Glob;
+static __thread RecordPtr	PtrGlb;
+static __thread RecordPtr	PtrGlbNext;
 
 void Proc0(void)
 {
@@ -314,6 +420,15 @@ void Proc0(void)
 	times(&tms);
 	nulltime = tms.tms_utime - starttime; /* Computes overhead of looping */
 #endif
+#ifdef NANOTIME
+	unsigned long long	starttime;
+	unsigned long long	benchtime;
+	unsigned long long	nulltime;
+	register unsigned int	i;
+	starttime = nanotime();
+	for (i = 0; i < LOOPS; ++i);
+	nulltime = nanotime() - starttime; /* Computes overhead of looping */
+#endif
 
 	PtrGlbNext = (RecordPtr) malloc(sizeof(RecordType));
 	PtrGlb = (RecordPtr) malloc(sizeof(RecordType));
@@ -332,6 +447,9 @@ void Proc0(void)
 #ifdef TIMES
 	times(&tms); starttime = tms.tms_utime;
 #endif
+#ifdef NANOTIME
+	starttime = nanotime();
+#endif
 for (i = 0; i < LOOPS; ++i)
 {
 
@@ -357,6 +475,8 @@ for (i = 0; i < LOOPS; ++i)
 	IntLoc2 = IntLoc3 / IntLoc1;
 	IntLoc2 = 7 * (IntLoc3 - IntLoc2) - IntLoc1;
 	Proc2(&IntLoc1);
+	if (((i & STEADY_LOOPS_MASK) == STEADY_LOOPS_MASK) && (uSteady != NULL))
+		steady_tick(uSteady, STEADY_LOOPS_MASK + 1);
 
 /*****************
 -- Stop Timer --
@@ -375,7 +495,15 @@ for (i = 0; i < LOOPS; ++i)
 	uTime = benchtime / HZ;
 	uDhrystone = (unsigned long)((((unsigned long)LOOPS * HZ) / benchtime));
 #endif
+#ifdef NANOTIME
+	benchtime = nanotime() - starttime - nulltime;
+	uLoops = (unsigned long)LOOPS;
+	uTime = benchtime / NSEC_PER_SEC;
+	uDhrystone = (unsigned long)(((double)LOOPS * NSEC_PER_SEC) / benchtime);
+#endif
 
+	free(PtrGlb);
+	free(PtrGlbNext);
 }
 
 void Proc1(PtrParIn)
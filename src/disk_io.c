@@ -67,7 +67,7 @@ float disk_throughput_putc(long size, float *fcpu)
 		if (putc(words & 0x7f, fp) == EOF)
 			return 0;
 
-	tm = (nanotime() - start) / 1000000.0;
+	tm = (nanotime() - start) / (float)NSEC_PER_SEC;
 	if (fcpu != NULL)
 		*fcpu = calc_cpu_usage(cpu_time_get() - cpu_start, tm);
 
@@ -117,7 +117,7 @@ float disk_throughput_write(int chunkSize, long size, float *fcpu)
 			return 0;
 	}
 
-	tm = (nanotime() - start) / 1000000.0;
+	tm = (nanotime() - start) / (float)NSEC_PER_SEC;
 	if (fcpu != NULL)
 		*fcpu = calc_cpu_usage(cpu_time_get() - cpu_start, tm);
 
@@ -127,6 +127,66 @@ float disk_throughput_write(int chunkSize, long size, float *fcpu)
 	return (size / tm);
 }
 
+/*
+ * Writes the file sequentially by chunks with O_DIRECT like disk_throughput_write() until the end of the run
+ * of the sampler s, the bytes written in every interval are stored to s. The file is rewritten from its start
+ * every size bytes so the run doesn't take more disk space than the disk benchmark. Returns the average
+ * throughput of the whole run.
+ */
+float disk_throughput_steady(int chunkSize, long size, tSteady *s, float *fcpu)
+{
+	int fd;
+	char filename[1024];
+	unsigned long long words, total, end;
+	float tm = 0.0, cpu_start = 0.0;
+	void *buf;
+
+	snprintf(filename, sizeof(filename), "%s/benchmark.%d.tmp", diskio_prefix, getpid());
+	unlink(filename);
+
+	disk_drop_caches();
+
+	fd = open(filename, O_WRONLY | O_CREAT | O_DIRECT, 0777);
+	if (fd == -1)
+		return 0;
+
+	if (posix_memalign(&buf, sysconf(_SC_PAGE_SIZE), chunkSize) != 0) {
+		close(fd);
+		unlink(filename);
+		return 0;
+	}
+	memset(buf, 0x5a, chunkSize);
+
+	cpu_start = cpu_time_get();
+	s->start = nanotime();
+	end = s->start + s->size * s->interval;
+
+	for (words = 0, total = 0; nanotime() < end; words += chunkSize, total += chunkSize) {
+		if ((words + chunkSize > size) && (words > 0)) {
+			if (lseek(fd, 0, SEEK_SET) < 0)
+				break;
+			words = 0;
+		}
+		if (write(fd, buf, chunkSize) < 0)
+			break;
+		steady_tick(s, chunkSize);
+	}
+
+	tm = (nanotime() - s->start) / (float)NSEC_PER_SEC;
+	if (fcpu != NULL)
+		*fcpu = calc_cpu_usage(cpu_time_get() - cpu_start, tm);
+
+	/* Only the intervals finished before a write error are sampled */
+	if (tm * NSEC_PER_SEC < s->size * s->interval)
+		s->size = tm * NSEC_PER_SEC / s->interval;
+
+	free(buf);
+	close(fd);
+	unlink(filename);
+
+	return (total / tm);
+}
+
 float disk_benchmark_create(int numFiles, float *fcpu)
 {
 	int fd, i, created;
@@ -153,7 +213,7 @@ float disk_benchmark_create(int numFiles, float *fcpu)
 			close(fd);
 	}
 
-	tm = time_total / 1000000.0;
+	tm = time_total / NSEC_PER_SEC;
 	if (fcpu != NULL)
 		*fcpu = calc_cpu_usage(cpu_total, tm);
 
@@ -186,7 +246,7 @@ float disk_benchmark_delete(long *numFiles, float *fcpu)
 			deleted++;
 		}
 	}
-	tm = time_total / 1000000.0;
+	tm = time_total / NSEC_PER_SEC;
 	if (fcpu != NULL)
 		*fcpu = calc_cpu_usage(cpu_total, tm);
 	closedir(d);
@@ -228,7 +288,7 @@ float disk_throughput_read(long chunkSize, float *fcpu)
 		}
 		total += num;
 	}
-	tm = (nanotime() - start) / 1000000.0;
+	tm = (nanotime() - start) / (float)NSEC_PER_SEC;
 	if (fcpu != NULL)
 		*fcpu = calc_cpu_usage(cpu_time_get() - cpu_start, tm);
 
@@ -291,7 +351,7 @@ float disk_throughput_read_random(long chunkSize, int numSequences, float *fcpu)
 		}		
 	}
 
-	tm = (nanotime() - start) / 1000000.0;
+	tm = (nanotime() - start) / (float)NSEC_PER_SEC;
 	if (fcpu != NULL)
 		*fcpu = calc_cpu_usage(cpu_time_get() - cpu_start, tm);
 
@@ -0,0 +1,32 @@
+/*
+ * isa-v2.c: Dhrystone, Whetstone and Linpack kernels built for x86-64-v2
+ *
+ * Author: Michal Novotny <minovotn@redhat.com>
+ *
+ * Copyright (C) 2010 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+ *
+ */
+
+#define CPU_ISA_SUFFIX		_v2
+#include "utils.h"
+
+#ifdef CPU_ISA_VARIANTS
+#pragma GCC target("arch=x86-64-v2")
+#include "dhrystone.c"
+#include "whetstone.c"
+#include "linpack.c"
+#endif
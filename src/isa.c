@@ -0,0 +1,140 @@
+/*
+ * isa.c: Kernels built for the x86-64 microarchitecture levels
+ *
+ * Author: Michal Novotny <minovotn@redhat.com>
+ *
+ * Copyright (C) 2010 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+ *
+ */
+
+#include "utils.h"
+
+typedef struct {
+	const char *name;
+	void (*dhrystone)(unsigned long *dhry, unsigned long *loops, unsigned long *tm);
+	void (*whetstone)(unsigned long *loops, unsigned long *iter, unsigned long *btime, unsigned long *mips,
+				float *modules);
+	int (*linpack)(int arsize, unsigned long *memory, float *minMFLOPS, float *maxMFLOPS, float *avgMFLOPS);
+} tCpuIsaKernels;
+
+#ifdef CPU_ISA_VARIANTS
+#define CPU_ISA_KERNELS(suffix) \
+void cpu_dhrystone_get##suffix(unsigned long *dhry, unsigned long *loops, unsigned long *tm); \
+void cpu_whetstone_get##suffix(unsigned long *loops, unsigned long *iter, unsigned long *btime, unsigned long *mips, \
+			float *modules); \
+int get_linpack_score##suffix(int arsize, unsigned long *memory, float *minMFLOPS, float *maxMFLOPS, float *avgMFLOPS);
+
+CPU_ISA_KERNELS(_v2)
+CPU_ISA_KERNELS(_v3)
+CPU_ISA_KERNELS(_v4)
+#endif
+
+static const tCpuIsaKernels cpuIsaTable[CPU_ISA_COUNT] = {
+	{ "baseline", cpu_dhrystone_get, cpu_whetstone_get, get_linpack_score },
+#ifdef CPU_ISA_VARIANTS
+	{ "x86-64-v2", cpu_dhrystone_get_v2, cpu_whetstone_get_v2, get_linpack_score_v2 },
+	{ "x86-64-v3", cpu_dhrystone_get_v3, cpu_whetstone_get_v3, get_linpack_score_v3 },
+	{ "x86-64-v4", cpu_dhrystone_get_v4, cpu_whetstone_get_v4, get_linpack_score_v4 },
+#else
+	{ "x86-64-v2", NULL, NULL, NULL },
+	{ "x86-64-v3", NULL, NULL, NULL },
+	{ "x86-64-v4", NULL, NULL, NULL },
+#endif
+};
+
+const char *cpu_isa_name(int level)
+{
+	if ((level < 0) || (level >= CPU_ISA_COUNT))
+		return NULL;
+
+	return cpuIsaTable[level].name;
+}
+
+/* Returns the level of the name, i.e. "baseline" or "x86-64-v2" to "x86-64-v4" also without "x86-64-" */
+int cpu_isa_parse(const char *name)
+{
+	int level;
+
+	for (level = 0; level < CPU_ISA_COUNT; level++)
+		if ((strcmp(name, cpuIsaTable[level].name) == 0) || ((strncmp(cpuIsaTable[level].name, "x86-64-", 7) == 0)
+				&& (strcmp(name, cpuIsaTable[level].name + 7) == 0)))
+			return level;
+
+	return -EINVAL;
+}
+
+/* The level is supported when its kernels are built in and the host has all the instructions of the level */
+int cpu_isa_supported(int level)
+{
+	if ((level < 0) || (level >= CPU_ISA_COUNT) || (cpuIsaTable[level].dhrystone == NULL))
+		return 0;
+	if (level == CPU_ISA_BASELINE)
+		return 1;
+
+#ifdef CPU_ISA_VARIANTS
+	__builtin_cpu_init();
+	if (level == CPU_ISA_X86_64_V2)
+		return __builtin_cpu_supports("x86-64-v2");
+	if (level == CPU_ISA_X86_64_V3)
+		return __builtin_cpu_supports("x86-64-v3");
+	return __builtin_cpu_supports("x86-64-v4");
+#else
+	return 0;
+#endif
+}
+
+/* Returns the highest level supported by the host */
+int cpu_isa_best(void)
+{
+	int level;
+
+	for (level = CPU_ISA_COUNT - 1; level > CPU_ISA_BASELINE; level--)
+		if (cpu_isa_supported(level))
+			return level;
+
+	return CPU_ISA_BASELINE;
+}
+
+/* The kernels return -ENOTSUP when the level is not supported by the host */
+int cpu_isa_dhrystone_get(int level, unsigned long *dhry, unsigned long *loops, unsigned long *tm)
+{
+	if (!cpu_isa_supported(level))
+		return -ENOTSUP;
+
+	cpuIsaTable[level].dhrystone(dhry, loops, tm);
+	return 0;
+}
+
+int cpu_isa_whetstone_get(int level, unsigned long *loops, unsigned long *iter, unsigned long *btime,
+			unsigned long *mips, float *modules)
+{
+	if (!cpu_isa_supported(level))
+		return -ENOTSUP;
+
+	cpuIsaTable[level].whetstone(loops, iter, btime, mips, modules);
+	return 0;
+}
+
+/* Runs the classic Linpack, returns 0 or -ENOMEM like get_linpack_score() returning 0 when out of memory */
+int cpu_isa_linpack_score(int level, int arsize, unsigned long *memory, float *minMFLOPS, float *maxMFLOPS,
+			float *avgMFLOPS)
+{
+	if (!cpu_isa_supported(level))
+		return -ENOTSUP;
+
+	return cpuIsaTable[level].linpack(arsize, memory, minMFLOPS, maxMFLOPS, avgMFLOPS) ? 0 : -ENOMEM;
+}
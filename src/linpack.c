@@ -44,15 +44,52 @@
 **
 */
 
+#include "utils.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
 #include <time.h>
 #include <float.h>
+#include <sys/mman.h>
 
 #define DP
 //#define SHOW_PROGRESS
 
+/*
+** Block sizes of the cache-blocked engine. LINPACK_NB is the panel width and
+** LINPACK_MB the number of rows of the L21 tile reused by the trailing update,
+** the tile (LINPACK_MB x LINPACK_NB elements) should fit into the L2 cache.
+*/
+#define LINPACK_NB  64
+#define LINPACK_MB  256
+
+/* Minimal wall time of the parallel and precision runs in nanoseconds */
+#define LINPACK_WALL_TIME    500000000ULL
+
+/* Maximal number of the iterative refinement steps of the mixed precision */
+#define LINPACK_REFINE_ITERS 30
+
+/* Minimal wall time of every point of the size sweep in nanoseconds */
+#define LINPACK_SWEEP_TIME   100000000ULL
+
+/*
+** The samples shorter than LINPACK_MIN_SAMPLE seconds are ignored and the
+** sampling stops with the first sample taking LINPACK_MAX_SAMPLE seconds.
+*/
+#define LINPACK_MIN_SAMPLE   0.05
+#define LINPACK_MAX_SAMPLE   1.0
+
+/* Linpack engines */
+#define ENGINE_CLASSIC  0
+#define ENGINE_BLOCKED  1
+#define ENGINE_VECTOR   2
+
+/* SIMD kernels are available for the double precision on x86 only */
+#if defined(DP) && (defined(__x86_64__) || defined(__i386__))
+#define LINPACK_SIMD
+#include <immintrin.h>
+#endif
+
 #ifdef SP
 #define ZERO        0.0
 #define ONE         1.0
@@ -72,9 +109,20 @@ typedef double  REAL;
 #endif
 
 static REAL linpack  (long nreps, int arsize, float *btime, float *mflops);
+static REAL linpack_run(int engine, long nreps, int arsize, float *btime, float *mflops);
 static void matgen   (REAL *a,int lda,int n,REAL *b,REAL *norma);
+static void matgen_cols(REAL *a,int lda,int n,int j0,int j1);
 static void dgefa    (REAL *a,int lda,int n,int *ipvt,int *info,int roll);
 static void dgesl    (REAL *a,int lda,int n,int *ipvt,REAL *b,int job,int roll);
+static void dgefa_blk(REAL *a,int lda,int n,int *ipvt,int *info);
+static void dgesl_blk(REAL *a,int lda,int n,int *ipvt,REAL *b);
+static void dgefa_panel(REAL *a,int lda,int n,int k,int kb,int *ipvt,int *info);
+static void dgefa_update(REAL *a,int lda,int n,int k,int kb,int *ipvt,int j0,int j1);
+static void dgemm_blk(int m,int n,int k,REAL *a,REAL *b,REAL *c,int lda);
+static void dgefa_vec(REAL *a,int lda,int n,int *ipvt,int *info);
+static void sgefa_blk(float *a,int lda,int n,int *ipvt,int *info);
+static void sgesl_blk(float *a,int lda,int n,int *ipvt,float *b);
+static void dgesl_vec(REAL *a,int lda,int n,int *ipvt,REAL *b);
 static void daxpy_r  (int n,REAL da,REAL *dx,int incx,REAL *dy,int incy);
 static REAL ddot_r   (int n,REAL *dx,int incx,REAL *dy,int incy);
 static void dscal_r  (int n,REAL da,REAL *dx,int incx);
@@ -82,11 +130,65 @@ static void daxpy_ur (int n,REAL da,REAL *dx,int incx,REAL *dy,int incy);
 static REAL ddot_ur  (int n,REAL *dx,int incx,REAL *dy,int incy);
 static void dscal_ur (int n,REAL da,REAL *dx,int incx);
 static int  idamax   (int n,REAL *dx,int incx);
+static void daxpy_v  (int n,REAL da,REAL *dx,int incx,REAL *dy,int incy);
+static void dscal_v  (int n,REAL da,REAL *dx,int incx);
+static int  idamax_v (int n,REAL *dx,int incx);
 static REAL second   (void);
 
+/*
+** Unit stride kernels of one instruction set, used through daxpy_v(),
+** dscal_v() and idamax_v(). The daxpy4 kernel is the inner loop
+** of dgemm_blk(): c = c - a[0]*b[0] - ... - a[3*lda]*b[3]. The saxpy
+** and saxpy4 kernels are their single precision versions used by the
+** sgefa_blk() engine.
+*/
+typedef struct {
+    const char *name;
+    void (*daxpy) (int n,REAL da,REAL *dx,REAL *dy);
+    REAL (*ddot)  (int n,REAL *dx,REAL *dy);
+    void (*dscal) (int n,REAL da,REAL *dx);
+    int  (*idamax)(int n,REAL *dx);
+    void (*daxpy4)(int n,REAL *c,REAL *a,int lda,REAL *b);
+    void (*saxpy) (int n,float da,float *dx,float *dy);
+    void (*saxpy4)(int n,float *c,float *a,int lda,float *b);
+} tLinpackKernels;
+
+static const tLinpackKernels lpKernelsTable[LINPACK_ISA_COUNT];
+static const tLinpackKernels *lpKernels = &lpKernelsTable[LINPACK_ISA_GENERIC];
+
 static void *mempool;
+static size_t mempoolSize;
+static int lpPages = MEMPAGE_DEFAULT;
 
-int get_linpack_score(int arsize, unsigned long *memory, float *minMFLOPS, float *maxMFLOPS, float *avgMFLOPS)
+/* Shared state of the parallel blocked engine */
+typedef struct {
+    REAL  *a,*b;
+    int   *ipvt;
+    int    lda,n,info;
+    long   nreps;
+    unsigned long long time;    /* wall time of the dgefa and dgesl in ns */
+} tLinpackPar;
+
+/* Buffers and results of the precision runs */
+typedef struct {
+    REAL  *a,*b,*x,*r;
+    float *as,*xs;
+    int   *ipvt;
+    int    lda,n,info,iters;
+    double resid;               /* ||b - A*x|| / (||A|| * ||x||) */
+} tLinpackPrec;
+
+static const char *lpPrecNames[LINPACK_PREC_COUNT] = { "single", "double", "mixed" };
+
+static const char *lpLevelNames[LINPACK_LEVEL_COUNT] = { "L1", "L2", "L3", "DRAM" };
+
+typedef struct {
+	tThread thread;
+	tLinpackPar *par;
+	double flops;				/* flops done by the thread */
+} tLinpackThread;
+
+static int linpack_score(int engine, int arsize, unsigned long *memory, float *minMFLOPS, float *maxMFLOPS, float *avgMFLOPS)
 {
 	int		num;
     long    arsize2d,memreq,nreps;
@@ -106,10 +208,18 @@ int get_linpack_score(int arsize, unsigned long *memory, float *minMFLOPS, float
 	if (memory != NULL)
 		*memory = (memreq+512L);
 	malloc_arg=(size_t)memreq;
-	if (malloc_arg!=memreq || (mempool=malloc(malloc_arg))==NULL)
+	if (malloc_arg!=memreq)
+		return 0;
+	if (lpPages==MEMPAGE_DEFAULT)
+		mempool=malloc(malloc_arg);
+	else
+		mempool=memory_map(malloc_arg,lpPages,-1,&mempoolSize);
+	if (mempool==NULL)
 		return 0;
 #ifdef SHOW_PROGRESS
-	printf("\nLINPACK benchmark, %s precision.\n",PREC);
+	printf("\nLINPACK benchmark%s, %s precision.\n",(engine == ENGINE_BLOCKED) ? " (blocked)" :
+			(engine == ENGINE_VECTOR) ? " (vector)" : "",PREC);
+	printf("Kernels:  %s\n",(engine == ENGINE_CLASSIC) ? "classic" : lpKernels->name);
 	printf("Machine precision:  %d digits.\n",BASE10DIG);
 	printf("Array size %d X %d.\n",arsize,arsize);
 	printf("Average rolled and unrolled performance:\n\n");
@@ -118,7 +228,8 @@ int get_linpack_score(int arsize, unsigned long *memory, float *minMFLOPS, float
 #endif
 	nreps=1;
 	num=0;
-	while (linpack(nreps,arsize,&fTime,&fMFLOPS)<10.) {
+	while (((engine == ENGINE_CLASSIC) ? linpack(nreps,arsize,&fTime,&fMFLOPS) :
+			linpack_run(engine,nreps,arsize,&fTime,&fMFLOPS))<LINPACK_MAX_SAMPLE) {
 		if (fTime > 0.00) {
 			if ((fMFLOPS < flVal) || (flVal == 0.00))
 				flVal = fMFLOPS;
@@ -129,7 +240,10 @@ int get_linpack_score(int arsize, unsigned long *memory, float *minMFLOPS, float
 		}
 		nreps*=2;
 	}
-	free(mempool);
+	if (lpPages==MEMPAGE_DEFAULT)
+		free(mempool);
+	else
+		munmap(mempool,mempoolSize);
 	avgValue = (tMFLOPS / num);
 
 	if (minMFLOPS != NULL)
@@ -142,6 +256,487 @@ int get_linpack_score(int arsize, unsigned long *memory, float *minMFLOPS, float
 	return 1;
 }
 
+int get_linpack_score(int arsize, unsigned long *memory, float *minMFLOPS, float *maxMFLOPS, float *avgMFLOPS)
+{
+	return linpack_score(ENGINE_CLASSIC, arsize, memory, minMFLOPS, maxMFLOPS, avgMFLOPS);
+}
+
+/* The blocked engine always uses the best kernels supported by the host */
+int get_linpack_blocked_score(int arsize, unsigned long *memory, float *minMFLOPS, float *maxMFLOPS, float *avgMFLOPS)
+{
+	lpKernels = &lpKernelsTable[linpack_isa_best()];
+	return linpack_score(ENGINE_BLOCKED, arsize, memory, minMFLOPS, maxMFLOPS, avgMFLOPS);
+}
+
+/*
+ * Runs the classic LINPACK algorithm on the matrix mapped in the pages of type pages. Returns 0 when the
+ * pages cannot be mapped, e.g. when no huge pages are reserved for MEMPAGE_HUGETLB.
+ */
+int get_linpack_pages_score(int pages, int arsize, unsigned long *memory, float *minMFLOPS, float *maxMFLOPS, float *avgMFLOPS)
+{
+	int rc;
+
+	lpPages = pages;
+	rc = linpack_score(ENGINE_CLASSIC, arsize, memory, minMFLOPS, maxMFLOPS, avgMFLOPS);
+	lpPages = MEMPAGE_DEFAULT;
+
+	return rc;
+}
+
+/*
+ * Runs the classic LINPACK algorithm with the BLAS kernels of the isa instruction set. Returns 0 when the
+ * instruction set is not supported by the host.
+ */
+int get_linpack_simd_score(int isa, int arsize, unsigned long *memory, float *minMFLOPS, float *maxMFLOPS, float *avgMFLOPS)
+{
+	if (!linpack_isa_supported(isa))
+		return 0;
+
+	lpKernels = &lpKernelsTable[isa];
+	return linpack_score(ENGINE_VECTOR, arsize, memory, minMFLOPS, maxMFLOPS, avgMFLOPS);
+}
+
+/*
+** Parallel blocked engine. The column blocks of LINPACK_NB columns are
+** owned by the threads in the round-robin fashion and every thread
+** generates its own blocks so the pages get allocated on the NUMA node
+** of the thread by the first touch. For every panel the owner factors it
+** and after the barrier all the threads update their own blocks by the
+** factored panel. The blocks are updated from the left so the owner of
+** the next panel updates it first and the next panel factorization
+** overlaps the updates of the other threads.
+*/
+static void *linpack_thread(void *arg)
+{
+	tLinpackThread *t = (tLinpackThread *)arg;
+	tLinpackPar *par = t->par;
+	REAL *a = par->a;
+	unsigned long long tm = 0;
+	int i, j, jb, k, kb, m, n, lda, num, idx;
+	long rep;
+
+	n = par->n;
+	lda = par->lda;
+	num = t->thread.num;
+	idx = t->thread.idx;
+
+	for (rep = 0; rep < par->nreps; rep++) {
+		for (j = idx * LINPACK_NB; j < n; j += num * LINPACK_NB)
+			matgen_cols(a, lda, n, j, (j + LINPACK_NB < n) ? j + LINPACK_NB : n);
+		pthread_barrier_wait(t->thread.barrier);
+
+		if (idx == 0) {
+			for (i = 0; i < n; i++)
+				par->b[i] = 0.0;
+			for (j = 0; j < n; j++)
+				for (i = 0; i < n; i++)
+					par->b[i] = par->b[i] + a[lda*j+i];
+			par->info = 0;
+			tm = nanotime();
+		}
+		pthread_barrier_wait(t->thread.barrier);
+
+		for (k = 0; k < n; k += LINPACK_NB) {
+			kb = (n - k < LINPACK_NB) ? n - k : LINPACK_NB;
+			m = n - (k + kb);
+
+			if ((k / LINPACK_NB) % num == idx) {
+				dgefa_panel(a, lda, n, k, kb, par->ipvt, &par->info);
+				for (j = k; j < k + kb; j++)
+					t->flops += (n - j - 1) * (1.0 + 2.0 * (k + kb - j - 1));
+			}
+			pthread_barrier_wait(t->thread.barrier);
+
+			for (j = idx * LINPACK_NB; j < n; j += num * LINPACK_NB) {
+				if (j == k)
+					continue;
+
+				jb = (j + LINPACK_NB < n) ? LINPACK_NB : n - j;
+				dgefa_update(a, lda, n, k, kb, par->ipvt, j, j + jb);
+				if (j > k)
+					t->flops += (double)jb * kb * (kb - 1 + 2.0 * m);
+			}
+		}
+		pthread_barrier_wait(t->thread.barrier);
+
+		if (idx == 0) {
+			dgesl_blk(a, lda, n, par->ipvt, par->b);
+			t->flops += 2.0 * n * n;
+			par->time += nanotime() - tm;
+		}
+		pthread_barrier_wait(t->thread.barrier);
+	}
+
+	return NULL;
+}
+
+/*
+ * Runs the blocked LINPACK engine in threads pinned threads using the best SIMD kernels. The GFLOPS done by
+ * each thread are stored to gflops[], the CPU it was running on to cpus[] and the overall GFLOPS to total.
+ * The matrix is mapped again for every run so it is always first touched by the threads.
+ */
+int get_linpack_threads_score(int threads, int arsize, unsigned long *memory, int *cpus, float *gflops, float *total)
+{
+	tLinpackThread *t;
+	tLinpackPar par;
+	long arsize2d, memreq;
+	double ops, sec;
+	void *pool;
+	int i, rc = 0;
+
+	arsize/=2;
+	arsize*=2;
+	if ((threads <= 0) || (arsize < 10))
+		return -EINVAL;
+
+	arsize2d = (long)arsize*(long)arsize;
+	memreq = arsize2d*sizeof(REAL)+(long)arsize*sizeof(REAL)+(long)arsize*sizeof(int);
+	if (memory != NULL)
+		*memory = memreq;
+
+	t = (tLinpackThread *)malloc( threads * sizeof(tLinpackThread) );
+	if (t == NULL)
+		return -ENOMEM;
+
+	lpKernels = &lpKernelsTable[linpack_isa_best()];
+	memset(&par, 0, sizeof(par));
+	par.lda = arsize;
+	par.n = arsize / 2;
+	par.nreps = 1;
+	ops = (2.0*par.n*par.n*par.n)/3.0+2.0*par.n*par.n;
+
+	while (1) {
+		pool = mmap(NULL, memreq, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (pool == MAP_FAILED) {
+			rc = -errno;
+			break;
+		}
+
+		par.a = (REAL *)pool;
+		par.b = par.a + arsize2d;
+		par.ipvt = (int *)&par.b[arsize];
+		par.time = 0;
+
+		memset(t, 0, threads * sizeof(tLinpackThread));
+		for (i = 0; i < threads; i++)
+			t[i].par = &par;
+
+		rc = cpu_threads_run(threads, linpack_thread, t, sizeof(tLinpackThread));
+		munmap(pool, memreq);
+
+		if ((rc != 0) || (par.time >= LINPACK_WALL_TIME))
+			break;
+		par.nreps *= 2;
+	}
+
+	if (rc == 0) {
+		sec = (double)par.time / NSEC_PER_SEC;
+		for (i = 0; i < threads; i++) {
+			if (cpus != NULL)
+				cpus[i] = t[i].thread.cpu;
+			if (gflops != NULL)
+				gflops[i] = t[i].flops / sec / 1e9;
+		}
+		if (total != NULL)
+			*total = par.nreps * ops / sec / 1e9;
+	}
+
+	free(t);
+	return rc;
+}
+
+/*
+** Computes r = b - A*x and returns the residual ||r|| / (||A|| * ||x||)
+** using the infinity norms. The norms are returned in anorm and xnorm.
+*/
+static double linpack_prec_resid(tLinpackPrec *lp,double *anorm,double *xnorm,double *rnorm)
+{
+	double an = 0.0, xn = 0.0, rn = 0.0, t;
+	int i, j;
+
+	for (i = 0; i < lp->n; i++) {
+		lp->r[i] = lp->b[i];
+		if (fabs(lp->x[i]) > xn)
+			xn = fabs(lp->x[i]);
+	}
+	for (j = 0; j < lp->n; j++)
+		daxpy_v(lp->n, -lp->x[j], &lp->a[lp->lda*j], 1, lp->r, 1);
+
+	for (i = 0; i < lp->n; i++) {
+		if (fabs(lp->r[i]) > rn)
+			rn = fabs(lp->r[i]);
+		for (t = 0.0, j = 0; j < lp->n; j++)
+			t += fabs(lp->a[lp->lda*j+i]);
+		if (t > an)
+			an = t;
+	}
+
+	if (anorm != NULL)
+		*anorm = an;
+	if (xnorm != NULL)
+		*xnorm = xn;
+	if (rnorm != NULL)
+		*rnorm = rn;
+
+	return ((an * xn) > 0.0) ? rn / (an * xn) : 0.0;
+}
+
+/*
+** Solves the matgen() system once in the precision prec and returns the wall time of the factorization and the
+** solution in ns. The single precision runs work on the float copy as of the matrix. The mixed precision factors
+** as and then refines the solution in double precision by x = x + inv(LU) * (b - A*x) until the residual reaches
+** the double precision or LINPACK_REFINE_ITERS steps are done.
+*/
+static unsigned long long linpack_prec_run(int prec, tLinpackPrec *lp)
+{
+	unsigned long long tm;
+	double anorm, xnorm, rnorm;
+	REAL norma;
+	long i, j, n, lda;
+
+	n = lp->n;
+	lda = lp->lda;
+	lp->iters = 0;
+
+	matgen(lp->a, lda, n, lp->b, &norma);
+	if (prec == LINPACK_PREC_SINGLE) {
+		for (j = 0; j < n; j++)
+			for (i = 0; i < n; i++)
+				lp->as[lda*j+i] = (float)lp->a[lda*j+i];
+	}
+	else
+	if (prec == LINPACK_PREC_DOUBLE)
+		memcpy(lp->x, lp->b, n * sizeof(REAL));
+
+	tm = nanotime();
+	if (prec == LINPACK_PREC_DOUBLE) {
+		dgefa_blk(lp->a, lda, n, lp->ipvt, &lp->info);
+		dgesl_blk(lp->a, lda, n, lp->ipvt, lp->x);
+	}
+	else {
+		if (prec == LINPACK_PREC_MIXED)
+			for (j = 0; j < n; j++)
+				for (i = 0; i < n; i++)
+					lp->as[lda*j+i] = (float)lp->a[lda*j+i];
+
+		for (i = 0; i < n; i++)
+			lp->xs[i] = (float)lp->b[i];
+		sgefa_blk(lp->as, lda, n, lp->ipvt, &lp->info);
+		sgesl_blk(lp->as, lda, n, lp->ipvt, lp->xs);
+		for (i = 0; i < n; i++)
+			lp->x[i] = lp->xs[i];
+
+		while ((prec == LINPACK_PREC_MIXED) && (lp->iters < LINPACK_REFINE_ITERS)) {
+			linpack_prec_resid(lp, &anorm, &xnorm, &rnorm);
+			if (rnorm <= xnorm * anorm * DBL_EPSILON * sqrt((double)n))
+				break;
+
+			for (i = 0; i < n; i++)
+				lp->xs[i] = (float)lp->r[i];
+			sgesl_blk(lp->as, lda, n, lp->ipvt, lp->xs);
+			for (i = 0; i < n; i++)
+				lp->x[i] += lp->xs[i];
+			lp->iters++;
+		}
+	}
+	tm = nanotime() - tm;
+
+	/* the double precision run factored the original matrix */
+	if (prec == LINPACK_PREC_DOUBLE)
+		matgen(lp->a, lda, n, lp->b, &norma);
+	lp->resid = linpack_prec_resid(lp, NULL, NULL, NULL);
+
+	return tm;
+}
+
+/*
+ * Runs the blocked LINPACK engine in the single, double or mixed precision using the best SIMD kernels. The
+ * GFLOPS are stored to gflops, the residual ||b - A*x|| / (||A|| * ||x||) of the solution to residual and the
+ * number of iterative refinement steps of the mixed precision to iters.
+ */
+int get_linpack_precision_score(int precision, int arsize, unsigned long *memory, float *gflops, double *residual,
+				int *iters)
+{
+	unsigned long long tm = 0;
+	tLinpackPrec lp;
+	long arsize2d, memreq, nreps = 0;
+	double ops;
+	void *pool;
+
+	arsize/=2;
+	arsize*=2;
+	if ((precision < 0) || (precision >= LINPACK_PREC_COUNT) || (arsize < 10))
+		return -EINVAL;
+
+	arsize2d = (long)arsize*(long)arsize;
+	memreq = arsize2d*(sizeof(REAL)+sizeof(float))+(long)arsize*(3*sizeof(REAL)+sizeof(float)+sizeof(int));
+	if (memory != NULL)
+		*memory = memreq;
+	if ((pool = malloc(memreq)) == NULL)
+		return -ENOMEM;
+
+	memset(&lp, 0, sizeof(lp));
+	lp.lda = arsize;
+	lp.n = arsize / 2;
+	lp.a = (REAL *)pool;
+	lp.b = lp.a + arsize2d;
+	lp.x = lp.b + arsize;
+	lp.r = lp.x + arsize;
+	lp.as = (float *)(lp.r + arsize);
+	lp.xs = lp.as + arsize2d;
+	lp.ipvt = (int *)(lp.xs + arsize);
+	ops = (2.0*lp.n*lp.n*lp.n)/3.0+2.0*lp.n*lp.n;
+
+	lpKernels = &lpKernelsTable[linpack_isa_best()];
+	while (tm < LINPACK_WALL_TIME) {
+		tm += linpack_prec_run(precision, &lp);
+		nreps++;
+	}
+	free(pool);
+
+	if (gflops != NULL)
+		*gflops = nreps * ops / tm;
+	if (residual != NULL)
+		*residual = lp.resid;
+	if (iters != NULL)
+		*iters = lp.iters;
+
+	return (lp.info == 0) ? 0 : -EDOM;
+}
+
+/*
+ * Runs the classic LINPACK algorithm with the best SIMD kernels for the array sizes growing geometrically from
+ * the L1 resident working set up to maxmem bytes. One allocation
+ * of the largest size is reused for all the points and the leading dimension is equal to the size so the working
+ * set is the matrix itself. The points are returned in the newly allocated *points array together with the
+ * level of the memory hierarchy the working set fits into. Returns the number of points.
+ */
+int get_linpack_sweep(unsigned long long maxmem, tLinpackSweep **points)
+{
+	unsigned long long tm, wset;
+	long caches[LINPACK_LEVEL_DRAM];
+	tLinpackSweep *pts;
+	REAL *a, *b, norma;
+	int *ipvt, info, n, nmax, num, i, lvl;
+	double ops, sz;
+	long nreps;
+	void *pool;
+
+	if (points == NULL)
+		return -EINVAL;
+
+	for (i = 0; i < LINPACK_LEVEL_DRAM; i++)
+		caches[i] = cpu_cache_size_get(i + 1);
+
+	/* start at a quarter of L1 with at least 10x10 matrix */
+	n = (int)sqrt((caches[LINPACK_LEVEL_L1] > 0 ? caches[LINPACK_LEVEL_L1] : 32768) / 4.0 / sizeof(REAL));
+	if (n < 10)
+		n = 10;
+	nmax = (int)sqrt((double)maxmem / sizeof(REAL));
+	if (nmax < n)
+		return -EINVAL;
+
+	/* the sizes grow by 2^(1/4) so the working set grows by sqrt(2) */
+	for (num = 0, sz = n; (int)sz <= nmax; sz *= 1.189207115)
+		num++;
+
+	pts = (tLinpackSweep *)malloc( num * sizeof(tLinpackSweep) );
+	pool = malloc( (long)nmax * nmax * sizeof(REAL) + (long)nmax * (sizeof(REAL) + sizeof(int)) );
+	if ((pts == NULL) || (pool == NULL)) {
+		free(pts);
+		free(pool);
+		return -ENOMEM;
+	}
+	a = (REAL *)pool;
+	b = a + (long)nmax * nmax;
+	ipvt = (int *)(b + nmax);
+
+	for (i = 0, sz = n; i < num; i++, sz *= 1.189207115)
+		pts[i].size = (int)sz;
+
+	lpKernels = &lpKernelsTable[linpack_isa_best()];
+	for (i = 0; i < num; i++) {
+		n = pts[i].size;
+		wset = (unsigned long long)n * n * sizeof(REAL);
+		ops = (2.0*n*n*n)/3.0+2.0*n*n;
+
+		for (tm = 0, nreps = 0; tm < LINPACK_SWEEP_TIME; nreps++) {
+			matgen(a, n, n, b, &norma);
+			tm -= nanotime();
+			dgefa_vec(a, n, n, ipvt, &info);
+			dgesl_vec(a, n, n, ipvt, b);
+			tm += nanotime();
+		}
+
+		for (lvl = 0; lvl < LINPACK_LEVEL_DRAM; lvl++)
+			if ((caches[lvl] > 0) && (wset <= (unsigned long long)caches[lvl]))
+				break;
+
+		pts[i].wset = wset;
+		pts[i].mflops = nreps * ops * 1000.0 / tm;
+		pts[i].level = lvl;
+	}
+
+	free(pool);
+	*points = pts;
+	return num;
+}
+
+const char *linpack_level_name(int level)
+{
+	if ((level < 0) || (level >= LINPACK_LEVEL_COUNT))
+		return NULL;
+
+	return lpLevelNames[level];
+}
+
+const char *linpack_precision_name(int precision)
+{
+	if ((precision < 0) || (precision >= LINPACK_PREC_COUNT))
+		return NULL;
+
+	return lpPrecNames[precision];
+}
+
+const char *linpack_isa_name(int isa)
+{
+	if ((isa < 0) || (isa >= LINPACK_ISA_COUNT))
+		return NULL;
+
+	return lpKernelsTable[isa].name;
+}
+
+int linpack_isa_supported(int isa)
+{
+	if ((isa < 0) || (isa >= LINPACK_ISA_COUNT) || (lpKernelsTable[isa].daxpy == NULL))
+		return 0;
+	if (isa == LINPACK_ISA_GENERIC)
+		return 1;
+
+#ifdef LINPACK_SIMD
+	__builtin_cpu_init();
+	if (isa == LINPACK_ISA_AVX2)
+		return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+	if (isa == LINPACK_ISA_AVX512)
+		return __builtin_cpu_supports("avx512f");
+	return __builtin_cpu_supports("sse2");
+#else
+	return 0;
+#endif
+}
+
+/* Returns the widest instruction set supported by the host */
+int linpack_isa_best(void)
+{
+	int isa;
+
+	for (isa = LINPACK_ISA_COUNT - 1; isa > LINPACK_ISA_GENERIC; isa--)
+		if (linpack_isa_supported(isa))
+			return isa;
+
+	return LINPACK_ISA_GENERIC;
+}
+
 static REAL linpack(long nreps,int arsize, float *btime, float *mflops)
 
     {
@@ -187,7 +782,7 @@ static REAL linpack(long nreps,int arsize, float *btime, float *mflops)
 	if (mflops != NULL)
 		*mflops = 0;
 
-    if ((totalt<0.5 || tdgefa+tdgesl<0.2))
+    if ((totalt<LINPACK_MIN_SAMPLE || tdgefa+tdgesl<LINPACK_MIN_SAMPLE/2))
         return(0.);
 
     kflops=2.*nreps*ops/(1000.*(tdgefa+tdgesl));
@@ -213,6 +808,72 @@ static REAL linpack(long nreps,int arsize, float *btime, float *mflops)
 }
 
 
+/*
+** Same as linpack() but using the cache-blocked dgefa_blk()/dgesl_blk()
+** engine or the classic algorithm with the lpKernels kernels. The matrix
+** and the operation count are the same so the MFLOPS values of all the
+** engines are directly comparable.
+*/
+static REAL linpack_run(int engine,long nreps,int arsize, float *btime, float *mflops)
+
+    {
+    REAL  *a,*b;
+    REAL   norma,t1,kflops,tdgesl,tdgefa,totalt,ops;
+    int   *ipvt,n,info,lda;
+    long   i,arsize2d;
+
+    lda = arsize;
+    n = arsize/2;
+    arsize2d = (long)arsize*(long)arsize;
+    ops=((2.0*n*n*n)/3.0+2.0*n*n);
+    a=(REAL *)mempool;
+    b=a+arsize2d;
+    ipvt=(int *)&b[arsize];
+    tdgesl=0;
+    tdgefa=0;
+    totalt=second();
+    for (i=0;i<2*nreps;i++)
+        {
+        matgen(a,lda,n,b,&norma);
+        t1 = second();
+        if (engine == ENGINE_BLOCKED)
+            dgefa_blk(a,lda,n,ipvt,&info);
+        else
+            dgefa_vec(a,lda,n,ipvt,&info);
+        tdgefa += second()-t1;
+        t1 = second();
+        if (engine == ENGINE_BLOCKED)
+            dgesl_blk(a,lda,n,ipvt,b);
+        else
+            dgesl_vec(a,lda,n,ipvt,b);
+        tdgesl += second()-t1;
+        }
+    totalt=second()-totalt;
+
+	if (btime != NULL)
+		*btime = 0;
+	if (mflops != NULL)
+		*mflops = 0;
+
+    if ((totalt<LINPACK_MIN_SAMPLE || tdgefa+tdgesl<LINPACK_MIN_SAMPLE/2))
+        return(0.);
+
+    kflops=2.*nreps*ops/(1000.*(tdgefa+tdgesl));
+
+	if (btime != NULL)
+		*btime = totalt;
+	if (mflops != NULL)
+		*mflops = kflops / 1000;
+#ifdef SHOW_PROGRESS
+    printf("%8ld %6.2f %6.2f%% %6.2f%% %6.2f%%  %9.3f\n",
+            nreps,totalt,100.*tdgefa/totalt,
+            100.*tdgesl/totalt,100.*(totalt-tdgefa-tdgesl)/totalt,
+            kflops / 1000);
+#endif
+    return(totalt);
+}
+
+
 /*
 ** For matgen,
 ** We would like to declare a[][lda], but c does not allow it.  In this
@@ -240,6 +901,36 @@ static void matgen(REAL *a,int lda,int n,REAL *b,REAL *norma)
     }
 
 
+/*
+** Generates the columns j0 .. j1-1 of the matgen() matrix. The generator
+** is skipped ahead to the first element of column j0 so the columns can
+** be generated in any order and by any thread.
+*/
+static void matgen_cols(REAL *a,int lda,int n,int j0,int j1)
+
+    {
+    long init,mult,e;
+    int i,j;
+
+    /* init = 1325 * 3125^(j0*n) mod 65536 */
+
+    mult = 3125;
+    init = 1325;
+    for (e = (long)j0*n; e > 0; e >>= 1)
+        {
+        if (e & 1)
+            init = init * mult % 65536L;
+        mult = mult * mult % 65536L;
+        }
+    for (j = j0; j < j1; j++)
+        for (i = 0; i < n; i++)
+            {
+            init = 3125L * init % 65536L;
+            a[lda*j+i] = (init - 32768.0)/16384.0;
+            }
+    }
+
+
 /*
 **
 ** DGEFA benchmark
@@ -604,69 +1295,467 @@ static void dgesl(REAL *a,int lda,int n,int *ipvt,REAL *b,int job,int roll)
 
 
 /*
-** Constant times a vector plus a vector.
-** Jack Dongarra, linpack, 3/11/78.
-** ROLLED version
+**
+** DGEFA_BLK - cache-blocked LU factorization
+**
+** Right-looking blocked variant of dgefa (the algorithm of LAPACK dgetrf).
+** For every panel of LINPACK_NB columns:
+**
+**   1. the panel is factored by the classic BLAS-1 algorithm,
+**   2. the U12 block rows are computed by a triangular solve with L11,
+**   3. the trailing matrix is updated by A22 = A22 - L21 * U12 using
+**      dgemm_blk() which reuses L21 tiles held in the cache.
+**
+** Most of the flops are done in step 3 so the speed is bound by the FPU
+** instead of the memory bandwidth even for matrices much larger than L2.
+**
+** Unlike dgefa the row interchanges are applied to the whole rows and the
+** multipliers are stored with the positive sign, so the factors have to be
+** used with dgesl_blk() and not with dgesl().
+**
 */
-static void daxpy_r(int n,REAL da,REAL *dx,int incx,REAL *dy,int incy)
+static void dgefa_blk(REAL *a,int lda,int n,int *ipvt,int *info)
 
     {
-    int i,ix,iy;
-
-    if (n <= 0)
-        return;
-    if (da == ZERO)
-        return;
+    int k,kb;
 
-    if (incx != 1 || incy != 1)
+    *info = 0;
+    for (k = 0; k < n; k += LINPACK_NB)
         {
+        kb = (n - k < LINPACK_NB) ? n - k : LINPACK_NB;
 
-        /* code for unequal increments or equal increments != 1 */
-
-        ix = 1;
-        iy = 1;
-        if(incx < 0) ix = (-n+1)*incx + 1;
-        if(incy < 0)iy = (-n+1)*incy + 1;
-        for (i = 0;i < n; i++)
-            {
-            dy[iy] = dy[iy] + da*dx[ix];
-            ix = ix + incx;
-            iy = iy + incy;
-            }
-        return;
+        dgefa_panel(a,lda,n,k,kb,ipvt,info);
+        dgefa_update(a,lda,n,k,kb,ipvt,0,k);
+        dgefa_update(a,lda,n,k,kb,ipvt,k+kb,n);
         }
-
-    /* code for both increments equal to 1 */
-
-    for (i = 0;i < n; i++)
-        dy[i] = dy[i] + da*dx[i];
     }
 
 
 /*
-** Forms the dot product of two vectors.
-** Jack Dongarra, linpack, 3/11/78.
-** ROLLED version
+** Factors the panel of the kb columns starting at column k by the classic
+** BLAS-1 algorithm. The row interchanges are applied to the panel columns
+** only, the rest of the matrix is handled by dgefa_update().
 */
-static REAL ddot_r(int n,REAL *dx,int incx,REAL *dy,int incy)
+static void dgefa_panel(REAL *a,int lda,int n,int k,int kb,int *ipvt,int *info)
 
     {
-    REAL dtemp;
-    int i,ix,iy;
+    REAL t;
+    int j,jj,l;
 
-    dtemp = ZERO;
+    for (jj = k; jj < k + kb; jj++)
+        {
 
-    if (n <= 0)
-        return(ZERO);
+        /* find l = pivot index */
 
-    if (incx != 1 || incy != 1)
-        {
+        l = idamax_v(n-jj,&a[lda*jj+jj],1) + jj;
+        ipvt[jj] = l;
 
-        /* code for unequal increments or equal increments != 1 */
+        /* zero pivot implies this column already
+           triangularized */
 
-        ix = 0;
-        iy = 0;
-        if (incx < 0) ix = (-n+1)*incx;
+        if (a[lda*jj+l] == ZERO)
+            {
+            (*info) = jj;
+            continue;
+            }
+
+        /* interchange the panel rows if necessary */
+
+        if (l != jj)
+            for (j = k; j < k + kb; j++)
+                {
+                t = a[lda*j+l];
+                a[lda*j+l] = a[lda*j+jj];
+                a[lda*j+jj] = t;
+                }
+
+        /* compute multipliers */
+
+        t = ONE/a[lda*jj+jj];
+        dscal_v(n-(jj+1),t,&a[lda*jj+jj+1],1);
+
+        /* update the rest of the panel */
+
+        for (j = jj+1; j < k+kb; j++)
+            daxpy_v(n-(jj+1),-a[lda*j+jj],&a[lda*jj+jj+1],1,&a[lda*j+jj+1],1);
+        }
+    }
+
+
+/*
+** Applies the factored panel at column k to the columns j0 .. j1-1: the
+** row interchanges of the panel and, for the columns right of the panel,
+** U12 = inv(L11) * A12 and A22 = A22 - L21 * U12 where most of the flops
+** are done by dgemm_blk().
+*/
+static void dgefa_update(REAL *a,int lda,int n,int k,int kb,int *ipvt,int j0,int j1)
+
+    {
+    REAL t;
+    int j,jj,l;
+
+    if (j0 >= j1)
+        return;
+
+    for (jj = k; jj < k + kb; jj++)
+        {
+        l = ipvt[jj];
+        if (l != jj)
+            for (j = j0; j < j1; j++)
+                {
+                t = a[lda*j+l];
+                a[lda*j+l] = a[lda*j+jj];
+                a[lda*j+jj] = t;
+                }
+        }
+
+    if (j0 < k + kb)
+        return;
+
+    for (j = j0; j < j1; j++)
+        for (jj = k; jj < k+kb-1; jj++)
+            daxpy_v(k+kb-(jj+1),-a[lda*j+jj],&a[lda*jj+jj+1],1,&a[lda*j+jj+1],1);
+
+    dgemm_blk(n-(k+kb),j1-j0,kb,&a[lda*k+k+kb],&a[lda*j0+k],&a[lda*j0+k+kb],lda);
+    }
+
+
+/*
+**
+** DGESL_BLK - solves a * x = b using the factors computed by dgefa_blk
+**
+*/
+static void dgesl_blk(REAL *a,int lda,int n,int *ipvt,REAL *b)
+
+    {
+    REAL t;
+    int k,kb,l;
+
+    /* apply the row interchanges */
+
+    for (k = 0; k < n; k++)
+        {
+        l = ipvt[k];
+        if (l != k)
+            {
+            t = b[l];
+            b[l] = b[k];
+            b[k] = t;
+            }
+        }
+
+    /* solve l*y = b, l is unit lower triangular */
+
+    for (k = 0; k < n-1; k++)
+        daxpy_v(n-(k+1),-b[k],&a[lda*k+k+1],1,&b[k+1],1);
+
+    /* now solve  u*x = y */
+
+    for (kb = 0; kb < n; kb++)
+        {
+        k = n - (kb + 1);
+        b[k] = b[k]/a[lda*k+k];
+        daxpy_v(k,-b[k],&a[lda*k+0],1,&b[0],1);
+        }
+    }
+
+
+/*
+** Rank-k update c = c - a * b of the m x n matrix c, where a is m x k and
+** b is k x n, all of them stored by columns with leading dimension lda.
+** The rows are processed in tiles of LINPACK_MB so the a tile stays in the
+** cache for all the columns of c, and four columns of a are applied at once
+** by the daxpy4 kernel to cut the loads and stores of c.
+*/
+static void dgemm_blk(int m,int n,int k,REAL *a,REAL *b,REAL *c,int lda)
+
+    {
+    int ii,j,p,mb;
+
+    for (ii = 0; ii < m; ii += LINPACK_MB)
+        {
+        mb = (m - ii < LINPACK_MB) ? m - ii : LINPACK_MB;
+        for (j = 0; j < n; j++)
+            {
+            for (p = 0; p + 3 < k; p += 4)
+                lpKernels->daxpy4(mb,&c[lda*j+ii],&a[lda*p+ii],lda,&b[lda*j+p]);
+            for (; p < k; p++)
+                daxpy_v(mb,-b[lda*j+p],&a[lda*p+ii],1,&c[lda*j+ii],1);
+            }
+        }
+    }
+
+
+/*
+**
+** SGEFA_BLK, SGESL_BLK - single precision versions of dgefa_blk and
+** dgesl_blk used by the single and mixed precision runs. The matrix
+** is factored in place with the whole rows interchanged.
+**
+*/
+static void sgefa_blk(float *a,int lda,int n,int *ipvt,int *info)
+
+    {
+    float t;
+    int i,ii,j,jj,k,kb,l,mb,p;
+
+    *info = 0;
+    for (k = 0; k < n; k += LINPACK_NB)
+        {
+        kb = (n - k < LINPACK_NB) ? n - k : LINPACK_NB;
+
+        /* factor the panel */
+
+        for (jj = k; jj < k + kb; jj++)
+            {
+            l = jj;
+            for (i = jj + 1; i < n; i++)
+                if (fabsf(a[lda*jj+i]) > fabsf(a[lda*jj+l]))
+                    l = i;
+            ipvt[jj] = l;
+
+            if (a[lda*jj+l] == 0.0f)
+                {
+                (*info) = jj;
+                continue;
+                }
+
+            if (l != jj)
+                for (j = 0; j < n; j++)
+                    {
+                    t = a[lda*j+l];
+                    a[lda*j+l] = a[lda*j+jj];
+                    a[lda*j+jj] = t;
+                    }
+
+            t = 1.0f/a[lda*jj+jj];
+            for (i = jj + 1; i < n; i++)
+                a[lda*jj+i] *= t;
+
+            for (j = jj+1; j < k+kb; j++)
+                lpKernels->saxpy(n-(jj+1),-a[lda*j+jj],&a[lda*jj+jj+1],&a[lda*j+jj+1]);
+            }
+
+        if (k + kb >= n)
+            break;
+
+        /* U12 = inv(L11) * A12 */
+
+        for (j = k+kb; j < n; j++)
+            for (jj = k; jj < k+kb-1; jj++)
+                lpKernels->saxpy(k+kb-(jj+1),-a[lda*j+jj],&a[lda*jj+jj+1],&a[lda*j+jj+1]);
+
+        /* A22 = A22 - L21 * U12 */
+
+        for (ii = k + kb; ii < n; ii += LINPACK_MB)
+            {
+            mb = (n - ii < LINPACK_MB) ? n - ii : LINPACK_MB;
+            for (j = k+kb; j < n; j++)
+                {
+                for (p = k; p + 3 < k + kb; p += 4)
+                    lpKernels->saxpy4(mb,&a[lda*j+ii],&a[lda*p+ii],lda,&a[lda*j+p]);
+                for (; p < k + kb; p++)
+                    lpKernels->saxpy(mb,-a[lda*j+p],&a[lda*p+ii],&a[lda*j+ii]);
+                }
+            }
+        }
+    }
+
+
+static void sgesl_blk(float *a,int lda,int n,int *ipvt,float *b)
+
+    {
+    float t;
+    int k,kb,l;
+
+    for (k = 0; k < n; k++)
+        {
+        l = ipvt[k];
+        if (l != k)
+            {
+            t = b[l];
+            b[l] = b[k];
+            b[k] = t;
+            }
+        }
+
+    for (k = 0; k < n-1; k++)
+        lpKernels->saxpy(n-(k+1),-b[k],&a[lda*k+k+1],&b[k+1]);
+
+    for (kb = 0; kb < n; kb++)
+        {
+        k = n - (kb + 1);
+        b[k] = b[k]/a[lda*k+k];
+        lpKernels->saxpy(k,-b[k],&a[lda*k+0],&b[0]);
+        }
+    }
+
+
+/*
+**
+** DGEFA_VEC, DGESL_VEC - the classic dgefa and dgesl algorithm (job = 0)
+** using the BLAS kernels of the lpKernels instruction set.
+**
+*/
+static void dgefa_vec(REAL *a,int lda,int n,int *ipvt,int *info)
+
+    {
+    REAL t;
+    int j,k,kp1,l,nm1;
+
+    *info = 0;
+    nm1 = n - 1;
+    if (nm1 >=  0)
+        for (k = 0; k < nm1; k++)
+            {
+            kp1 = k + 1;
+
+            /* find l = pivot index */
+
+            l = idamax_v(n-k,&a[lda*k+k],1) + k;
+            ipvt[k] = l;
+
+            /* zero pivot implies this column already
+               triangularized */
+
+            if (a[lda*k+l] != ZERO)
+                {
+
+                /* interchange if necessary */
+
+                if (l != k)
+                    {
+                    t = a[lda*k+l];
+                    a[lda*k+l] = a[lda*k+k];
+                    a[lda*k+k] = t;
+                    }
+
+                /* compute multipliers */
+
+                t = -ONE/a[lda*k+k];
+                dscal_v(n-(k+1),t,&a[lda*k+k+1],1);
+
+                /* row elimination with column indexing */
+
+                for (j = kp1; j < n; j++)
+                    {
+                    t = a[lda*j+l];
+                    if (l != k)
+                        {
+                        a[lda*j+l] = a[lda*j+k];
+                        a[lda*j+k] = t;
+                        }
+                    daxpy_v(n-(k+1),t,&a[lda*k+k+1],1,&a[lda*j+k+1],1);
+                    }
+                }
+            else
+                (*info) = k;
+            }
+    ipvt[n-1] = n-1;
+    if (a[lda*(n-1)+(n-1)] == ZERO)
+        (*info) = n-1;
+    }
+
+
+static void dgesl_vec(REAL *a,int lda,int n,int *ipvt,REAL *b)
+
+    {
+    REAL    t;
+    int     k,kb,l,nm1;
+
+    nm1 = n - 1;
+
+    /* first solve  l*y = b */
+
+    if (nm1 >= 1)
+        for (k = 0; k < nm1; k++)
+            {
+            l = ipvt[k];
+            t = b[l];
+            if (l != k)
+                {
+                b[l] = b[k];
+                b[k] = t;
+                }
+            daxpy_v(n-(k+1),t,&a[lda*k+k+1],1,&b[k+1],1);
+            }
+
+    /* now solve  u*x = y */
+
+    for (kb = 0; kb < n; kb++)
+        {
+        k = n - (kb + 1);
+        b[k] = b[k]/a[lda*k+k];
+        t = -b[k];
+        daxpy_v(k,t,&a[lda*k+0],1,&b[0],1);
+        }
+    }
+
+
+/*
+** Constant times a vector plus a vector.
+** Jack Dongarra, linpack, 3/11/78.
+** ROLLED version
+*/
+static void daxpy_r(int n,REAL da,REAL *dx,int incx,REAL *dy,int incy)
+
+    {
+    int i,ix,iy;
+
+    if (n <= 0)
+        return;
+    if (da == ZERO)
+        return;
+
+    if (incx != 1 || incy != 1)
+        {
+
+        /* code for unequal increments or equal increments != 1 */
+
+        ix = 1;
+        iy = 1;
+        if(incx < 0) ix = (-n+1)*incx + 1;
+        if(incy < 0)iy = (-n+1)*incy + 1;
+        for (i = 0;i < n; i++)
+            {
+            dy[iy] = dy[iy] + da*dx[ix];
+            ix = ix + incx;
+            iy = iy + incy;
+            }
+        return;
+        }
+
+    /* code for both increments equal to 1 */
+
+    for (i = 0;i < n; i++)
+        dy[i] = dy[i] + da*dx[i];
+    }
+
+
+/*
+** Forms the dot product of two vectors.
+** Jack Dongarra, linpack, 3/11/78.
+** ROLLED version
+*/
+static REAL ddot_r(int n,REAL *dx,int incx,REAL *dy,int incy)
+
+    {
+    REAL dtemp;
+    int i,ix,iy;
+
+    dtemp = ZERO;
+
+    if (n <= 0)
+        return(ZERO);
+
+    if (incx != 1 || incy != 1)
+        {
+
+        /* code for unequal increments or equal increments != 1 */
+
+        ix = 0;
+        iy = 0;
+        if (incx < 0) ix = (-n+1)*incx;
         if (incy < 0) iy = (-n+1)*incy;
         for (i = 0;i < n; i++)
             {
@@ -916,10 +2005,577 @@ static int idamax(int n,REAL *dx,int incx)
     }
 
 
+/*
+** Dispatchers of the BLAS kernels. The argument checks and the non-unit
+** increments are handled here, the unit stride case is passed to the
+** kernels of the selected instruction set.
+*/
+static void daxpy_v(int n,REAL da,REAL *dx,int incx,REAL *dy,int incy)
+
+    {
+    if (n <= 0 || da == ZERO)
+        return;
+    if (incx != 1 || incy != 1)
+        {
+        daxpy_ur(n,da,dx,incx,dy,incy);
+        return;
+        }
+    lpKernels->daxpy(n,da,dx,dy);
+    }
+
+
+static void dscal_v(int n,REAL da,REAL *dx,int incx)
+
+    {
+    if (n <= 0)
+        return;
+    if (incx != 1)
+        {
+        dscal_ur(n,da,dx,incx);
+        return;
+        }
+    lpKernels->dscal(n,da,dx);
+    }
+
+
+static int idamax_v(int n,REAL *dx,int incx)
+
+    {
+    if (n < 1)
+        return(-1);
+    if (n == 1)
+        return(0);
+    if (incx != 1)
+        return(idamax(n,dx,incx));
+    return(lpKernels->idamax(n,dx));
+    }
+
+
+/*
+** Generic kernels, the unrolled C versions
+*/
+static void daxpy_gen(int n,REAL da,REAL *dx,REAL *dy)
+
+    {
+    daxpy_ur(n,da,dx,1,dy,1);
+    }
+
+
+static REAL ddot_gen(int n,REAL *dx,REAL *dy)
+
+    {
+    return(ddot_ur(n,dx,1,dy,1));
+    }
+
+
+static void dscal_gen(int n,REAL da,REAL *dx)
+
+    {
+    dscal_ur(n,da,dx,1);
+    }
+
+
+static int idamax_gen(int n,REAL *dx)
+
+    {
+    return(idamax(n,dx,1));
+    }
+
+
+static void daxpy4_gen(int n,REAL *c,REAL *a,int lda,REAL *b)
+
+    {
+    REAL *a0,*a1,*a2,*a3;
+    int i;
+
+    a0 = a;
+    a1 = a0 + lda;
+    a2 = a1 + lda;
+    a3 = a2 + lda;
+    for (i = 0; i < n; i++)
+        c[i] -= a0[i]*b[0] + a1[i]*b[1] + a2[i]*b[2] + a3[i]*b[3];
+    }
+
+
+static void saxpy_gen(int n,float da,float *dx,float *dy)
+
+    {
+    int i;
+
+    for (i = 0; i < n; i++)
+        dy[i] = dy[i] + da*dx[i];
+    }
+
+
+static void saxpy4_gen(int n,float *c,float *a,int lda,float *b)
+
+    {
+    float *a0,*a1,*a2,*a3;
+    int i;
+
+    a0 = a;
+    a1 = a0 + lda;
+    a2 = a1 + lda;
+    a3 = a2 + lda;
+    for (i = 0; i < n; i++)
+        c[i] -= a0[i]*b[0] + a1[i]*b[1] + a2[i]*b[2] + a3[i]*b[3];
+    }
+
+
+/* Returns the first index of the element with the absolute value dmax */
+static int idamax_find(int n,REAL *dx,REAL dmax)
+
+    {
+    int i;
+
+    for (i = 0; i < n; i++)
+        if (fabs((double)dx[i]) == dmax)
+            return(i);
+    return(0);
+    }
+
+
+#ifdef LINPACK_SIMD
+/*
+** SSE2 kernels, 2 doubles per vector
+*/
+__attribute__((target("sse2")))
+static void daxpy_sse2(int n,REAL da,REAL *dx,REAL *dy)
+
+    {
+    __m128d a = _mm_set1_pd(da);
+    int i;
+
+    for (i = 0; i + 4 <= n; i += 4)
+        {
+        _mm_storeu_pd(&dy[i],_mm_add_pd(_mm_loadu_pd(&dy[i]),_mm_mul_pd(a,_mm_loadu_pd(&dx[i]))));
+        _mm_storeu_pd(&dy[i+2],_mm_add_pd(_mm_loadu_pd(&dy[i+2]),_mm_mul_pd(a,_mm_loadu_pd(&dx[i+2]))));
+        }
+    for (; i < n; i++)
+        dy[i] = dy[i] + da*dx[i];
+    }
+
+
+__attribute__((target("sse2")))
+static REAL ddot_sse2(int n,REAL *dx,REAL *dy)
+
+    {
+    __m128d s0 = _mm_setzero_pd(), s1 = _mm_setzero_pd();
+    REAL dtemp;
+    int i;
+
+    for (i = 0; i + 4 <= n; i += 4)
+        {
+        s0 = _mm_add_pd(s0,_mm_mul_pd(_mm_loadu_pd(&dx[i]),_mm_loadu_pd(&dy[i])));
+        s1 = _mm_add_pd(s1,_mm_mul_pd(_mm_loadu_pd(&dx[i+2]),_mm_loadu_pd(&dy[i+2])));
+        }
+    s0 = _mm_add_pd(s0,s1);
+    dtemp = _mm_cvtsd_f64(_mm_add_sd(s0,_mm_unpackhi_pd(s0,s0)));
+    for (; i < n; i++)
+        dtemp = dtemp + dx[i]*dy[i];
+    return(dtemp);
+    }
+
+
+__attribute__((target("sse2")))
+static void dscal_sse2(int n,REAL da,REAL *dx)
+
+    {
+    __m128d a = _mm_set1_pd(da);
+    int i;
+
+    for (i = 0; i + 4 <= n; i += 4)
+        {
+        _mm_storeu_pd(&dx[i],_mm_mul_pd(a,_mm_loadu_pd(&dx[i])));
+        _mm_storeu_pd(&dx[i+2],_mm_mul_pd(a,_mm_loadu_pd(&dx[i+2])));
+        }
+    for (; i < n; i++)
+        dx[i] = da*dx[i];
+    }
+
+
+__attribute__((target("sse2")))
+static int idamax_sse2(int n,REAL *dx)
+
+    {
+    __m128d mask = _mm_set1_pd(-0.0), m = _mm_setzero_pd();
+    REAL dmax;
+    int i;
+
+    for (i = 0; i + 2 <= n; i += 2)
+        m = _mm_max_pd(m,_mm_andnot_pd(mask,_mm_loadu_pd(&dx[i])));
+    m = _mm_max_sd(m,_mm_unpackhi_pd(m,m));
+    dmax = _mm_cvtsd_f64(m);
+    for (; i < n; i++)
+        if (fabs((double)dx[i]) > dmax)
+            dmax = fabs((double)dx[i]);
+    return(idamax_find(n,dx,dmax));
+    }
+
+
+__attribute__((target("sse2")))
+static void daxpy4_sse2(int n,REAL *c,REAL *a,int lda,REAL *b)
+
+    {
+    __m128d b0 = _mm_set1_pd(b[0]), b1 = _mm_set1_pd(b[1]);
+    __m128d b2 = _mm_set1_pd(b[2]), b3 = _mm_set1_pd(b[3]), t;
+    REAL *a0 = a, *a1 = a + lda, *a2 = a + 2*lda, *a3 = a + 3*lda;
+    int i;
+
+    for (i = 0; i + 2 <= n; i += 2)
+        {
+        t = _mm_add_pd(_mm_mul_pd(_mm_loadu_pd(&a0[i]),b0),_mm_mul_pd(_mm_loadu_pd(&a1[i]),b1));
+        t = _mm_add_pd(t,_mm_add_pd(_mm_mul_pd(_mm_loadu_pd(&a2[i]),b2),_mm_mul_pd(_mm_loadu_pd(&a3[i]),b3)));
+        _mm_storeu_pd(&c[i],_mm_sub_pd(_mm_loadu_pd(&c[i]),t));
+        }
+    for (; i < n; i++)
+        c[i] -= a0[i]*b[0] + a1[i]*b[1] + a2[i]*b[2] + a3[i]*b[3];
+    }
+
+
+__attribute__((target("sse2")))
+static void saxpy_sse2(int n,float da,float *dx,float *dy)
+
+    {
+    __m128 a = _mm_set1_ps(da);
+    int i;
+
+    for (i = 0; i + 8 <= n; i += 8)
+        {
+        _mm_storeu_ps(&dy[i],_mm_add_ps(_mm_loadu_ps(&dy[i]),_mm_mul_ps(a,_mm_loadu_ps(&dx[i]))));
+        _mm_storeu_ps(&dy[i+4],_mm_add_ps(_mm_loadu_ps(&dy[i+4]),_mm_mul_ps(a,_mm_loadu_ps(&dx[i+4]))));
+        }
+    for (; i < n; i++)
+        dy[i] = dy[i] + da*dx[i];
+    }
+
+
+__attribute__((target("sse2")))
+static void saxpy4_sse2(int n,float *c,float *a,int lda,float *b)
+
+    {
+    __m128 b0 = _mm_set1_ps(b[0]), b1 = _mm_set1_ps(b[1]);
+    __m128 b2 = _mm_set1_ps(b[2]), b3 = _mm_set1_ps(b[3]), t;
+    float *a0 = a, *a1 = a + lda, *a2 = a + 2*lda, *a3 = a + 3*lda;
+    int i;
+
+    for (i = 0; i + 4 <= n; i += 4)
+        {
+        t = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&a0[i]),b0),_mm_mul_ps(_mm_loadu_ps(&a1[i]),b1));
+        t = _mm_add_ps(t,_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&a2[i]),b2),_mm_mul_ps(_mm_loadu_ps(&a3[i]),b3)));
+        _mm_storeu_ps(&c[i],_mm_sub_ps(_mm_loadu_ps(&c[i]),t));
+        }
+    for (; i < n; i++)
+        c[i] -= a0[i]*b[0] + a1[i]*b[1] + a2[i]*b[2] + a3[i]*b[3];
+    }
+
+
+/*
+** AVX2 kernels, 4 doubles per vector using FMA
+*/
+__attribute__((target("avx2,fma")))
+static void daxpy_avx2(int n,REAL da,REAL *dx,REAL *dy)
+
+    {
+    __m256d a = _mm256_set1_pd(da);
+    int i;
+
+    for (i = 0; i + 8 <= n; i += 8)
+        {
+        _mm256_storeu_pd(&dy[i],_mm256_fmadd_pd(a,_mm256_loadu_pd(&dx[i]),_mm256_loadu_pd(&dy[i])));
+        _mm256_storeu_pd(&dy[i+4],_mm256_fmadd_pd(a,_mm256_loadu_pd(&dx[i+4]),_mm256_loadu_pd(&dy[i+4])));
+        }
+    for (; i < n; i++)
+        dy[i] = dy[i] + da*dx[i];
+    }
+
+
+__attribute__((target("avx2,fma")))
+static REAL ddot_avx2(int n,REAL *dx,REAL *dy)
+
+    {
+    __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+    __m128d s;
+    REAL dtemp;
+    int i;
+
+    for (i = 0; i + 8 <= n; i += 8)
+        {
+        s0 = _mm256_fmadd_pd(_mm256_loadu_pd(&dx[i]),_mm256_loadu_pd(&dy[i]),s0);
+        s1 = _mm256_fmadd_pd(_mm256_loadu_pd(&dx[i+4]),_mm256_loadu_pd(&dy[i+4]),s1);
+        }
+    s0 = _mm256_add_pd(s0,s1);
+    s = _mm_add_pd(_mm256_castpd256_pd128(s0),_mm256_extractf128_pd(s0,1));
+    dtemp = _mm_cvtsd_f64(_mm_add_sd(s,_mm_unpackhi_pd(s,s)));
+    for (; i < n; i++)
+        dtemp = dtemp + dx[i]*dy[i];
+    return(dtemp);
+    }
+
+
+__attribute__((target("avx2,fma")))
+static void dscal_avx2(int n,REAL da,REAL *dx)
+
+    {
+    __m256d a = _mm256_set1_pd(da);
+    int i;
+
+    for (i = 0; i + 8 <= n; i += 8)
+        {
+        _mm256_storeu_pd(&dx[i],_mm256_mul_pd(a,_mm256_loadu_pd(&dx[i])));
+        _mm256_storeu_pd(&dx[i+4],_mm256_mul_pd(a,_mm256_loadu_pd(&dx[i+4])));
+        }
+    for (; i < n; i++)
+        dx[i] = da*dx[i];
+    }
+
+
+__attribute__((target("avx2,fma")))
+static int idamax_avx2(int n,REAL *dx)
+
+    {
+    __m256d mask = _mm256_set1_pd(-0.0), m = _mm256_setzero_pd();
+    __m128d s;
+    REAL dmax;
+    int i;
+
+    for (i = 0; i + 4 <= n; i += 4)
+        m = _mm256_max_pd(m,_mm256_andnot_pd(mask,_mm256_loadu_pd(&dx[i])));
+    s = _mm_max_pd(_mm256_castpd256_pd128(m),_mm256_extractf128_pd(m,1));
+    s = _mm_max_sd(s,_mm_unpackhi_pd(s,s));
+    dmax = _mm_cvtsd_f64(s);
+    for (; i < n; i++)
+        if (fabs((double)dx[i]) > dmax)
+            dmax = fabs((double)dx[i]);
+    return(idamax_find(n,dx,dmax));
+    }
+
+
+__attribute__((target("avx2,fma")))
+static void daxpy4_avx2(int n,REAL *c,REAL *a,int lda,REAL *b)
+
+    {
+    __m256d b0 = _mm256_set1_pd(b[0]), b1 = _mm256_set1_pd(b[1]);
+    __m256d b2 = _mm256_set1_pd(b[2]), b3 = _mm256_set1_pd(b[3]), t;
+    REAL *a0 = a, *a1 = a + lda, *a2 = a + 2*lda, *a3 = a + 3*lda;
+    int i;
+
+    for (i = 0; i + 4 <= n; i += 4)
+        {
+        t = _mm256_mul_pd(_mm256_loadu_pd(&a0[i]),b0);
+        t = _mm256_fmadd_pd(_mm256_loadu_pd(&a1[i]),b1,t);
+        t = _mm256_fmadd_pd(_mm256_loadu_pd(&a2[i]),b2,t);
+        t = _mm256_fmadd_pd(_mm256_loadu_pd(&a3[i]),b3,t);
+        _mm256_storeu_pd(&c[i],_mm256_sub_pd(_mm256_loadu_pd(&c[i]),t));
+        }
+    for (; i < n; i++)
+        c[i] -= a0[i]*b[0] + a1[i]*b[1] + a2[i]*b[2] + a3[i]*b[3];
+    }
+
+
+__attribute__((target("avx2,fma")))
+static void saxpy_avx2(int n,float da,float *dx,float *dy)
+
+    {
+    __m256 a = _mm256_set1_ps(da);
+    int i;
+
+    for (i = 0; i + 16 <= n; i += 16)
+        {
+        _mm256_storeu_ps(&dy[i],_mm256_fmadd_ps(a,_mm256_loadu_ps(&dx[i]),_mm256_loadu_ps(&dy[i])));
+        _mm256_storeu_ps(&dy[i+8],_mm256_fmadd_ps(a,_mm256_loadu_ps(&dx[i+8]),_mm256_loadu_ps(&dy[i+8])));
+        }
+    for (; i < n; i++)
+        dy[i] = dy[i] + da*dx[i];
+    }
+
+
+__attribute__((target("avx2,fma")))
+static void saxpy4_avx2(int n,float *c,float *a,int lda,float *b)
+
+    {
+    __m256 b0 = _mm256_set1_ps(b[0]), b1 = _mm256_set1_ps(b[1]);
+    __m256 b2 = _mm256_set1_ps(b[2]), b3 = _mm256_set1_ps(b[3]), t;
+    float *a0 = a, *a1 = a + lda, *a2 = a + 2*lda, *a3 = a + 3*lda;
+    int i;
+
+    for (i = 0; i + 8 <= n; i += 8)
+        {
+        t = _mm256_mul_ps(_mm256_loadu_ps(&a0[i]),b0);
+        t = _mm256_fmadd_ps(_mm256_loadu_ps(&a1[i]),b1,t);
+        t = _mm256_fmadd_ps(_mm256_loadu_ps(&a2[i]),b2,t);
+        t = _mm256_fmadd_ps(_mm256_loadu_ps(&a3[i]),b3,t);
+        _mm256_storeu_ps(&c[i],_mm256_sub_ps(_mm256_loadu_ps(&c[i]),t));
+        }
+    for (; i < n; i++)
+        c[i] -= a0[i]*b[0] + a1[i]*b[1] + a2[i]*b[2] + a3[i]*b[3];
+    }
+
+
+/*
+** AVX-512 kernels, 8 doubles per vector, the tails are done by masking
+*/
+__attribute__((target("avx512f")))
+static void daxpy_avx512(int n,REAL da,REAL *dx,REAL *dy)
+
+    {
+    __m512d a = _mm512_set1_pd(da);
+    __mmask8 k;
+    int i;
+
+    for (i = 0; i + 8 <= n; i += 8)
+        _mm512_storeu_pd(&dy[i],_mm512_fmadd_pd(a,_mm512_loadu_pd(&dx[i]),_mm512_loadu_pd(&dy[i])));
+    if (i < n)
+        {
+        k = (__mmask8)((1 << (n - i)) - 1);
+        _mm512_mask_storeu_pd(&dy[i],k,_mm512_fmadd_pd(a,_mm512_maskz_loadu_pd(k,&dx[i]),
+                              _mm512_maskz_loadu_pd(k,&dy[i])));
+        }
+    }
+
+
+__attribute__((target("avx512f")))
+static REAL ddot_avx512(int n,REAL *dx,REAL *dy)
+
+    {
+    __m512d s0 = _mm512_setzero_pd(), s1 = _mm512_setzero_pd();
+    __mmask8 k;
+    int i;
+
+    for (i = 0; i + 16 <= n; i += 16)
+        {
+        s0 = _mm512_fmadd_pd(_mm512_loadu_pd(&dx[i]),_mm512_loadu_pd(&dy[i]),s0);
+        s1 = _mm512_fmadd_pd(_mm512_loadu_pd(&dx[i+8]),_mm512_loadu_pd(&dy[i+8]),s1);
+        }
+    for (; i < n; i += 8)
+        {
+        k = (n - i >= 8) ? (__mmask8)0xff : (__mmask8)((1 << (n - i)) - 1);
+        s0 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(k,&dx[i]),_mm512_maskz_loadu_pd(k,&dy[i]),s0);
+        }
+    return(_mm512_reduce_add_pd(_mm512_add_pd(s0,s1)));
+    }
+
+
+__attribute__((target("avx512f")))
+static void dscal_avx512(int n,REAL da,REAL *dx)
+
+    {
+    __m512d a = _mm512_set1_pd(da);
+    __mmask8 k;
+    int i;
+
+    for (i = 0; i + 8 <= n; i += 8)
+        _mm512_storeu_pd(&dx[i],_mm512_mul_pd(a,_mm512_loadu_pd(&dx[i])));
+    if (i < n)
+        {
+        k = (__mmask8)((1 << (n - i)) - 1);
+        _mm512_mask_storeu_pd(&dx[i],k,_mm512_mul_pd(a,_mm512_maskz_loadu_pd(k,&dx[i])));
+        }
+    }
+
+
+__attribute__((target("avx512f")))
+static int idamax_avx512(int n,REAL *dx)
+
+    {
+    __m512d m = _mm512_setzero_pd();
+    __mmask8 k;
+    int i;
+
+    for (i = 0; i + 8 <= n; i += 8)
+        m = _mm512_max_pd(m,_mm512_abs_pd(_mm512_loadu_pd(&dx[i])));
+    if (i < n)
+        {
+        k = (__mmask8)((1 << (n - i)) - 1);
+        m = _mm512_max_pd(m,_mm512_abs_pd(_mm512_maskz_loadu_pd(k,&dx[i])));
+        }
+    return(idamax_find(n,dx,_mm512_reduce_max_pd(m)));
+    }
+
+
+__attribute__((target("avx512f")))
+static void daxpy4_avx512(int n,REAL *c,REAL *a,int lda,REAL *b)
+
+    {
+    __m512d b0 = _mm512_set1_pd(b[0]), b1 = _mm512_set1_pd(b[1]);
+    __m512d b2 = _mm512_set1_pd(b[2]), b3 = _mm512_set1_pd(b[3]), t;
+    REAL *a0 = a, *a1 = a + lda, *a2 = a + 2*lda, *a3 = a + 3*lda;
+    __mmask8 k;
+    int i;
+
+    for (i = 0; i < n; i += 8)
+        {
+        k = (n - i >= 8) ? (__mmask8)0xff : (__mmask8)((1 << (n - i)) - 1);
+        t = _mm512_mul_pd(_mm512_maskz_loadu_pd(k,&a0[i]),b0);
+        t = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(k,&a1[i]),b1,t);
+        t = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(k,&a2[i]),b2,t);
+        t = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(k,&a3[i]),b3,t);
+        _mm512_mask_storeu_pd(&c[i],k,_mm512_sub_pd(_mm512_maskz_loadu_pd(k,&c[i]),t));
+        }
+    }
+
+
+__attribute__((target("avx512f")))
+static void saxpy_avx512(int n,float da,float *dx,float *dy)
+
+    {
+    __m512 a = _mm512_set1_ps(da);
+    __mmask16 k;
+    int i;
+
+    for (i = 0; i + 16 <= n; i += 16)
+        _mm512_storeu_ps(&dy[i],_mm512_fmadd_ps(a,_mm512_loadu_ps(&dx[i]),_mm512_loadu_ps(&dy[i])));
+    if (i < n)
+        {
+        k = (__mmask16)((1 << (n - i)) - 1);
+        _mm512_mask_storeu_ps(&dy[i],k,_mm512_fmadd_ps(a,_mm512_maskz_loadu_ps(k,&dx[i]),
+                              _mm512_maskz_loadu_ps(k,&dy[i])));
+        }
+    }
+
+
+__attribute__((target("avx512f")))
+static void saxpy4_avx512(int n,float *c,float *a,int lda,float *b)
+
+    {
+    __m512 b0 = _mm512_set1_ps(b[0]), b1 = _mm512_set1_ps(b[1]);
+    __m512 b2 = _mm512_set1_ps(b[2]), b3 = _mm512_set1_ps(b[3]), t;
+    float *a0 = a, *a1 = a + lda, *a2 = a + 2*lda, *a3 = a + 3*lda;
+    __mmask16 k;
+    int i;
+
+    for (i = 0; i < n; i += 16)
+        {
+        k = (n - i >= 16) ? (__mmask16)0xffff : (__mmask16)((1 << (n - i)) - 1);
+        t = _mm512_mul_ps(_mm512_maskz_loadu_ps(k,&a0[i]),b0);
+        t = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(k,&a1[i]),b1,t);
+        t = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(k,&a2[i]),b2,t);
+        t = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(k,&a3[i]),b3,t);
+        _mm512_mask_storeu_ps(&c[i],k,_mm512_sub_ps(_mm512_maskz_loadu_ps(k,&c[i]),t));
+        }
+    }
+#endif
+
+
+static const tLinpackKernels lpKernelsTable[LINPACK_ISA_COUNT] = {
+    { "generic", daxpy_gen, ddot_gen, dscal_gen, idamax_gen, daxpy4_gen, saxpy_gen, saxpy4_gen },
+#ifdef LINPACK_SIMD
+    { "sse2", daxpy_sse2, ddot_sse2, dscal_sse2, idamax_sse2, daxpy4_sse2, saxpy_sse2, saxpy4_sse2 },
+    { "avx2", daxpy_avx2, ddot_avx2, dscal_avx2, idamax_avx2, daxpy4_avx2, saxpy_avx2, saxpy4_avx2 },
+    { "avx512", daxpy_avx512, ddot_avx512, dscal_avx512, idamax_avx512, daxpy4_avx512, saxpy_avx512,
+      saxpy4_avx512 },
+#else
+    { "sse2", NULL, NULL, NULL, NULL, NULL, NULL, NULL },
+    { "avx2", NULL, NULL, NULL, NULL, NULL, NULL, NULL },
+    { "avx512", NULL, NULL, NULL, NULL, NULL, NULL, NULL },
+#endif
+};
+
+
 static REAL second(void)
 
     {
-    return ((REAL)((REAL)clock()/(REAL)CLOCKS_PER_SEC));
+    return ((REAL)((double)nanotime()/NSEC_PER_SEC));
     }
 
 
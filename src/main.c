@@ -46,23 +46,89 @@ do {} while(0)
 #define FLAG_DISK_STAT		0x200
 #define FLAG_NETS_STAT		0x400
 #define FLAG_NETC_STAT		0x800
+#define FLAG_CPU_DHRY_SCALE	0x1000
+#define FLAG_CPU_WHET_SCALE	0x2000
+#define FLAG_CPU_LINPACK_BLK	0x4000
+#define FLAG_CPU_LINPACK_SIMD	0x8000
+#define FLAG_CPU_LINPACK_SCALE	0x10000
+#define FLAG_CPU_LINPACK_PREC	0x20000
+#define FLAG_CPU_LINPACK_SWEEP	0x40000
+#define FLAG_TIMER_GET		0x80000
+#define FLAG_MEM_BANDWIDTH	0x100000
+#define FLAG_MEM_LATENCY	0x200000
+#define FLAG_MEM_NUMA		0x400000
+#define FLAG_MEM_PAGES		0x800000
+#define FLAG_TOPOLOGY		0x1000000
+#define FLAG_CPU_FREQ		0x2000000
+#define FLAG_CPU_C2C		0x4000000
+#define FLAG_CPU_SYNC		0x8000000
+#define FLAG_SYSCALL		0x10000000
+#define FLAG_MEM_ALLOC		0x20000000
+#define FLAG_MEM_FAULTS		0x40000000
+#define FLAG_MEM_COPY		0x80000000ULL
+#define FLAG_PERF			0x100000000ULL
+#define FLAG_REPEAT			0x200000000ULL
+#define FLAG_STEADY			0x400000000ULL
+#define FLAG_CPU_ISA		0x800000000ULL
 
 int lpArrSize = 0;
+int dhryThreads = 0;
+int whetThreads = 0;
+int lpThreads = 0;
+int lpSweepPct = 0;
+int freqCores = 0;
+int c2cCpus = 0;
+int syncThreads = 0;
+int timerSrc = TIMER_SOURCE_AUTO;
+int membwThreads = 0;
+unsigned long long membwSize = 0;
+unsigned long long memlatSize = 0;
+int allocThreads = 0;
+int faultThreads = 0;
+unsigned long long copySize = 0;
 unsigned long long dioBufSize = 0;
 unsigned long long nioBufSize = 0;
 int prec = 2;
 char tempDir[1024] = { 0 };
 int outType = FORMAT_PLAIN;
+int perfOn = 0;
+float repeatCI = 0.0;
+int repeatBudget = 60;
+int steadyTime = 0;
+int cpuIsa = -1;
+tPerf perf;
 
 struct option options[] = {
 	{ "cpu-affinity-get", 0, NULL, 'g' },
 	{ "cpu-affinity-set", 1, NULL, 's' },
 	{ "cpu-get", 0, NULL, 'c' },
+	{ "cpu-topology", 0, NULL, 'o' },
 	{ "cpu-get-speed", 0, NULL, 'p' },
+	{ "cpu-frequency", 1, NULL, 'F' },
+	{ "cpu-c2c", 1, NULL, 'C' },
+	{ "cpu-sync", 1, NULL, 'K' },
+	{ "syscall", 0, NULL, 'y' },
 	{ "cpu-get-dhrystone", 0, NULL, 'h' },
+	{ "cpu-dhrystone-threads", 1, NULL, 'D' },
 	{ "cpu-get-whetstone", 0, NULL, 'w' },
+	{ "cpu-whetstone-threads", 1, NULL, 'W' },
 	{ "cpu-get-linpack", 1, NULL, 'l' },
+	{ "cpu-linpack-blocked", 0, NULL, 'B' },
+	{ "cpu-linpack-simd", 0, NULL, 'S' },
+	{ "cpu-linpack-threads", 1, NULL, 'L' },
+	{ "cpu-linpack-precision", 0, NULL, 'P' },
+	{ "cpu-linpack-sweep", 1, NULL, 'Y' },
+	{ "cpu-isa", 1, NULL, 'V' },
+	{ "cpu-isa-variants", 0, NULL, 'I' },
 	{ "memory-get", 0, NULL, 'm' },
+	{ "memory-bandwidth", 1, NULL, 'b' },
+	{ "memory-bandwidth-size", 1, NULL, 'z' },
+	{ "memory-latency", 1, NULL, 'a' },
+	{ "memory-numa", 0, NULL, 'N' },
+	{ "memory-pages", 0, NULL, 'H' },
+	{ "memory-alloc", 1, NULL, 'A' },
+	{ "memory-faults", 1, NULL, 'G' },
+	{ "memory-copy", 1, NULL, 'M' },
 #ifdef ENABLE_MEM_DUMP
 	{ "memory-dump", 0, NULL, 'd' },
 #endif
@@ -73,6 +139,11 @@ struct option options[] = {
 	{ "precision", 1, NULL, 'r' },
 	{ "cpu-all", 1, NULL, 'u' },
 	{ "format", 1, NULL, 'f' },
+	{ "timer", 1, NULL, 'T' },
+	{ "perf", 0, NULL, 'j' },
+	{ "repeat", 1, NULL, 'R' },
+	{ "repeat-budget", 1, NULL, 'U' },
+	{ "steady", 1, NULL, 'E' },
 	{ NULL, 0, NULL, 0 } };
 
 void usage(char *name)
@@ -80,14 +151,37 @@ void usage(char *name)
 	printf(	"Syntax: %s [options]\n\n"
 			"where option could be one of following:\n\n"
 			"\t--cpu-affinity-get                     get the CPU affinity\n"
-			"\t--cpu-affinity-set <mask>              set the CPU affinity to <mask>\n"
+			"\t--cpu-affinity-set <mask|list>         set the CPU affinity to <mask> (e.g. 0xff) or <list> (e.g. 0-15,64-79)\n"
 			"\t--cpu-get                              get the CPU information (total/online)\n"
+			"\t--cpu-topology                         get the CPU packages, cores, threads, NUMA nodes and caches\n"
 			"\t--cpu-get-speed                        get (measure) the CPU speed\n"
+			"\t--cpu-frequency <num>                  get the effective per-core frequency alone and with 1..<num> cores loaded (0 for all cores)\n"
+			"\t--cpu-c2c <num>                        get the core-to-core cache line latency matrix of the first <num> CPUs (0 for all CPUs)\n"
+			"\t--cpu-sync <num>                       get the lock and atomic throughput and fairness for 1..<num> pinned threads (0 for all CPUs)\n"
+			"\t--syscall                              get the system call, vDSO and context switch overhead\n"
 			"\t--cpu-get-dhrystone                    get the CPU Dhrystone in DMIPS\n"
-			"\t--cpu-get-whetstone                    get the CPU Whetstone in MIPS\n"
-			"\t--cpu-get-linpack <size>               get the CPU Linpack score for specified array size (e.g. 200)\n"
+			"\t--cpu-dhrystone-threads <num>          get the Dhrystone scaling for 1..<num> pinned threads (0 for all CPUs)\n"
+			"\t--cpu-get-whetstone                    get the CPU Whetstone in MIPS with per-module breakdown\n"
+			"\t--cpu-whetstone-threads <num>          get the Whetstone scaling for 1..<num> pinned threads (0 for all CPUs)\n"
+			"\t--cpu-get-linpack <size>               get the CPU Linpack score for specified array size (e.g. 200, 0 for cache based)\n"
+			"\t--cpu-linpack-blocked                  get also the Linpack score of the cache-blocked LU engine\n"
+			"\t--cpu-linpack-simd                     get also the Linpack score for each supported SIMD instruction set\n"
+			"\t--cpu-linpack-threads <num>            get the parallel Linpack scaling for 1..<num> pinned threads (0 for all CPUs)\n"
+			"\t--cpu-linpack-precision                get the Linpack score and residual in single, double and mixed precision\n"
+			"\t--cpu-linpack-sweep <percent>          get the Linpack score for array sizes from L1 up to <percent> of RAM\n"
+			"\t--cpu-isa <level>                      run Dhrystone, Whetstone and Linpack built for <level> (baseline, x86-64-v2,\n"
+			"\t                                       x86-64-v3 or x86-64-v4, default is the highest level supported by the CPU)\n"
+			"\t--cpu-isa-variants                     get Dhrystone, Whetstone and Linpack built for every supported level\n"
 			"\t--cpu-all <linpack-size>               perform all CPU-related tests and also get memory size\n"
 			"\t--memory-get                           get the physical memory size\n"
+			"\t--memory-bandwidth <num>               get the STREAM memory bandwidth for 1..<num> pinned threads (0 for all CPUs)\n"
+			"\t--memory-bandwidth-size <size>         set the size of one STREAM and NUMA array (supports k, M, G suffixes)\n"
+			"\t--memory-latency <size>                get the memory latency for working sets from 4k up to <size> (0 for cache based)\n"
+			"\t--memory-numa                          get the bandwidth and latency matrix between all NUMA nodes\n"
+			"\t--memory-pages                         compare the memory and Linpack results on 4K, THP and HugeTLB pages\n"
+			"\t--memory-alloc <num>                   get the malloc/free throughput and RSS for 1..<num> pinned threads (0 for all CPUs)\n"
+			"\t--memory-faults <num>                  get the page fault throughput and munmap cost for 1..<num> threads (0 for all CPUs)\n"
+			"\t--memory-copy <size>                   get the memcpy, memmove and memset throughput for blocks from 8 bytes up to <size> (0 for 512M)\n"
 #ifdef ENABLE_MEM_DUMP
 			"\t--memory-dump                          dump the memory\n"
 #endif
@@ -96,7 +190,15 @@ void usage(char *name)
 			"\t--disk-get-benchmark <size>            get the benchmark statistics for disk I/O for test data of <size> (supports k, M, G suffixes)\n"
 			"\t--net-benchmark-server :<port>         create the server on local <port> for network I/O benchmarking\n"
 			"\t--net-benchmark-client <host> <size>   connect to host[:port] defined by <host> to perform I/O benchmarking for <size> (k, M, G suffixed)\n"
-			"\t--format <format>                      output results in <format> (can be plain, xml or csv)\n\n",
+			"\t--format <format>                      output results in <format> (can be plain, xml or csv)\n"
+			"\t--timer <source>                       use the timer <source> (auto, clock or tsc) and report its resolution\n"
+			"\t--perf                                 count cycles, instructions, cache and branch misses and context switches\n"
+			"\t                                       of the Dhrystone, Whetstone, Linpack, disk and network benchmarks\n"
+			"\t--repeat <percent>                     repeat the CPU speed, Dhrystone, Whetstone and Linpack runs until the 95%% confidence\n"
+			"\t                                       interval is within <percent> of the mean and report their statistics\n"
+			"\t--repeat-budget <seconds>              stop repeating every benchmark after <seconds> (default value: 60)\n"
+			"\t--steady <seconds>                     run Dhrystone on all CPUs (and disk write with --disk-get-benchmark) for <seconds>\n"
+			"\t                                       (0 for 60) and report the burst and steady-state throughput\n\n",
 			name);
 }
 
@@ -129,11 +231,13 @@ unsigned long long argvToSize(char *arg)
 	return atoi(arg) * multiplicator;
 }
 
-int parse_args(int argc, char *argv[])
+unsigned long long parse_args(int argc, char *argv[])
 {
-	int opt, idx = 0, flags = 0;
-	unsigned long long val = 0;
+	unsigned long long flags = 0;
+	int opt, idx = 0;
+	tCpuSet cpus;
 #ifdef ENABLE_MEM_DUMP
+	unsigned long long val = 0;
 	unsigned long long cnt = 0;
 #endif
 
@@ -147,28 +251,94 @@ int parse_args(int argc, char *argv[])
 					flags |= FLAG_CA_GET;
 					break;
 			case 's':
-					if (strncmp(optarg, "0x", 2) == 0)
-						val = strtoull(optarg, NULL, 16);
-					else
-						val = strtoull(optarg, NULL, 10);
+					if (cpu_set_init(&cpus, 0) != 0)
+						break;
 
-					if (val > 0)
-						DPRINTF("Setting up CPU mask %d: %s\n", (int)val,
-							(cpu_affinity_set(getpid(), (int)val) == 0) ? "OK" : "FAIL");
+					if (cpu_set_parse(optarg, &cpus) > 0) {
+						char *list = cpu_set_format(&cpus, 1);
+
+						DPRINTF("Setting up CPUs %s: %s\n", (list != NULL) ? list : optarg,
+							(cpu_affinity_set(getpid(), &cpus) == 0) ? "OK" : "FAIL");
+						free(list);
+					}
+					else
+						fprintf(stderr, "Invalid CPU mask or list: %s\n", optarg);
+					cpu_set_free(&cpus);
 					flags |= FLAG_CA_SET;
 					break;
 			case 'c':
 					flags |= FLAG_CPU_GET;
 					break;
+			case 'o':
+					flags |= FLAG_TOPOLOGY;
+					break;
 			case 'p':
 					flags |= FLAG_CPU_SPEED;
 					break;
+			case 'F':
+					flags |= FLAG_CPU_FREQ;
+					if (optarg != NULL)
+						freqCores = atoi(optarg);
+					break;
+			case 'C':
+					flags |= FLAG_CPU_C2C;
+					if (optarg != NULL)
+						c2cCpus = atoi(optarg);
+					break;
+			case 'K':
+					flags |= FLAG_CPU_SYNC;
+					if (optarg != NULL)
+						syncThreads = atoi(optarg);
+					break;
+			case 'y':
+					flags |= FLAG_SYSCALL;
+					break;
 			case 'm':
 					flags |= FLAG_MEM_GET;
 					break;
+			case 'b':
+					flags |= FLAG_MEM_BANDWIDTH;
+					if (optarg != NULL)
+						membwThreads = atoi(optarg);
+					break;
+			case 'z':
+					if (optarg != NULL)
+						membwSize = argvToSize(optarg);
+					break;
+			case 'a':
+					flags |= FLAG_MEM_LATENCY;
+					if (optarg != NULL)
+						memlatSize = argvToSize(optarg);
+					break;
+			case 'N':
+					flags |= FLAG_MEM_NUMA;
+					break;
+			case 'H':
+					flags |= FLAG_MEM_PAGES;
+					break;
+			case 'A':
+					flags |= FLAG_MEM_ALLOC;
+					if (optarg != NULL)
+						allocThreads = atoi(optarg);
+					break;
+			case 'G':
+					flags |= FLAG_MEM_FAULTS;
+					if (optarg != NULL)
+						faultThreads = atoi(optarg);
+					break;
+			case 'M':
+					flags |= FLAG_MEM_COPY;
+					if (optarg != NULL)
+						copySize = argvToSize(optarg);
+					break;
 			case 'h':
 					flags |= FLAG_CPU_DHRYSTONE;
 					break;
+			case 'D':
+					flags |= FLAG_CPU_DHRY_SCALE;
+					if (optarg != NULL)
+						dhryThreads = atoi(optarg);
+					break;
 			case 'f':
 					if (strcmp(optarg, "plain") == 0)
 						outType = FORMAT_PLAIN;
@@ -186,15 +356,84 @@ int parse_args(int argc, char *argv[])
 			case 'w':
 					flags |= FLAG_CPU_WHETSTONE;
 					break;
+			case 'W':
+					flags |= FLAG_CPU_WHET_SCALE;
+					if (optarg != NULL)
+						whetThreads = atoi(optarg);
+					break;
 			case 'l':
 					flags |= FLAG_CPU_LINPACK;
 					if (optarg != NULL)
 						lpArrSize = atoi(optarg);
 					break;
+			case 'B':
+					flags |= FLAG_CPU_LINPACK_BLK;
+					break;
+			case 'S':
+					flags |= FLAG_CPU_LINPACK_SIMD;
+					break;
+			case 'V':
+					if ((cpuIsa = cpu_isa_parse(optarg)) < 0) {
+						fprintf(stderr, "Invalid CPU kernel level, valid levels are: baseline, x86-64-v2, x86-64-v3, x86-64-v4\n");
+						exit(1);
+					}
+					break;
+			case 'I':
+					flags |= FLAG_CPU_ISA;
+					break;
+			case 'L':
+					flags |= FLAG_CPU_LINPACK_SCALE;
+					if (optarg != NULL)
+						lpThreads = atoi(optarg);
+					break;
+			case 'P':
+					flags |= FLAG_CPU_LINPACK_PREC;
+					break;
+			case 'Y':
+					flags |= FLAG_CPU_LINPACK_SWEEP;
+					if (optarg != NULL)
+						lpSweepPct = atoi(optarg);
+					break;
 			case 'r':
 					if (optarg != NULL)
 						prec = atoi(optarg);
 					break;
+			case 'T':
+					flags |= FLAG_TIMER_GET;
+					if (strcmp(optarg, "auto") == 0)
+						timerSrc = TIMER_SOURCE_AUTO;
+					else
+					if (strcmp(optarg, "clock") == 0)
+						timerSrc = TIMER_SOURCE_CLOCK;
+					else
+					if (strcmp(optarg, "tsc") == 0)
+						timerSrc = TIMER_SOURCE_TSC;
+					else {
+						fprintf(stderr, "Invalid timer source, valid sources are: auto, clock, tsc\n");
+						exit(1);
+					}
+					break;
+			case 'j':
+					flags |= FLAG_PERF;
+					break;
+			case 'R':
+					flags |= FLAG_REPEAT;
+					if (optarg != NULL)
+						repeatCI = atof(optarg);
+					if (repeatCI <= 0.0) {
+						fprintf(stderr, "Error: Confidence interval has to be a positive percentage\n");
+						exit(1);
+					}
+					break;
+			case 'U':
+					if (optarg != NULL)
+						repeatBudget = atoi(optarg);
+					break;
+			case 'E':
+					flags |= FLAG_STEADY;
+					if (optarg != NULL)
+						steadyTime = atoi(optarg);
+					break;
 			case 'i':
 					flags |= FLAG_DISK_STAT;
 					if (optarg != NULL)
@@ -264,26 +503,154 @@ int parse_args(int argc, char *argv[])
 
 void get_affinity(void)
 {
-	char out[1024] = { 0 }, tmp[32] = { 0 };
-	int totalCpuCount, i, num = 0;
-	uint64_t cmask;
-	totalCpuCount = cpu_affinity_get(getpid(), &cmask);
+	tCpuSet cpus;
+	int num;
+
+	if ((num = cpu_affinity_get(getpid(), &cpus)) < 0) {
+		fprintf(stderr, "Error: Cannot get the CPU affinity: %s\n", strerror(-num));
+		return;
+	}
 
-	DPRINTF("This process is running on following cpu(s): ");
+	results->cpumask = cpu_set_format(&cpus, 0);
+	results->cpulist = cpu_set_format(&cpus, 1);
+	results->cpus = num;
+	cpu_set_free(&cpus);
 
-	for (i = 0; i < totalCpuCount; i++) {
-		if (cmask & (1 << i)) {
-			snprintf(tmp, sizeof(tmp), "CPU #%d, ", i);
-			strncat(out, tmp, sizeof(out));
-			num++;
+	DPRINTF("This process is running on following cpu(s): %s\n", (results->cpulist != NULL) ? results->cpulist : "");
+}
+
+/* Starts counting the benchmark region when the performance counters are enabled */
+void perf_region_start(void)
+{
+	if (perfOn)
+		perf_start(&perf);
+}
+
+/*
+ * Stops counting the benchmark region and appends its counters to the results, the work done by the region in
+ * the units (e.g. bytes) is used for the cycles per unit
+ */
+void perf_region_stop(const char *benchmark, const char *operation, unsigned long chunk, unsigned long long work,
+			const char *unit)
+{
+	tPerfRegion *reg;
+
+	if (!perfOn)
+		return;
+
+	reg = (tPerfRegion *)realloc(results->perf, (results->perf_size + 1) * sizeof(tPerfRegion));
+	if (reg == NULL)
+		return;
+	results->perf = reg;
+
+	reg = &results->perf[results->perf_size++];
+	memset(reg, 0, sizeof(tPerfRegion));
+	perf_stop(&perf, &reg->counts);
+	strncpy(reg->benchmark, benchmark, sizeof(reg->benchmark) - 1);
+	strncpy(reg->operation, operation, sizeof(reg->operation) - 1);
+	reg->chunk_size = chunk;
+	reg->work = work;
+	reg->unit = unit;
+}
+
+/*
+ * Runs the benchmark once or, when the repetition is enabled, until its confidence interval is met. The first
+ * metric is called name and measured in unit, the others are the details named and measured by detailName()
+ * and detailUnit(). The num metrics are stored to values, their medians when repeated, and their statistics
+ * are appended to the results. Returns the number of the runs done or a negative errno value.
+ */
+int repeat_run(const char *name, const char *unit, int (*func)(void *, double *), void *arg, int num,
+			const char *(*detailName)(int), const char *(*detailUnit)(int), double *values)
+{
+	tStatsResult *res;
+	tStats *st;
+	int i, rc;
+
+	if (repeatCI <= 0.0)
+		return ((rc = func(arg, values)) != 0) ? rc : 1;
+
+	st = (tStats *)malloc( num * sizeof(tStats) );
+	if (st == NULL)
+		return -ENOMEM;
+	memset(st, 0, num * sizeof(tStats));
+
+	fprintf(stderr, "Repeating %s until the confidence interval is within %.*f%%\n", name, prec, repeatCI);
+	if ((rc = stats_repeat(func, arg, num, repeatCI, repeatBudget * NSEC_PER_SEC, st)) != 0) {
+		free(st);
+		return rc;
+	}
+
+	res = (tStatsResult *)realloc(results->stats, (results->stats_size + num) * sizeof(tStatsResult));
+	if (res != NULL) {
+		results->stats = res;
+		for (i = 0; i < num; i++) {
+			res = &results->stats[results->stats_size++];
+			if (i == 0)
+				snprintf(res->name, sizeof(res->name), "%s", name);
+			else
+				snprintf(res->name, sizeof(res->name), "%s %s", name, detailName(i - 1));
+			res->unit = (i == 0) ? unit : detailUnit(i - 1);
+			res->stats = st[i];
 		}
 	}
 
-	results->cpumask = cmask;
-	results->cpus = num;
+	for (i = 0; i < num; i++)
+		values[i] = st[i].median;
+	rc = st[0].runs + st[0].warmup;
+	free(st);
+
+	return rc;
+}
+
+int repeat_cpu_speed(void *arg, double *values)
+{
+	values[0] = cpu_get_speed_mhz();
+	return 0;
+}
+
+/* The arg holds the Dhrystone score, the loops and the benchmark time of the last run */
+int repeat_dhrystone(void *arg, double *values)
+{
+	unsigned long *dhry = (unsigned long *)arg;
+
+	cpu_isa_dhrystone_get(results->cpu_isa, &dhry[0], &dhry[1], &dhry[2]);
+	values[0] = (double)dhry[0] / DHRYSTONE_VAX_SCORE;
+
+	return 0;
+}
+
+/* The arg holds the loops, iterations, benchmark time and MIPS of the last run, the modules are the details */
+int repeat_whetstone(void *arg, double *values)
+{
+	unsigned long *whet = (unsigned long *)arg;
+	float modules[WHETSTONE_MODULES];
+	int i;
+
+	cpu_isa_whetstone_get(results->cpu_isa, &whet[0], &whet[1], &whet[2], &whet[3], modules);
+	values[0] = whet[3];
+	for (i = 0; i < WHETSTONE_MODULES; i++)
+		values[i + 1] = modules[i];
 
-	out[strlen(out) - 2] = 0;
-	DPRINTF("%s\n", out);
+	return 0;
+}
+
+typedef struct {
+	int arsize;
+	unsigned long memory;
+	float min;
+	float max;
+} tLinpackRun;
+
+/* The arg holds the array size and gets the memory and the minimum and maximum of the last run */
+int repeat_linpack(void *arg, double *values)
+{
+	tLinpackRun *lp = (tLinpackRun *)arg;
+	float avg;
+
+	cpu_isa_linpack_score(results->cpu_isa, lp->arsize, &lp->memory, &lp->min, &lp->max, &avg);
+	values[0] = avg;
+
+	return 0;
 }
 
 #define DISK_ACTION_ON_ARRAY(prec, msg, funcName) \
@@ -293,7 +660,9 @@ while ((num < size) && (i < dioBufNum)) { \
 	float res = 0.0, fcpu = 0.0;	\
 	char size_num[16] = { 0 }, size_res[16] = { 0 }; \
 	num = dioBufferArray[i++] * (1 << 10);	\
+	perf_region_start(); \
 	res = funcName(num, &fcpu); \
+	perf_region_stop("disk", msg, num, size, "byte"); \
 	\
 	strncpy(results->disk[dIdx].operation, msg, sizeof(results->disk[dIdx].operation)); \
 	results->disk[dIdx].size = size; \
@@ -313,7 +682,9 @@ while ((num < size) && (i < dioBufNum)) { \
 	float res = 0.0, fcpu = 0.0;	\
 	char size_num[16] = { 0 }, size_res[16] = { 0 }; \
 	num = dioBufferArray[i++] * (1 << 10);	\
+	perf_region_start(); \
 	res = funcName(num, param, &fcpu); \
+	perf_region_stop("disk", msg, num, size, "byte"); \
 	\
 	strncpy(results->disk[dIdx].operation, msg, sizeof(results->disk[dIdx].operation)); \
 	results->disk[dIdx].size = size; \
@@ -349,10 +720,12 @@ void disk_io_process(unsigned long long size, long files)
 
 	results->disk_res_size =  (3 * dioBufNum) + 3;
 	results->disk = (tIOResults *)malloc( results->disk_res_size * sizeof(tIOResults) );
-	memset(results->disk, 0, results->disk_res_size);
+	memset(results->disk, 0, results->disk_res_size * sizeof(tIOResults));
 
 	fprintf(stderr, "Disk: Getting %d results, this may take some time\n", results->disk_res_size);
+	perf_region_start();
 	fres = disk_throughput_putc(size, &fcpu);
+	perf_region_stop("disk", DISK_OP_PUTC(outType), 1, size, "byte");
 
 	strncpy(results->disk[dIdx].operation, DISK_OP_PUTC(outType), sizeof(results->disk[dIdx].operation));
 	results->disk[dIdx].size = size;
@@ -367,7 +740,9 @@ void disk_io_process(unsigned long long size, long files)
 	DISK_ACTION_ON_ARRAY(prec, DISK_OP_READ(outType), disk_throughput_read);
 	DISK_ACTION_ON_ARRAY_PARAM(prec, DISK_OP_READ_RANDOM(outType), disk_throughput_read_random, -1);
 
+	perf_region_start();
 	fres = disk_benchmark_create(files, &fcpu);
+	perf_region_stop("disk", DISK_OP_FILE_CREATE(outType), 1, files, "file");
 	DPRINTF("Create benchmark: %.*f files/s (CPU %.*f%%)\n", prec, fres, prec, fcpu);
 
 	strncpy(results->disk[dIdx].operation, DISK_OP_FILE_CREATE(outType), sizeof(results->disk[dIdx].operation));
@@ -376,7 +751,9 @@ void disk_io_process(unsigned long long size, long files)
 	results->disk[dIdx].chunk_size = 1;
 	results->disk[dIdx++].cpu_usage = fcpu;
 
+	perf_region_start();
 	fres = disk_benchmark_delete(&files, &fcpu);
+	perf_region_stop("disk", DISK_OP_FILE_DELETE(outType), 1, files, "file");
 	DPRINTF("Delete benchmark: %.*f files/s (CPU %.*f%%)\n", prec, fres, prec, fcpu);
 
 	strncpy(results->disk[dIdx].operation, DISK_OP_FILE_DELETE(outType), sizeof(results->disk[dIdx].operation));
@@ -424,7 +801,9 @@ void net_io_process(int server)
 
 				total = nioBufSize;
 				chunk = (unsigned long long)nioBufferArray[ii] * (1 << 10);
+				perf_region_start();
 				net_write_command(sock, total, chunk, chunk, &tm, &cpu);
+				perf_region_stop("net", NET_OP_READ(outType), chunk, total, "byte");
 
 				strncpy(results->net[nioIdx].operation, NET_OP_READ(outType), sizeof(results->net[nioIdx].operation));
 				results->net[nioIdx].size = total;
@@ -444,153 +823,2040 @@ void net_io_process(int server)
 	}
 }
 
-void printResults(int flags, int type)
+void cpu_dhrystone_scale_process(int threads)
 {
-	char tmp[16];
-	int i;
+	unsigned long *dhry;
+	int i, n, err;
+
+	if (threads <= 0)
+		threads = cpu_thread_count();
+	if (threads <= 0)
+		return;
+
+	dhry = (unsigned long *)malloc( threads * sizeof(unsigned long) );
+	results->cpu_dhrystone_scale = (tScaleResults *)malloc( threads * sizeof(tScaleResults) );
+	memset(results->cpu_dhrystone_scale, 0, threads * sizeof(tScaleResults));
+
+	fprintf(stderr, "Dhrystone: Getting scaling for 1 to %d threads, this may take some time\n", threads);
+	for (n = 1; n <= threads; n++) {
+		tScaleResults *res = &results->cpu_dhrystone_scale[n - 1];
+
+		res->cpu = (int *)malloc( n * sizeof(int) );
+		res->score = (float *)malloc( n * sizeof(float) );
+		if ((err = cpu_dhrystone_threads_get(n, res->cpu, dhry)) != 0) {
+			fprintf(stderr, "Error: Cannot run Dhrystone in %d threads: %s\n", n, strerror(-err));
+			free(res->cpu);
+			free(res->score);
+			break;
+		}
 
-	if (type == FORMAT_PLAIN) {
-		if (flags & FLAG_CA_GET) {
-			printf("Processors used: %d\n", results->cpus);
-			printf("Processor mask: 0x%" PRIx64 "\n", results->cpumask);
+		res->threads = n;
+		for (i = 0; i < n; i++) {
+			res->score[i] = (float)dhry[i] / DHRYSTONE_VAX_SCORE;
+			res->total += res->score[i];
 		}
-		if (flags & FLAG_CPU_GET) {
-			printf("Processors total: %d\n", results->cpu_total);
-			printf("Processors online: %d\n", results->cpu_online);
+		res->efficiency = res->total / (n * results->cpu_dhrystone_scale[0].total);
+		results->cpu_dhrystone_scale_size = n;
+
+		DPRINTF("Dhrystone in %d threads: %.*f DMIPS total, scaling efficiency %.*f%%\n", n, prec, res->total,
+				prec, res->efficiency * 100.0);
+	}
+
+	free(dhry);
+}
+
+void cpu_whetstone_scale_process(int threads)
+{
+	unsigned long *mips;
+	int i, j, n, err;
+
+	if (threads <= 0)
+		threads = cpu_thread_count();
+	if (threads <= 0)
+		return;
+
+	mips = (unsigned long *)malloc( threads * sizeof(unsigned long) );
+	results->cpu_whetstone_scale = (tScaleResults *)malloc( threads * sizeof(tScaleResults) );
+	memset(results->cpu_whetstone_scale, 0, threads * sizeof(tScaleResults));
+
+	fprintf(stderr, "Whetstone: Getting scaling for 1 to %d threads, this may take some time\n", threads);
+	for (n = 1; n <= threads; n++) {
+		tScaleResults *res = &results->cpu_whetstone_scale[n - 1];
+
+		res->cpu = (int *)malloc( n * sizeof(int) );
+		res->score = (float *)malloc( n * sizeof(float) );
+		res->detail = (float *)malloc( n * WHETSTONE_MODULES * sizeof(float) );
+		if ((err = cpu_whetstone_threads_get(n, res->cpu, mips, res->detail)) != 0) {
+			fprintf(stderr, "Error: Cannot run Whetstone in %d threads: %s\n", n, strerror(-err));
+			free(res->cpu);
+			free(res->score);
+			free(res->detail);
+			break;
 		}
-		if (flags & FLAG_CPU_SPEED)
-			printf("Processor speed: %.*f MHz\n", prec, results->cpu_speed);
-		if (flags & FLAG_CPU_DHRYSTONE)
-			printf("Processor's Dhrystone: %.*f DMIPS\n", prec, results->cpu_dhrystone);
-		if (flags & FLAG_CPU_WHETSTONE)
-			printf("Processor's Whetstone: %ld MIPS\n", results->cpu_whetstone);
-		if (flags & FLAG_CPU_LINPACK) {
-			printf("Processor's LinPack 2D array score:\n");
-			printf("\tArray size: %dx%d\n", results->cpu_linpack_size, results->cpu_linpack_size);
-			io_get_size(results->cpu_linpack_mem, prec, tmp, 16);
-			printf("\tMemory used: %s\n", tmp);
-			printf("\tMinimum score: %.*f MFLOPS\n", prec, results->cpu_linpack_min);
-			printf("\tMaximum score: %.*f MFLOPS\n", prec, results->cpu_linpack_max);
-			printf("\tAverage score: %.*f MFLOPS\n", prec, results->cpu_linpack_avg);
+
+		res->threads = n;
+		for (i = 0; i < n; i++) {
+			res->score[i] = mips[i];
+			res->total += res->score[i];
 		}
-		if (flags & FLAG_MEM_GET) {
-			io_get_size_double(results->memory_size, prec, tmp, 16);
-			printf("Memory size: %s\n", tmp);
+		res->efficiency = res->total / (n * results->cpu_whetstone_scale[0].total);
+		results->cpu_whetstone_scale_size = n;
+
+		DPRINTF("Whetstone in %d threads: %.*f MIPS total, scaling efficiency %.*f%%\n", n, prec, res->total,
+				prec, res->efficiency * 100.0);
+		for (j = 0; j < WHETSTONE_MODULES; j++) {
+			float total = 0.0;
+
+			for (i = 0; i < n; i++)
+				total += res->detail[i * WHETSTONE_MODULES + j];
+			DPRINTF("\tModule %s: %.*f %s total\n", cpu_whetstone_module_name(j), prec, total,
+					cpu_whetstone_module_unit(j));
 		}
-		if (flags & FLAG_DISK_STAT) {
-			printf("Disk:\n");
-			printf("\tCan drop caches: %s\n", results->disk_drop_caches ? "True" : "False");
-			printf("\tResults:\n");
+	}
 
-			for (i = 0; i < results->disk_res_size; i++) {
-				if (strncmp(results->disk[i].operation, "File", 4) != 0) {
-					char tmp2[16] = { 0 }, tmpChunk[16] = { 0 };
-					io_get_size(results->disk[i].size, 0, tmp, 16);
-					io_get_size(results->disk[i].chunk_size, 0, tmpChunk, 16);
-					io_get_size_double(results->disk[i].throughput, prec, tmp2, 16);
-					printf("\t\t%s of %s with %s buffer: %s/s (CPU %.*f%%)\n", results->disk[i].operation, tmp,
-							tmpChunk, tmp2, prec, results->disk[i].cpu_usage);
-				}
-				else {
-					printf("\t\t%s of %lld files: %.*f files/s (CPU %.*f%%)\n", results->disk[i].operation,
-							results->disk[i].size, prec, results->disk[i].throughput, prec, results->disk[i].cpu_usage);
-				}
-			}
+	free(mips);
+}
+
+void cpu_linpack_scale_process(int threads, int arsize)
+{
+	unsigned long memory;
+	int n, i, err;
+
+	if (threads <= 0)
+		threads = cpu_thread_count();
+	if (threads <= 0)
+		return;
+	if (arsize <= 0)
+		arsize = LINPACK_DEFAULT_SIZE;
+
+	results->cpu_linpack_scale = (tScaleResults *)malloc( threads * sizeof(tScaleResults) );
+	memset(results->cpu_linpack_scale, 0, threads * sizeof(tScaleResults));
+	results->cpu_linpack_scale_arsize = arsize;
+
+	fprintf(stderr, "Linpack: Getting scaling for 1 to %d threads, this may take some time\n", threads);
+	for (n = 1; n <= threads; n++) {
+		tScaleResults *res = &results->cpu_linpack_scale[n - 1];
+
+		res->cpu = (int *)malloc( n * sizeof(int) );
+		res->score = (float *)malloc( n * sizeof(float) );
+		if ((err = get_linpack_threads_score(n, arsize, &memory, res->cpu, res->score, &res->total)) != 0) {
+			fprintf(stderr, "Error: Cannot run Linpack in %d threads: %s\n", n, strerror(-err));
+			free(res->cpu);
+			free(res->score);
+			break;
 		}
-		if (flags & FLAG_NETC_STAT) {
-			int i;
 
-			printf("Network results:\n");
+		res->threads = n;
+		res->efficiency = res->total / (n * results->cpu_linpack_scale[0].total);
+		results->cpu_linpack_scale_size = n;
 
-			for (i = 0; i < results->net_res_size; i++) {
-					char tmp2[16] = { 0 }, tmpChunk[16] = { 0 };
-					io_get_size(results->net[i].size, 0, tmp, 16);
-					io_get_size(results->net[i].chunk_size, 0, tmpChunk, 16);
-					io_get_size_double(results->net[i].throughput, prec, tmp2, 16);
-					printf("\t%s of %s with %s buffer: %s/s (CPU %.*f%%)\n", results->net[i].operation, tmp,
-							tmpChunk, tmp2, prec, results->net[i].cpu_usage);
-			}
-		}
+		DPRINTF("Linpack array size %dx%d, memory %ld KB in %d threads: %.*f GFLOPS total, scaling efficiency %.*f%%\n",
+				arsize, arsize, memory >> 10, n, prec, res->total, prec, res->efficiency * 100.0);
+		for (i = 0; i < n; i++)
+			DPRINTF("\tThread #%d (CPU #%d): %.*f GFLOPS\n", i, res->cpu[i], prec, res->score[i]);
+	}
+}
 
-		printf("Total run time: %.*f seconds\n", prec, results->run_time);
+void cpu_linpack_precision_process(int arsize)
+{
+	unsigned long memory;
+	int i, err;
+
+	if (arsize <= 0)
+		arsize = LINPACK_DEFAULT_SIZE;
+
+	results->cpu_linpack_prec_arsize = arsize;
+	for (i = 0; i < LINPACK_PREC_COUNT; i++) {
+		err = get_linpack_precision_score(i, arsize, &memory, &results->cpu_linpack_prec_gflops[i],
+						&results->cpu_linpack_prec_residual[i], &results->cpu_linpack_prec_iters[i]);
+		if (err != 0)
+			fprintf(stderr, "Error: Linpack in %s precision failed: %s\n", linpack_precision_name(i), strerror(-err));
+
+		DPRINTF("Linpack array size %dx%d, memory %ld KB in %s precision: %.*f GFLOPS, residual %g, %d refinement steps\n",
+				arsize, arsize, memory >> 10, linpack_precision_name(i), prec, results->cpu_linpack_prec_gflops[i],
+				results->cpu_linpack_prec_residual[i], results->cpu_linpack_prec_iters[i]);
 	}
-	else
-	if (type == FORMAT_CSV) {
-		if ((flags & FLAG_CA_GET) || (flags & FLAG_CPU_GET) || (flags & FLAG_CPU_SPEED) || (flags & FLAG_CPU_DHRYSTONE)
-				|| (flags & FLAG_CPU_WHETSTONE) || (flags & FLAG_CPU_LINPACK) || (flags & FLAG_MEM_GET)) {
-			printf("cpus_used,cpu_mask,cpus_total,cpus_online,cpu_speed,cpu_dhrystone,cpu_whetstone,linpack_min,linpack_max,linpack_avg,memory_size,run_time\n");
-			if (flags & FLAG_CA_GET)
-				printf("%d,0x%" PRIx64",", results->cpus, results->cpumask);
-			else
-				printf("-,-,");
+}
 
-			if (flags & FLAG_CPU_GET)
-				printf("%d,%d,", results->cpu_total, results->cpu_online);
-			else
-				printf("-,-,");
+void cpu_linpack_sweep_process(int percent)
+{
+	unsigned long long maxmem;
+	char tmp[16];
+	int i, num;
 
-			if (flags & FLAG_CPU_SPEED)
-				printf("%.*f,", prec, results->cpu_speed);
-			else
-				printf("-,");
+	if ((percent <= 0) || (percent > 100)) {
+		fprintf(stderr, "Error: Invalid Linpack sweep RAM share %d%%, valid values are 1 to 100\n", percent);
+		return;
+	}
 
-			if (flags & FLAG_CPU_DHRYSTONE)
-				printf("%.*f,", prec, results->cpu_dhrystone);
-			else
-				printf("-,");
+	maxmem = (unsigned long long)(memory_size_get(MEMTYPE_B) / 100.0 * percent);
+	io_get_size(maxmem, prec, tmp, sizeof(tmp));
+	fprintf(stderr, "Linpack: Getting the array size sweep up to %s, this may take some time\n", tmp);
 
-			if (flags & FLAG_CPU_WHETSTONE)
-				printf("%ld,", results->cpu_whetstone);
-			else
-				printf("-,");
+	num = get_linpack_sweep(maxmem, &results->cpu_linpack_sweep);
+	if (num < 0) {
+		fprintf(stderr, "Error: Cannot run Linpack size sweep: %s\n", strerror(-num));
+		return;
+	}
+	results->cpu_linpack_sweep_size = num;
 
-			if (flags & FLAG_CPU_LINPACK)
-				printf("%.*f,%.*f,%.*f,", prec, results->cpu_linpack_min, prec, results->cpu_linpack_max,
-						prec, results->cpu_linpack_avg);
-			else
-				printf("-,-,-,");
+	for (i = 0; i < num; i++) {
+		io_get_size_double(results->cpu_linpack_sweep[i].wset, prec, tmp, sizeof(tmp));
+		DPRINTF("Linpack array size %dx%d, working set %s (%s): %.*f MFLOPS\n", results->cpu_linpack_sweep[i].size,
+				results->cpu_linpack_sweep[i].size, tmp, linpack_level_name(results->cpu_linpack_sweep[i].level),
+				prec, results->cpu_linpack_sweep[i].mflops);
+	}
+}
 
-			if (flags & FLAG_MEM_GET)
-				printf("%.f,", results->memory_size);
-			else
-				printf("-,");
+/* Returns the transition of the memory hierarchy level between the sweep points idx - 1 and idx or NULL */
+char *linpack_sweep_transition(int idx, char *buf, int len)
+{
+	tLinpackSweep *pts = results->cpu_linpack_sweep;
 
-			printf("%.*f\n", prec, results->run_time);
-		}
+	if ((idx == 0) || (pts[idx].level == pts[idx - 1].level))
+		return NULL;
 
-		if (flags & FLAG_DISK_STAT) {
-			printf("operation,size,chunk_size,throughput,cpu_usage\n");
+	snprintf(buf, len, "%s-%s", linpack_level_name(pts[idx - 1].level), linpack_level_name(pts[idx].level));
+	return buf;
+}
 
-			for (i = 0; i < results->disk_res_size; i++) {
-				if (strncmp(results->disk[i].operation, "File", 4) != 0)
-					printf("%s,%lld,%ld,%.*f,%.*f\n", results->disk[i].operation, results->disk[i].size, results->disk[i].chunk_size,
-							prec, results->disk[i].throughput, prec, results->disk[i].cpu_usage);
-				else {
-					printf("%s,%lld,-,%.*f,%.*f\n", results->disk[i].operation, results->disk[i].size,
-							prec, results->disk[i].throughput, prec, results->disk[i].cpu_usage);
-				}
-			}
-		}
-		if (flags & FLAG_NETC_STAT) {
-			printf("operation,size,chunk_size,throughput,cpu_usage\n");
+/* Returns the Linpack array size with the matrix just under the L2 cache, LINPACK_DEFAULT_SIZE when it's unknown */
+int linpack_size_auto(void)
+{
+	long size;
+	int n;
 
-			for (i = 0; i < results->net_res_size; i++)
-					printf("%s,%lld,%ld,%.*f,%.*f\n", results->net[i].operation, results->net[i].size, results->net[i].chunk_size,
-							prec, results->disk[i].throughput, prec, results->net[i].cpu_usage);
+	if ((size = cpu_cache_size_get(2)) <= 0)
+		return LINPACK_DEFAULT_SIZE;
+
+	for (n = 10; (long)(n + 2) * (n + 2) * sizeof(double) <= size * 3 / 4; n += 2)
+		;
+
+	return n;
+}
+
+/*
+ * Runs the Dhrystone, Whetstone and classic Linpack kernels built for every microarchitecture level supported
+ * by the CPU, so the score of a generic build can be compared with the score of the build actually deployed
+ */
+void cpu_isa_process(int arsize)
+{
+	unsigned long dhry, loops, tm, iter, memory;
+	float modules[WHETSTONE_MODULES], minMFLOPS, maxMFLOPS;
+	int level, err;
+
+	if (arsize <= 0)
+		arsize = linpack_size_auto();
+	results->cpu_isa_linpack_size = arsize;
+
+	for (level = 0; level < CPU_ISA_COUNT; level++) {
+		if (!cpu_isa_supported(level)) {
+			DPRINTF("CPU kernels %s are not supported on this CPU\n", cpu_isa_name(level));
+			continue;
 		}
+
+		fprintf(stderr, "CPU: Getting Dhrystone, Whetstone and Linpack built for %s\n", cpu_isa_name(level));
+		cpu_isa_dhrystone_get(level, &dhry, &loops, &tm);
+		results->cpu_isa_dhrystone[level] = (float)dhry / DHRYSTONE_VAX_SCORE;
+		cpu_isa_whetstone_get(level, &loops, &iter, &tm, &results->cpu_isa_whetstone[level], modules);
+		if ((err = cpu_isa_linpack_score(level, arsize, &memory, &minMFLOPS, &maxMFLOPS,
+						&results->cpu_isa_linpack[level])) != 0)
+			fprintf(stderr, "Error: Cannot run Linpack built for %s: %s\n", cpu_isa_name(level), strerror(-err));
+
+		DPRINTF("CPU kernels %s: Dhrystone %.*f DMIPS, Whetstone %ld MIPS, Linpack %.*f MFLOPS\n", cpu_isa_name(level),
+				prec, results->cpu_isa_dhrystone[level], results->cpu_isa_whetstone[level], prec,
+				results->cpu_isa_linpack[level]);
 	}
-	else
-	if (type == FORMAT_XML) {
-		printf("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
-		printf("<resultset time=\"%.*f\">\n", prec, results->run_time);
-		printf("\t<cpu>\n");
-		if (flags & FLAG_CA_GET) {
-			printf("\t\t<num_used>%d</num_used>\n", results->cpus);
-			printf("\t\t<mask>0x%" PRIx64 "</mask>\n", results->cpumask);
-		}
-		else {
+}
+
+void topology_process(void)
+{
+	int err;
+
+	if ((err = topology_get(&results->topology)) != 0) {
+		fprintf(stderr, "Error: Cannot get the CPU topology: %s\n", strerror(-err));
+		return;
+	}
+
+	results->topology_sets_size = topology_working_sets(results->topology_sets, results->topology_sets_level,
+					TOPOLOGY_MAX_SETS);
+
+	DPRINTF("Topology: %d CPUs, %d packages, %d cores, %d threads per core, %d NUMA nodes, %d caches\n",
+			results->topology.cpus, results->topology.packages, results->topology.cores, results->topology.smt,
+			results->topology.nodes, results->topology.ncaches);
+}
+
+/* Returns the average frequency in MHz of the cores with the first num cores loaded */
+float cpu_frequency_average(int num)
+{
+	float sum = 0.0;
+	int i;
+
+	for (i = 0; i < num; i++)
+		sum += results->cpu_freq_load[(num - 1) * results->cpu_freq_cores + i];
+
+	return (num > 0) ? sum / num : 0.0;
+}
+
+/*
+ * Measures the effective frequency of every core alone and then with the first 1..num cores loaded at once,
+ * one thread per physical core. The drop of the frequency with more cores loaded shows the turbo bins.
+ */
+void cpu_frequency_process(int num)
+{
+	int i, k, cores, err;
+
+	results->cpu_freq_cpu = (int *)malloc( cpu_thread_count() * sizeof(int) );
+	if (results->cpu_freq_cpu == NULL)
+		return;
+
+	cores = topology_core_cpus(results->cpu_freq_cpu, cpu_thread_count());
+	if (cores <= 0) {
+		fprintf(stderr, "Error: Cannot get the cores to measure the frequency on\n");
+		return;
+	}
+	if ((num <= 0) || (num > cores))
+		num = cores;
+
+	results->cpu_freq_method = cpu_freq_method(results->cpu_freq_cpu[0]);
+	results->cpu_freq_tsc = cpu_get_speed_mhz();
+	results->cpu_freq_single = (float *)malloc( cores * sizeof(float) );
+	results->cpu_freq_load = (float *)malloc( cores * num * sizeof(float) );
+	if ((results->cpu_freq_single == NULL) || (results->cpu_freq_load == NULL))
+		return;
+
+	DPRINTF("Measuring the frequency of %d cores using %s, TSC at %.*f MHz\n", cores,
+			cpu_freq_method_name(results->cpu_freq_method), prec, results->cpu_freq_tsc);
+
+	memset(results->cpu_freq_single, 0, cores * sizeof(float));
+	memset(results->cpu_freq_load, 0, cores * num * sizeof(float));
+	for (i = 0; i < cores; i++) {
+		if ((err = cpu_freq_get(1, &results->cpu_freq_cpu[i], results->cpu_freq_method, results->cpu_freq_tsc,
+						&results->cpu_freq_single[i])) != 0) {
+			fprintf(stderr, "Error: Cannot measure the frequency of CPU %d: %s\n", results->cpu_freq_cpu[i],
+					strerror(-err));
+			return;
+		}
+
+		DPRINTF("CPU %d alone: %.*f MHz\n", results->cpu_freq_cpu[i], prec, results->cpu_freq_single[i]);
+	}
+	results->cpu_freq_cores = cores;
+
+	for (k = 1; k <= num; k++) {
+		if ((err = cpu_freq_get(k, results->cpu_freq_cpu, results->cpu_freq_method, results->cpu_freq_tsc,
+						&results->cpu_freq_load[(k - 1) * cores])) != 0) {
+			fprintf(stderr, "Error: Cannot measure the frequency with %d cores loaded: %s\n", k, strerror(-err));
+			break;
+		}
+
+		DPRINTF("%d core(s) loaded: average %.*f MHz\n", k, prec, cpu_frequency_average(k));
+		results->cpu_freq_loads = k;
+	}
+}
+
+/*
+ * Gets the one-way latency of the cache line transfer between all the pairs of the first num CPUs of the
+ * process affinity (all of them when num is 0) and the topology relation of every pair
+ */
+void cpu_c2c_process(int num)
+{
+	tCpuSet set;
+	double ns;
+	int i, j, n, cpu, err;
+
+	if ((n = cpu_affinity_get(getpid(), &set)) < 0) {
+		fprintf(stderr, "Error: Cannot get the CPU affinity: %s\n", strerror(-n));
+		return;
+	}
+	if ((num > 0) && (num < n))
+		n = num;
+
+	results->cpu_c2c_cpu = (int *)malloc( n * sizeof(int) );
+	results->cpu_c2c_rel = (int *)malloc( n * n * sizeof(int) );
+	results->cpu_c2c_lat = (float *)malloc( n * n * sizeof(float) );
+	if ((results->cpu_c2c_cpu == NULL) || (results->cpu_c2c_rel == NULL) || (results->cpu_c2c_lat == NULL)) {
+		cpu_set_free(&set);
+		return;
+	}
+
+	for (i = 0, cpu = cpu_set_next(&set, -1); i < n; i++, cpu = cpu_set_next(&set, cpu))
+		results->cpu_c2c_cpu[i] = cpu;
+	cpu_set_free(&set);
+
+	memset(results->cpu_c2c_rel, 0, n * n * sizeof(int));
+	memset(results->cpu_c2c_lat, 0, n * n * sizeof(float));
+	results->cpu_c2c_size = n;
+
+	if (n < 2) {
+		fprintf(stderr, "Warning: Core-to-core latency needs at least two CPUs\n");
+		return;
+	}
+
+	fprintf(stderr, "CPU: Getting core-to-core latency for %d CPU pair(s), this may take some time\n", n * (n - 1) / 2);
+	for (i = 0; i < n; i++)
+		for (j = i + 1; j < n; j++) {
+			results->cpu_c2c_rel[i * n + j] = results->cpu_c2c_rel[j * n + i] =
+					topology_cpu_relation(results->cpu_c2c_cpu[i], results->cpu_c2c_cpu[j]);
+
+			if ((err = cpu_c2c_latency_get(results->cpu_c2c_cpu[i], results->cpu_c2c_cpu[j], &ns)) != 0) {
+				fprintf(stderr, "Error: Cannot get latency between CPU %d and CPU %d: %s\n", results->cpu_c2c_cpu[i],
+						results->cpu_c2c_cpu[j], strerror(-err));
+				continue;
+			}
+			results->cpu_c2c_lat[i * n + j] = results->cpu_c2c_lat[j * n + i] = ns;
+
+			DPRINTF("CPU %d <-> CPU %d (%s): %.*f ns\n", results->cpu_c2c_cpu[i], results->cpu_c2c_cpu[j],
+					topology_relation_name(results->cpu_c2c_rel[i * n + j]), prec, ns);
+		}
+}
+
+/* Returns the average core-to-core latency of the CPU pairs in the relation and their number in pairs */
+float cpu_c2c_average(int rel, int *pairs)
+{
+	int i, j, n = results->cpu_c2c_size;
+	float sum = 0.0;
+
+	*pairs = 0;
+	for (i = 0; i < n; i++)
+		for (j = i + 1; j < n; j++)
+			if ((results->cpu_c2c_rel[i * n + j] == rel) && (results->cpu_c2c_lat[i * n + j] > 0.0)) {
+				sum += results->cpu_c2c_lat[i * n + j];
+				(*pairs)++;
+			}
+
+	return (*pairs > 0) ? sum / *pairs : 0.0;
+}
+
+/*
+ * Gets the throughput and the fairness of every synchronization primitive for 1..threads pinned threads, both
+ * with all the threads on one lock and with a private lock per thread
+ */
+void cpu_sync_process(int threads)
+{
+	int i, p, c, err;
+
+	if (threads <= 0)
+		threads = cpu_thread_count();
+	if (threads <= 0)
+		return;
+
+	fprintf(stderr, "CPU: Getting synchronization primitive scaling for 1..%d thread(s), this may take some time\n",
+			threads);
+	for (p = 0; p < SYNC_PRIMITIVES; p++) {
+		results->cpu_sync[p] = (tSyncResults *)malloc( threads * sizeof(tSyncResults) );
+		if (results->cpu_sync[p] == NULL)
+			return;
+		memset(results->cpu_sync[p], 0, threads * sizeof(tSyncResults));
+	}
+	results->cpu_sync_size = threads;
+
+	for (p = 0; p < SYNC_PRIMITIVES; p++)
+		for (i = 0; i < threads; i++) {
+			tSyncResults *res = &results->cpu_sync[p][i];
+
+			res->threads = i + 1;
+			for (c = 0; c < SYNC_CASES; c++) {
+				if ((err = sync_get(p, c, i + 1, &res->mops[c], &res->fairness[c])) != 0) {
+					fprintf(stderr, "Error: Cannot run %s with %d thread(s): %s\n", sync_primitive_name(p), i + 1,
+							strerror(-err));
+					continue;
+				}
+
+				DPRINTF("Sync %s %s, %d thread(s): %.*f Mops/s, fairness %.*f\n", sync_primitive_name(p),
+						sync_case_name(c), i + 1, prec, res->mops[c], prec, res->fairness[c]);
+			}
+		}
+}
+
+/*
+ * Gets the cost of the system calls and the vDSO call, and the context switch latency of the threads and the
+ * processes on one CPU and on two CPUs of different cores (of the SMT siblings when there is only one core)
+ */
+void syscall_process(void)
+{
+	int cores[2], i, p, num, err;
+	double ns;
+
+	for (i = 0; i < SYSCALL_CALLS; i++) {
+		if ((err = syscall_latency_get(i, &ns)) != 0) {
+			fprintf(stderr, "Error: Cannot measure %s: %s\n", syscall_call_name(i), strerror(-err));
+			continue;
+		}
+		results->sys_call[i] = ns;
+
+		DPRINTF("System call %s: %.*f ns\n", syscall_call_name(i), prec, ns);
+	}
+
+	num = topology_core_cpus(cores, 2);
+	if (num < 2) {
+		cores[0] = cpu_thread_get_cpu(0);
+		cores[1] = (cpu_thread_count() > 1) ? cpu_thread_get_cpu(1) : -1;
+	}
+	results->sys_ctxsw_cpu[0] = cores[0];
+	results->sys_ctxsw_cpu[1] = cores[0];
+	results->sys_ctxsw_cpu[2] = cores[1];
+
+	for (p = 0; p < 2; p++)
+		for (i = 0; i < CTXSW_PLACEMENTS; i++) {
+			if (results->sys_ctxsw_cpu[i + 1] < 0)
+				continue;
+
+			if ((err = syscall_ctxsw_get(p, results->sys_ctxsw_cpu[0], results->sys_ctxsw_cpu[i + 1], &ns)) != 0) {
+				fprintf(stderr, "Error: Cannot measure %s context switch: %s\n", syscall_ctxsw_name(p), strerror(-err));
+				continue;
+			}
+			results->sys_ctxsw[p][i] = ns;
+
+			DPRINTF("Context switch of %s, CPU %d and CPU %d: %.*f ns\n", syscall_ctxsw_name(p),
+					results->sys_ctxsw_cpu[0], results->sys_ctxsw_cpu[i + 1], prec, ns);
+		}
+}
+
+/* Returns the name of the memory level of the working set, e.g. L2 or memory */
+char *topology_level_name(int level, char *buf, int len)
+{
+	if (level > topology_cache_levels())
+		snprintf(buf, len, "memory");
+	else
+		snprintf(buf, len, "L%d", level);
+
+	return buf;
+}
+
+/* Returns the name of the STREAM kernel results in the store mode for the output type */
+char *memory_bandwidth_name(int mode, int kernel, int type, char *buf, int len)
+{
+	int i;
+
+	if (type == FORMAT_PLAIN)
+		snprintf(buf, len, "Memory bandwidth %s%s", memory_bandwidth_kernel_name(kernel),
+					(mode == MEMBW_MODE_NT) ? " (non-temporal)" : "");
+	else {
+		snprintf(buf, len, "memory_bandwidth_%s%s", memory_bandwidth_kernel_name(kernel),
+					(mode == MEMBW_MODE_NT) ? "_nt" : "");
+		for (i = 0; buf[i] != 0; i++)
+			buf[i] = tolower(buf[i]);
+	}
+
+	return buf;
+}
+
+void memory_bandwidth_process(int threads, unsigned long long size)
+{
+	float *gbps, total[MEMBW_KERNELS];
+	char tmp[16];
+	int i, k, n, mode, err;
+
+	if (threads <= 0)
+		threads = cpu_thread_count();
+	if (threads <= 0)
+		return;
+	if (size == 0)
+		size = memory_bandwidth_size_default();
+
+	gbps = (float *)malloc( threads * MEMBW_KERNELS * sizeof(float) );
+	for (mode = 0; mode < MEMBW_MODES; mode++)
+		for (k = 0; k < MEMBW_KERNELS; k++) {
+			results->memory_bw_scale[mode][k] = (tScaleResults *)malloc( threads * sizeof(tScaleResults) );
+			memset(results->memory_bw_scale[mode][k], 0, threads * sizeof(tScaleResults));
+		}
+	results->memory_bw_arsize = size;
+
+	io_get_size(size, prec, tmp, sizeof(tmp));
+	fprintf(stderr, "Memory: Getting STREAM bandwidth for 1 to %d threads with %s arrays, this may take some time\n",
+			threads, tmp);
+	for (mode = 0; mode < MEMBW_MODES; mode++)
+		for (n = 1; n <= threads; n++) {
+			int *cpus = (int *)malloc( n * sizeof(int) );
+
+			if ((err = memory_bandwidth_get(n, mode == MEMBW_MODE_NT, size, MEMPAGE_DEFAULT, -1, cpus, gbps, total)) != 0) {
+				fprintf(stderr, "Error: Cannot run STREAM in %d threads: %s\n", n, strerror(-err));
+				free(cpus);
+				break;
+			}
+
+			for (k = 0; k < MEMBW_KERNELS; k++) {
+				tScaleResults *res = &results->memory_bw_scale[mode][k][n - 1];
+
+				res->threads = n;
+				res->total = total[k];
+				res->efficiency = total[k] / (n * results->memory_bw_scale[mode][k][0].total);
+				res->cpu = (int *)malloc( n * sizeof(int) );
+				res->score = (float *)malloc( n * sizeof(float) );
+				memcpy(res->cpu, cpus, n * sizeof(int));
+				for (i = 0; i < n; i++)
+					res->score[i] = gbps[i * MEMBW_KERNELS + k];
+
+				DPRINTF("STREAM %s%s in %d threads: %.*f GB/s total, scaling efficiency %.*f%%\n",
+						memory_bandwidth_kernel_name(k), (mode == MEMBW_MODE_NT) ? " (non-temporal)" : "",
+						n, prec, res->total, prec, res->efficiency * 100.0);
+			}
+			results->memory_bw_scale_size[mode] = n;
+			free(cpus);
+		}
+
+	free(gbps);
+}
+
+/*
+ * Gets the latency for working sets from MEMLAT_MIN_SIZE up to maxsize doubling the size, with all the page
+ * types. The default working sets are taken from the cache topology, just under and just over every cache
+ * level and in the main memory, and they are never over a quarter of the physical memory.
+ */
+void memory_latency_process(unsigned long long maxsize)
+{
+	unsigned long long size, sizes[TOPOLOGY_MAX_SETS], memmax;
+	double ns;
+	int i, num, pages, err, failed[MEMPAGE_COUNT] = { 0 };
+
+	if ((maxsize > 0) && (maxsize < MEMLAT_MIN_SIZE)) {
+		fprintf(stderr, "Error: Invalid memory latency working set size, minimum is %llu bytes\n", MEMLAT_MIN_SIZE);
+		return;
+	}
+
+	if (maxsize == 0) {
+		memmax = (unsigned long long)memory_size_get(MEMTYPE_B) / 4;
+		num = topology_working_sets(sizes, NULL, TOPOLOGY_MAX_SETS);
+		while ((num > 0) && (sizes[num - 1] > memmax))
+			num--;
+	}
+	else
+		for (num = 0, size = MEMLAT_MIN_SIZE; size <= maxsize; size *= 2)
+			num++;
+	if (num == 0) {
+		fprintf(stderr, "Error: No memory latency working sets, the cache sizes are unknown\n");
+		return;
+	}
+
+	results->memory_lat = (tMemLatency *)malloc( num * sizeof(tMemLatency) );
+	memset(results->memory_lat, 0, num * sizeof(tMemLatency));
+	results->memory_lat_mhz = cpu_get_speed_mhz();
+	for (i = 0; i < num; i++)
+		results->memory_lat[i].size = (maxsize == 0) ? sizes[i] : MEMLAT_MIN_SIZE << i;
+
+	fprintf(stderr, "Memory: Getting latency for %d working sets, this may take some time\n", num);
+	for (i = 0; i < num; i++) {
+		size = results->memory_lat[i].size;
+		for (pages = 0; pages < MEMPAGE_COUNT; pages++) {
+			/* The huge pages may be not available at all so don't try them again */
+			if (failed[pages])
+				continue;
+			if ((err = memory_latency_get(size, pages, -1, &ns)) != 0) {
+				fprintf(stderr, "Error: Cannot get memory latency with %s pages: %s\n", memory_page_name(pages),
+						strerror(-err));
+				failed[pages] = 1;
+				continue;
+			}
+			results->memory_lat[i].ns[pages] = ns;
+
+			DPRINTF("Memory latency for %llu bytes with %s pages: %.*f ns, %.*f cycles\n", size,
+					memory_page_name(pages), prec, ns, prec, ns * results->memory_lat_mhz / 1000.0);
+		}
+		results->memory_lat_size = i + 1;
+	}
+}
+
+/*
+ * Gets the STREAM Triad bandwidth and the latency for all the pairs of the NUMA nodes. The threads run on all
+ * the CPUs of the CPU node, set by the process affinity, and the memory is bound to the memory node. Nodes
+ * without CPUs or memory are left out and their values are zero.
+ */
+void memory_numa_process(unsigned long long size)
+{
+	float total[MEMBW_KERNELS];
+	uint64_t nodes;
+	tCpuSet cmask, saved;
+	double ns;
+	char tmp[16];
+	int i, j, n, cpus, err;
+
+	if (size == 0)
+		size = memory_bandwidth_size_default();
+	if ((n = memory_nodes_get(&nodes)) <= 0) {
+		fprintf(stderr, "Error: Cannot get the NUMA nodes: %s\n", strerror(-n));
+		return;
+	}
+	if ((err = cpu_affinity_get(getpid(), &saved)) < 0) {
+		fprintf(stderr, "Error: Cannot get the CPU affinity: %s\n", strerror(-err));
+		return;
+	}
+
+	results->memory_numa_node = (int *)malloc( n * sizeof(int) );
+	results->memory_numa_bw = (float *)malloc( n * n * sizeof(float) );
+	results->memory_numa_lat = (float *)malloc( n * n * sizeof(float) );
+	memset(results->memory_numa_bw, 0, n * n * sizeof(float));
+	memset(results->memory_numa_lat, 0, n * n * sizeof(float));
+	results->memory_numa_size = n;
+	results->memory_numa_arsize = size;
+	for (i = 0, j = 0; j < n; i++)
+		if (nodes & ((uint64_t)1 << i))
+			results->memory_numa_node[j++] = i;
+
+	io_get_size(size, prec, tmp, sizeof(tmp));
+	fprintf(stderr, "Memory: Getting NUMA matrix for %d node(s) with %s arrays, this may take some time\n", n, tmp);
+	for (i = 0; i < n; i++) {
+		if ((cpus = memory_node_cpus(results->memory_numa_node[i], &cmask)) < 0)
+			continue;
+		if (cpus == 0) {
+			cpu_set_free(&cmask);
+			continue;
+		}
+		err = cpu_affinity_set(getpid(), &cmask);
+		cpu_set_free(&cmask);
+		if (err != 0) {
+			fprintf(stderr, "Error: Cannot run on node %d: %s\n", results->memory_numa_node[i], strerror(-err));
+			continue;
+		}
+
+		for (j = 0; j < n; j++) {
+			if (memory_node_size(results->memory_numa_node[j]) < 3 * size)
+				continue;
+
+			if ((err = memory_bandwidth_get(cpus, 0, size, MEMPAGE_DEFAULT, results->memory_numa_node[j],
+						NULL, NULL, total)) != 0) {
+				fprintf(stderr, "Error: Cannot run STREAM from node %d on node %d: %s\n", results->memory_numa_node[i],
+						results->memory_numa_node[j], strerror(-err));
+				continue;
+			}
+			results->memory_numa_bw[i * n + j] = total[MEMBW_TRIAD];
+
+			if ((err = memory_latency_get(size, MEMPAGE_BASE, results->memory_numa_node[j], &ns)) != 0) {
+				fprintf(stderr, "Error: Cannot get latency from node %d on node %d: %s\n", results->memory_numa_node[i],
+						results->memory_numa_node[j], strerror(-err));
+				continue;
+			}
+			results->memory_numa_lat[i * n + j] = ns;
+
+			DPRINTF("NUMA CPU node %d, memory node %d: %.*f GB/s, %.*f ns\n", results->memory_numa_node[i],
+					results->memory_numa_node[j], prec, total[MEMBW_TRIAD], prec, ns);
+		}
+	}
+
+	cpu_affinity_set(getpid(), &saved);
+	cpu_set_free(&saved);
+}
+
+/*
+ * Gets the throughput of the allocator for every workload with 1..threads pinned threads, the allocator is the
+ * one of the C library unless another one is preloaded, e.g. by LD_PRELOAD=libjemalloc.so
+ */
+void memory_alloc_process(int threads)
+{
+	tAllocResults *res;
+	int i, w, err;
+
+	if (threads <= 0)
+		threads = cpu_thread_count();
+	if (threads <= 0)
+		return;
+
+	results->memory_alloc = (tAllocResults *)malloc( threads * sizeof(tAllocResults) );
+	if (results->memory_alloc == NULL)
+		return;
+	memset(results->memory_alloc, 0, threads * sizeof(tAllocResults));
+	results->memory_alloc_size = threads;
+	alloc_name(results->memory_alloc_name, sizeof(results->memory_alloc_name));
+
+	fprintf(stderr, "Memory: Getting %s allocator scaling for 1..%d thread(s), this may take some time\n",
+			results->memory_alloc_name, threads);
+	for (i = 0; i < threads; i++) {
+		res = &results->memory_alloc[i];
+		res->threads = i + 1;
+
+		for (w = 0; w < ALLOC_WORKLOADS; w++) {
+			if ((err = alloc_get(w, i + 1, &res->mops[w], &res->rss[w])) != 0) {
+				fprintf(stderr, "Error: Cannot run %s with %d thread(s): %s\n", alloc_workload_name(w), i + 1,
+						strerror(-err));
+				continue;
+			}
+
+			DPRINTF("Allocator %s, %d thread(s): %.*f Mops/s, RSS %lu KiB\n", alloc_workload_name(w), i + 1,
+					prec, res->mops[w], res->rss[w]);
+
+			/* The high water mark of the kernel is not updated on every page fault */
+			if (res->rss[w] > results->memory_alloc_peak)
+				results->memory_alloc_peak = res->rss[w];
+		}
+	}
+	if (alloc_peak_rss() > results->memory_alloc_peak)
+		results->memory_alloc_peak = alloc_peak_rss();
+}
+
+/*
+ * Gets the first-touch page fault throughput with 4K and transparent huge pages for 1..threads threads, the
+ * cost of munmap() when the other threads have to flush their TLB and the cost of the lazy faulting compared
+ * to the memory populated by the kernel at the time of mapping
+ */
+void memory_faults_process(int threads)
+{
+	tFaultResults *res;
+	int i, pages, populate, err;
+	double ns;
+
+	if (threads <= 0)
+		threads = cpu_thread_count();
+	if (threads <= 0)
+		return;
+
+	results->memory_fault = (tFaultResults *)malloc( threads * sizeof(tFaultResults) );
+	if (results->memory_fault == NULL)
+		return;
+	memset(results->memory_fault, 0, threads * sizeof(tFaultResults));
+	results->memory_fault_size = threads;
+	results->memory_fault_region = memory_fault_size(1);
+
+	fprintf(stderr, "Memory: Getting page fault scaling for 1..%d thread(s), this may take some time\n", threads);
+	for (i = 0; i < threads; i++) {
+		res = &results->memory_fault[i];
+		res->threads = i + 1;
+
+		/* The HugeTLB pages are reserved in advance and so they are faulted in without allocation */
+		for (pages = MEMPAGE_BASE; pages <= MEMPAGE_THP; pages++) {
+			if (results->memory_fault_err[pages] != 0)
+				continue;
+			if ((err = memory_fault_get(i + 1, pages, &res->gbps[pages], &res->faults[pages])) != 0) {
+				fprintf(stderr, "Error: Cannot fault %s pages with %d thread(s): %s\n", memory_page_name(pages),
+						i + 1, strerror(-err));
+				results->memory_fault_err[pages] = err;
+				continue;
+			}
+
+			DPRINTF("Faults of %s pages, %d thread(s): %.*f GB/s, %.*f k faults/s\n", memory_page_name(pages),
+					i + 1, prec, res->gbps[pages], prec, res->faults[pages]);
+		}
+
+		if ((err = memory_unmap_get(i + 1, &ns)) != 0) {
+			fprintf(stderr, "Error: Cannot get munmap cost with %d thread(s): %s\n", i + 1, strerror(-err));
+			continue;
+		}
+		res->unmap = ns;
+		DPRINTF("munmap with %d thread(s): %.*f ns\n", i + 1, prec, ns);
+	}
+
+	for (pages = 0; pages < MEMPAGE_COUNT; pages++)
+		for (populate = 0; populate < 2; populate++) {
+			if ((err = memory_populate_get(pages, populate, results->memory_fault_region,
+						&results->memory_populate[pages][populate])) != 0) {
+				DPRINTF("Cannot map %s pages%s: %s\n", memory_page_name(pages), populate ? " populated" : "",
+						strerror(-err));
+				results->memory_populate[pages][populate] = 0.0;
+			}
+		}
+}
+
+/*
+ * Gets the throughput of memcpy(), memmove() and memset() and of their non-temporal variants for the block sizes
+ * up to size and for a few source and destination alignments. The sizes cover the chunk sizes of the disk and
+ * network benchmarks, so the copy cost of their buffers can be compared with the device throughput.
+ */
+void memory_copy_process(unsigned long long size)
+{
+	unsigned long long max;
+	char tmp[16];
+	int num;
+
+	max = (unsigned long long)memory_size_get(MEMTYPE_B) / 8;
+	if ((size == 0) || (size > COPY_MAX_SIZE))
+		size = COPY_MAX_SIZE;
+	if (size > max)
+		size = max;
+	if (size < COPY_MIN_SIZE)
+		size = COPY_MIN_SIZE;
+
+	num = copy_sizes(size);
+	results->memory_copy = (tCopyResults *)malloc( num * sizeof(tCopyResults) );
+	if (results->memory_copy == NULL)
+		return;
+	memset(results->memory_copy, 0, num * sizeof(tCopyResults));
+
+	io_get_size(size, 0, tmp, 16);
+	fprintf(stderr, "Memory: Getting memory copy throughput for blocks up to %s, this may take some time\n", tmp);
+	if ((num = copy_get(size, results->memory_copy, num)) < 0) {
+		fprintf(stderr, "Error: Cannot get memory copy throughput: %s\n", strerror(-num));
+		num = 0;
+	}
+	results->memory_copy_size = num;
+}
+
+/*
+ * Runs Dhrystone on all the CPUs and, when the disk benchmark is enabled, the sequential disk write for the
+ * time given and samples their throughput in short intervals to tell the burst from the sustained throughput,
+ * e.g. of the CPU turbo budget or of the SLC cache of the SSD. The disk write rewrites a file of the size of
+ * the disk benchmark.
+ */
+void steady_process(int seconds, unsigned long long diskSize)
+{
+	tSteady s;
+	float cpu;
+	int threads, err;
+
+	if (seconds <= 0)
+		seconds = STEADY_TIME;
+	results->steady_time = seconds;
+
+	threads = cpu_thread_count();
+	fprintf(stderr, "CPU: Getting sustained Dhrystone on %d CPU(s) for %d seconds\n", threads, seconds);
+	if ((err = cpu_dhrystone_steady(threads, seconds * NSEC_PER_SEC, STEADY_INTERVAL, &s)) != 0)
+		fprintf(stderr, "Error: Cannot run sustained Dhrystone: %s\n", strerror(-err));
+	else {
+		if ((err = steady_analyze(&s, DHRYSTONE_VAX_SCORE, &results->steady_cpu)) != 0)
+			fprintf(stderr, "Error: Cannot analyze sustained Dhrystone: %s\n", strerror(-err));
+		else
+			results->steady_cpu_threads = threads;
+		steady_free(&s);
+	}
+
+	if (diskSize == 0)
+		return;
+
+	fprintf(stderr, "Disk: Getting sustained write for %d seconds\n", seconds);
+	if ((err = steady_init(&s, 0, seconds * NSEC_PER_SEC, STEADY_INTERVAL)) != 0)
+		return;
+	disk_throughput_steady(STEADY_DISK_CHUNK, diskSize, &s, &cpu);
+	if ((err = steady_analyze(&s, 1.0, &results->steady_disk)) != 0)
+		fprintf(stderr, "Error: Cannot analyze sustained disk write: %s\n", strerror(-err));
+	else
+		results->steady_disk_done = 1;
+	steady_free(&s);
+}
+
+/*
+ * Runs the memory latency, the STREAM Triad in all the CPUs and the classic Linpack with 4K pages, with the
+ * transparent huge pages and with the hugetlbfs pages. The HugeTLB pages have to be reserved in advance, e.g.
+ * by /proc/sys/vm/nr_hugepages, otherwise the page type is reported as not available.
+ */
+void memory_pages_process(unsigned long long size, int arsize)
+{
+	float total[MEMBW_KERNELS], avg;
+	unsigned long memory;
+	char tmp[16];
+	double ns;
+	int pages, err;
+
+	if (size == 0)
+		size = memory_bandwidth_size_default();
+	if (arsize <= 0)
+		arsize = LINPACK_DEFAULT_SIZE;
+
+	results->memory_pages_arsize = size;
+	results->memory_pages_lpsize = arsize;
+	results->memory_pages_mhz = cpu_get_speed_mhz();
+
+	io_get_size(size, prec, tmp, sizeof(tmp));
+	fprintf(stderr, "Memory: Comparing page sizes with %s arrays, this may take some time\n", tmp);
+	for (pages = 0; pages < MEMPAGE_COUNT; pages++) {
+		if ((err = memory_latency_get(size, pages, -1, &ns)) == 0)
+			err = memory_bandwidth_get(cpu_thread_count(), 0, size, pages, -1, NULL, NULL, total);
+		if ((err == 0) && !get_linpack_pages_score(pages, arsize, &memory, NULL, NULL, &avg))
+			err = -ENOMEM;
+		if (err != 0) {
+			fprintf(stderr, "Error: Cannot run with %s pages: %s\n", memory_page_name(pages), strerror(-err));
+			results->memory_pages_err[pages] = err;
+			continue;
+		}
+
+		results->memory_pages_lat[pages] = ns;
+		results->memory_pages_bw[pages] = total[MEMBW_TRIAD];
+		results->memory_pages_linpack[pages] = avg;
+
+		DPRINTF("%s pages: latency %.*f ns, Triad %.*f GB/s, Linpack %.*f MFLOPS\n", memory_page_name(pages),
+				prec, ns, prec, total[MEMBW_TRIAD], prec, avg);
+	}
+}
+
+/*
+ * Returns the speedup of the value of the page type against the 4K pages or 0 when any of them is missing,
+ * inverse is set for the values where less is better
+ */
+float memory_pages_speedup(float *values, int pages, int inverse)
+{
+	if ((values[pages] <= 0.0) || (values[MEMPAGE_BASE] <= 0.0))
+		return 0.0;
+
+	return inverse ? values[MEMPAGE_BASE] / values[pages] : values[pages] / values[MEMPAGE_BASE];
+}
+
+/*
+ * Returns the TLB miss cost implied by the page type in ns, i.e. the latency saved per random load against
+ * the 4K pages where almost every load of the large working set misses the TLB
+ */
+float memory_pages_tlb_miss(int pages)
+{
+	if ((pages == MEMPAGE_BASE) || (results->memory_pages_lat[pages] <= 0.0)
+			|| (results->memory_pages_lat[MEMPAGE_BASE] <= 0.0))
+		return 0.0;
+
+	return results->memory_pages_lat[MEMPAGE_BASE] - results->memory_pages_lat[pages];
+}
+
+/* Prints the NUMA matrix of values in plain format, values of zero are not measured */
+void printNumaMatrix(char *name, char *unit, float *values)
+{
+	int i, j, n = results->memory_numa_size;
+
+	printf("NUMA %s matrix in %s (CPU node x memory node):\n\t", name, unit);
+	for (j = 0; j < n; j++)
+		printf("\tnode%d", results->memory_numa_node[j]);
+	printf("\n");
+	for (i = 0; i < n; i++) {
+		printf("\tnode%d", results->memory_numa_node[i]);
+		for (j = 0; j < n; j++)
+			if (values[i * n + j] > 0.0)
+				printf("\t%.*f", prec, values[i * n + j]);
+			else
+				printf("\t-");
+		printf("\n");
+	}
+}
+
+/* Prints the core-to-core latency matrix, every value is marked by the first letter of the CPU relation */
+void printC2CMatrix(void)
+{
+	int i, j, rel, pairs, n = results->cpu_c2c_size;
+	float avg;
+
+	printf("Core-to-core latency matrix in ns (s = SMT sibling, l = shared last level cache, p = same package, "
+			"r = remote package):\n\t");
+	for (j = 0; j < n; j++)
+		printf("\tcpu%d", results->cpu_c2c_cpu[j]);
+	printf("\n");
+	for (i = 0; i < n; i++) {
+		printf("\tcpu%d", results->cpu_c2c_cpu[i]);
+		for (j = 0; j < n; j++)
+			if (results->cpu_c2c_lat[i * n + j] > 0.0)
+				printf("\t%.*f%c", prec, results->cpu_c2c_lat[i * n + j],
+						topology_relation_name(results->cpu_c2c_rel[i * n + j])[0]);
+			else
+				printf("\t-");
+		printf("\n");
+	}
+
+	for (rel = 0; rel < TOPOLOGY_REL_COUNT; rel++)
+		if ((avg = cpu_c2c_average(rel, &pairs)) > 0.0)
+			printf("\tAverage %s: %.*f ns (%d pair(s))\n", topology_relation_name(rel), prec, avg, pairs);
+}
+
+void scale_results_free(tScaleResults *res, int num)
+{
+	int i;
+
+	for (i = 0; i < num; i++) {
+		free(res[i].cpu);
+		free(res[i].score);
+		free(res[i].detail);
+	}
+	free(res);
+}
+
+/*
+ * Prints the scaling results. When details are present, ndetails values are stored for every thread and
+ * their names and units are provided by the detailName() and detailUnit() functions.
+ */
+void printScaleResults(tScaleResults *res, int num, char *name, char *unit, int ndetails,
+			const char *(*detailName)(int), const char *(*detailUnit)(int), int type)
+{
+	int i, j, k;
+
+	if (type == FORMAT_PLAIN) {
+		printf("%s scaling:\n", name);
+		for (i = 0; i < num; i++) {
+			printf("\t%d thread(s): %.*f %s total, efficiency %.*f%%\n", res[i].threads, prec, res[i].total,
+					unit, prec, res[i].efficiency * 100.0);
+			for (j = 0; j < res[i].threads; j++) {
+				printf("\t\tThread #%d (CPU #%d): %.*f %s\n", j, res[i].cpu[j], prec, res[i].score[j], unit);
+				for (k = 0; (res[i].detail != NULL) && (k < ndetails); k++)
+					printf("\t\t\t%s: %.*f %s\n", detailName(k), prec, res[i].detail[j * ndetails + k], detailUnit(k));
+			}
+		}
+	}
+	else
+	if (type == FORMAT_CSV) {
+		printf("benchmark,threads,thread,cpu,score,total,efficiency");
+		for (k = 0; k < ndetails; k++)
+			printf(",%s", detailName(k));
+		printf("\n");
+		for (i = 0; i < num; i++)
+			for (j = 0; j < res[i].threads; j++) {
+				printf("%s,%d,%d,%d,%.*f,%.*f,%.*f", name, res[i].threads, j, res[i].cpu[j], prec, res[i].score[j],
+						prec, res[i].total, prec, res[i].efficiency * 100.0);
+				for (k = 0; k < ndetails; k++)
+					printf(",%.*f", prec, (res[i].detail != NULL) ? res[i].detail[j * ndetails + k] : 0.0);
+				printf("\n");
+			}
+	}
+	else
+	if (type == FORMAT_XML) {
+		printf("\t<results type=\"%s\" unit=\"%s\">\n", name, unit);
+		for (i = 0; i < num; i++) {
+			printf("\t\t<scale threads=\"%d\" total=\"%.*f\" efficiency=\"%.*f\">\n", res[i].threads, prec, res[i].total,
+					prec, res[i].efficiency * 100.0);
+			for (j = 0; j < res[i].threads; j++) {
+				if ((res[i].detail == NULL) || (ndetails == 0)) {
+					printf("\t\t\t<thread id=\"%d\" cpu=\"%d\" score=\"%.*f\" />\n", j, res[i].cpu[j], prec, res[i].score[j]);
+					continue;
+				}
+
+				printf("\t\t\t<thread id=\"%d\" cpu=\"%d\" score=\"%.*f\">\n", j, res[i].cpu[j], prec, res[i].score[j]);
+				for (k = 0; k < ndetails; k++)
+					printf("\t\t\t\t<detail name=\"%s\" unit=\"%s\">%.*f</detail>\n", detailName(k), detailUnit(k),
+							prec, res[i].detail[j * ndetails + k]);
+				printf("\t\t\t</thread>\n");
+			}
+			printf("\t\t</scale>\n");
+		}
+		printf("\t</results>\n");
+	}
+}
+
+/* Prints the scores of the kernels built for every microarchitecture level side by side */
+void printCpuIsaResults(int type)
+{
+	int i;
+
+	if (type == FORMAT_PLAIN) {
+		printf("CPU kernels per microarchitecture level (Linpack array size %dx%d):\n", results->cpu_isa_linpack_size,
+				results->cpu_isa_linpack_size);
+		for (i = 0; i < CPU_ISA_COUNT; i++) {
+			if (!cpu_isa_supported(i)) {
+				printf("\t%s: not supported\n", cpu_isa_name(i));
+				continue;
+			}
+			printf("\t%s%s: Dhrystone %.*f DMIPS, Whetstone %ld MIPS, Linpack %.*f MFLOPS\n", cpu_isa_name(i),
+					(i == results->cpu_isa) ? " (selected)" : "", prec, results->cpu_isa_dhrystone[i],
+					results->cpu_isa_whetstone[i], prec, results->cpu_isa_linpack[i]);
+		}
+	}
+	else
+	if (type == FORMAT_CSV) {
+		printf("cpu_isa,supported,selected,dhrystone,whetstone,linpack_size,linpack_avg\n");
+		for (i = 0; i < CPU_ISA_COUNT; i++) {
+			if (!cpu_isa_supported(i)) {
+				printf("%s,0,0,-,-,%d,-\n", cpu_isa_name(i), results->cpu_isa_linpack_size);
+				continue;
+			}
+			printf("%s,1,%d,%.*f,%ld,%d,%.*f\n", cpu_isa_name(i), (i == results->cpu_isa), prec,
+					results->cpu_isa_dhrystone[i], results->cpu_isa_whetstone[i], results->cpu_isa_linpack_size,
+					prec, results->cpu_isa_linpack[i]);
+		}
+	}
+	else
+	if (type == FORMAT_XML) {
+		printf("\t<results type=\"cpu_isa\" selected=\"%s\" linpack_size=\"%d\">\n", cpu_isa_name(results->cpu_isa),
+				results->cpu_isa_linpack_size);
+		for (i = 0; i < CPU_ISA_COUNT; i++) {
+			if (!cpu_isa_supported(i)) {
+				printf("\t\t<kernels name=\"%s\" supported=\"false\" />\n", cpu_isa_name(i));
+				continue;
+			}
+			printf("\t\t<kernels name=\"%s\" supported=\"true\">\n", cpu_isa_name(i));
+			printf("\t\t\t<dhrystone unit=\"DMIPS\">%.*f</dhrystone>\n", prec, results->cpu_isa_dhrystone[i]);
+			printf("\t\t\t<whetstone unit=\"MIPS\">%ld</whetstone>\n", results->cpu_isa_whetstone[i]);
+			printf("\t\t\t<linpack unit=\"MFLOPS\">%.*f</linpack>\n", prec, results->cpu_isa_linpack[i]);
+			printf("\t\t</kernels>\n");
+		}
+		printf("\t</results>\n");
+	}
+}
+
+/* Prints one sustained run, the disk rates are in bytes per second */
+void printSteadyRun(tSteadyResults *r, const char *name, const char *unit, int disk, int type)
+{
+	char burst[24], steady[24];
+	int i;
+
+	if (type == FORMAT_PLAIN) {
+		if (disk) {
+			io_get_size_double(r->burst, prec, burst, 16);
+			io_get_size_double(r->steady, prec, steady, 16);
+			strcat(burst, "/s");
+			strcat(steady, "/s");
+		}
+		else {
+			snprintf(burst, sizeof(burst), "%.*f %s", prec, r->burst, unit);
+			snprintf(steady, sizeof(steady), "%.*f %s", prec, r->steady, unit);
+		}
+
+		printf("\t%s: burst %s, steady %s (%.*f%% of burst)\n", name, burst, steady, prec,
+				(r->burst > 0.0) ? r->steady * 100.0 / r->burst : 0.0);
+		printf("\t\tSteady after %.*f s%s, trend %.*f%%/min%s\n", prec, r->settle, r->settled ? "" : " (not settled)",
+				prec, r->slope, r->degrading ? " (degrading)" : "");
+	}
+	else
+	if (type == FORMAT_CSV) {
+		for (i = 0; i < r->samples; i++)
+			printf("%s,%s,%.*f,%.*f\n", name, unit, prec, i * r->interval, prec, r->rate[i]);
+	}
+	else
+	if (type == FORMAT_XML) {
+		printf("\t\t<run benchmark=\"%s\" unit=\"%s\" burst=\"%.*f\" steady=\"%.*f\" settle=\"%.*f\" slope=\"%.*f\" "
+				"settled=\"%d\" degrading=\"%d\">\n", name, unit, prec, r->burst, prec, r->steady, prec, r->settle,
+				prec, r->slope, r->settled, r->degrading);
+		for (i = 0; i < r->samples; i++)
+			printf("\t\t\t<sample time=\"%.*f\">%.*f</sample>\n", prec, i * r->interval, prec, r->rate[i]);
+		printf("\t\t</run>\n");
+	}
+}
+
+/* Prints the burst and steady-state results of the sustained runs */
+void printSteadyResults(int type)
+{
+	char name[32];
+	tSteadyResults *runs[2] = { &results->steady_cpu, &results->steady_disk };
+	int i, done[2] = { results->steady_cpu_threads > 0, results->steady_disk_done };
+
+	snprintf(name, sizeof(name), (type == FORMAT_PLAIN) ? "Dhrystone on %d CPU(s)" : "dhrystone-%d",
+			results->steady_cpu_threads);
+
+	if (type == FORMAT_PLAIN)
+		printf("Steady state (%d s run, %.*f s intervals):\n", results->steady_time, prec,
+				(float)STEADY_INTERVAL / NSEC_PER_SEC);
+	else
+	if (type == FORMAT_CSV) {
+		printf("steady_benchmark,unit,interval,samples,burst,steady,settle_time,slope_pct_min,settled,degrading\n");
+		for (i = 0; i < 2; i++)
+			if (done[i])
+				printf("%s,%s,%.*f,%d,%.*f,%.*f,%.*f,%.*f,%d,%d\n", (i == 0) ? name : "disk-write", (i == 0) ? "DMIPS" : "B/s",
+						prec, runs[i]->interval, runs[i]->samples, prec, runs[i]->burst, prec, runs[i]->steady, prec,
+						runs[i]->settle, prec, runs[i]->slope, runs[i]->settled, runs[i]->degrading);
+		printf("steady_benchmark,unit,time,throughput\n");
+	}
+	else
+	if (type == FORMAT_XML)
+		printf("\t<results type=\"steady\" duration=\"%d\" interval=\"%.*f\">\n", results->steady_time, prec,
+				(float)STEADY_INTERVAL / NSEC_PER_SEC);
+
+	if (done[0])
+		printSteadyRun(runs[0], name, "DMIPS", 0, type);
+	if (done[1])
+		printSteadyRun(runs[1], (type == FORMAT_PLAIN) ? "Disk write" : "disk-write", "B/s", 1, type);
+
+	if (type == FORMAT_XML)
+		printf("\t</results>\n");
+}
+
+/* Prints the statistics of all the repeated metrics */
+void printStatsResults(int type)
+{
+	tStats *st;
+	int i;
+
+	if (type == FORMAT_PLAIN) {
+		printf("Repetition statistics (95%% CI within %.*f%%, budget %d s):\n", prec, repeatCI, repeatBudget);
+		for (i = 0; i < results->stats_size; i++) {
+			st = &results->stats[i].stats;
+			printf("\t%s: median %.*f %s, mean %.*f, stddev %.*f, p5 %.*f, p95 %.*f\n", results->stats[i].name,
+					prec, st->median, results->stats[i].unit, prec, st->mean, prec, st->stddev, prec, st->p5,
+					prec, st->p95);
+			printf("\t\tCI %.*f - %.*f (+/- %.*f%%), %d runs after %d warm-up, %d outlier(s)%s\n", prec, st->ci_low,
+					prec, st->ci_high, prec, stats_ci_pct(st), st->runs, st->warmup, st->outliers,
+					st->converged ? "" : ", not converged");
+		}
+	}
+	else
+	if (type == FORMAT_CSV) {
+		printf("metric,unit,runs,warmup,outliers,converged,median,mean,stddev,p5,p95,ci_low,ci_high\n");
+		for (i = 0; i < results->stats_size; i++) {
+			st = &results->stats[i].stats;
+			printf("%s,%s,%d,%d,%d,%d,%.*f,%.*f,%.*f,%.*f,%.*f,%.*f,%.*f\n", results->stats[i].name,
+					results->stats[i].unit, st->runs, st->warmup, st->outliers, st->converged, prec, st->median,
+					prec, st->mean, prec, st->stddev, prec, st->p5, prec, st->p95, prec, st->ci_low, prec, st->ci_high);
+		}
+	}
+	else
+	if (type == FORMAT_XML) {
+		printf("\t<results type=\"statistics\" ci=\"%.*f\" budget=\"%d\">\n", prec, repeatCI, repeatBudget);
+		for (i = 0; i < results->stats_size; i++) {
+			st = &results->stats[i].stats;
+			printf("\t\t<metric name=\"%s\" unit=\"%s\" runs=\"%d\" warmup=\"%d\" outliers=\"%d\" converged=\"%d\">\n",
+					results->stats[i].name, results->stats[i].unit, st->runs, st->warmup, st->outliers, st->converged);
+			printf("\t\t\t<median>%.*f</median>\n", prec, st->median);
+			printf("\t\t\t<mean>%.*f</mean>\n", prec, st->mean);
+			printf("\t\t\t<stddev>%.*f</stddev>\n", prec, st->stddev);
+			printf("\t\t\t<p5>%.*f</p5>\n", prec, st->p5);
+			printf("\t\t\t<p95>%.*f</p95>\n", prec, st->p95);
+			printf("\t\t\t<ci low=\"%.*f\" high=\"%.*f\" />\n", prec, st->ci_low, prec, st->ci_high);
+			printf("\t\t</metric>\n");
+		}
+		printf("\t</results>\n");
+	}
+}
+
+/* Prints the counters of all the benchmark regions, the counters not available are left out */
+void printPerfResults(int type)
+{
+	tPerfRegion *reg;
+	char tmp[16];
+	double val;
+	int i, j;
+
+	if (type == FORMAT_PLAIN) {
+		if (results->perf_err < 0) {
+			printf("Performance counters: not available (%s)\n", strerror(-results->perf_err));
+			return;
+		}
+
+		printf("Performance counters:\n");
+		for (i = 0; i < results->perf_size; i++) {
+			reg = &results->perf[i];
+			printf("\t%s", reg->benchmark);
+			if (strcmp(reg->operation, "-") != 0)
+				printf(" %s", reg->operation);
+			if (reg->chunk_size > 1) {
+				io_get_size(reg->chunk_size, 0, tmp, 16);
+				printf(" with %s buffer", tmp);
+			}
+			printf(":");
+
+			for (j = 0; j < PERF_EVENTS; j++)
+				if (PERF_VALID(&reg->counts, j))
+					printf("%s %s %llu", (j > 0) ? "," : "", perf_event_name(j), reg->counts.value[j]);
+				else
+					printf("%s %s n/a", (j > 0) ? "," : "", perf_event_name(j));
+			if ((val = perf_ipc(&reg->counts)) >= 0.0)
+				printf(", IPC %.*f", prec, val);
+			if ((reg->unit != NULL) && ((val = perf_cycles_per(&reg->counts, reg->work)) >= 0.0))
+				printf(", %.*f cycles/%s", prec, val, reg->unit);
+			printf("\n");
+		}
+	}
+	else
+	if (type == FORMAT_CSV) {
+		printf("benchmark,operation,chunk_size");
+		for (j = 0; j < PERF_EVENTS; j++)
+			printf(",%s", perf_event_name(j));
+		printf(",ipc,work,unit,cycles_per_unit\n");
+
+		for (i = 0; i < results->perf_size; i++) {
+			reg = &results->perf[i];
+			printf("%s,%s,%lu", reg->benchmark, reg->operation, reg->chunk_size);
+			for (j = 0; j < PERF_EVENTS; j++)
+				if (PERF_VALID(&reg->counts, j))
+					printf(",%llu", reg->counts.value[j]);
+				else
+					printf(",-");
+			if ((val = perf_ipc(&reg->counts)) >= 0.0)
+				printf(",%.*f", prec, val);
+			else
+				printf(",-");
+			printf(",%llu,%s", reg->work, (reg->unit != NULL) ? reg->unit : "-");
+			if ((reg->unit != NULL) && ((val = perf_cycles_per(&reg->counts, reg->work)) >= 0.0))
+				printf(",%.*f\n", prec, val);
+			else
+				printf(",-\n");
+		}
+	}
+	else
+	if (type == FORMAT_XML) {
+		if (results->perf_err < 0) {
+			printf("\t<results type=\"perf\" error=\"%s\" />\n", strerror(-results->perf_err));
+			return;
+		}
+
+		printf("\t<results type=\"perf\">\n");
+		for (i = 0; i < results->perf_size; i++) {
+			reg = &results->perf[i];
+			printf("\t\t<region benchmark=\"%s\" operation=\"%s\" chunk_size=\"%lu\">\n", reg->benchmark,
+					reg->operation, reg->chunk_size);
+			for (j = 0; j < PERF_EVENTS; j++)
+				if (PERF_VALID(&reg->counts, j))
+					printf("\t\t\t<counter name=\"%s\">%llu</counter>\n", perf_event_name(j), reg->counts.value[j]);
+			if ((val = perf_ipc(&reg->counts)) >= 0.0)
+				printf("\t\t\t<ipc>%.*f</ipc>\n", prec, val);
+			if ((reg->unit != NULL) && ((val = perf_cycles_per(&reg->counts, reg->work)) >= 0.0))
+				printf("\t\t\t<cycles_per unit=\"%s\" work=\"%llu\">%.*f</cycles_per>\n", reg->unit, reg->work,
+						prec, val);
+			printf("\t\t</region>\n");
+		}
+		printf("\t</results>\n");
+	}
+}
+
+void printResults(unsigned long long flags, int type)
+{
+	char tmp[16];
+	int i, j, k, src, dst;
+
+	if (type == FORMAT_PLAIN) {
+		if (flags & FLAG_TIMER_GET) {
+			printf("Timer source: %s\n", timer_source_name(results->timer_source));
+			if (results->timer_source == TIMER_SOURCE_TSC)
+				printf("\tTSC frequency: %.*f MHz\n", prec, results->timer_tsc_mhz);
+			printf("\tResolution: %.*f ns\n", prec, results->timer_resolution);
+			printf("\tOverhead: %.*f ns\n", prec, results->timer_overhead);
+		}
+		if (flags & FLAG_CA_GET) {
+			printf("Processors used: %d\n", results->cpus);
+			printf("Processor mask: %s\n", results->cpumask);
+			printf("Processor list: %s\n", results->cpulist);
+		}
+		if (flags & FLAG_CPU_GET) {
+			printf("Processors total: %d\n", results->cpu_total);
+			printf("Processors online: %d\n", results->cpu_online);
+		}
+		if (flags & FLAG_TOPOLOGY) {
+			tTopology *topo = &results->topology;
+
+			printf("Topology:\n");
+			printf("\tCPUs online: %d\n", topo->cpus);
+			printf("\tPackages: %d\n", topo->packages);
+			printf("\tCores: %d\n", topo->cores);
+			printf("\tThreads per core: %d\n", topo->smt);
+			printf("\tNUMA nodes: %d\n", topo->nodes);
+			for (i = 0; i < topo->ncaches; i++) {
+				io_get_size(topo->caches[i].size, prec, tmp, 16);
+				printf("\tL%d %s cache: %s, %d B line, %d-way, shared by %d CPU(s)\n", topo->caches[i].level,
+						topo->caches[i].type, tmp, topo->caches[i].line, topo->caches[i].ways, topo->caches[i].shared);
+			}
+			printf("\tWorking sets:");
+			for (i = 0; i < results->topology_sets_size; i++) {
+				char level[16];
+
+				io_get_size_double(results->topology_sets[i], prec, tmp, 16);
+				printf("%s %s (%s)", (i > 0) ? "," : "", tmp,
+						topology_level_name(results->topology_sets_level[i], level, sizeof(level)));
+			}
+			printf("\n");
+		}
+		if (flags & FLAG_CPU_SPEED)
+			printf("Processor speed: %.*f MHz\n", prec, results->cpu_speed);
+		if ((flags & FLAG_CPU_FREQ) && (results->cpu_freq_cores > 0)) {
+			printf("Processor frequency (%s, TSC %.*f MHz):\n", cpu_freq_method_name(results->cpu_freq_method),
+					prec, results->cpu_freq_tsc);
+			for (i = 0; i < results->cpu_freq_cores; i++)
+				printf("\tCPU %d alone: %.*f MHz\n", results->cpu_freq_cpu[i], prec, results->cpu_freq_single[i]);
+			for (i = 1; i <= results->cpu_freq_loads; i++) {
+				printf("\t%d core(s) loaded: average %.*f MHz (", i, prec, cpu_frequency_average(i));
+				for (j = 0; j < i; j++)
+					printf("%sCPU %d: %.*f", (j > 0) ? ", " : "", results->cpu_freq_cpu[j], prec,
+							results->cpu_freq_load[(i - 1) * results->cpu_freq_cores + j]);
+				printf(")\n");
+			}
+		}
+		if ((flags & FLAG_CPU_C2C) && (results->cpu_c2c_size > 0))
+			printC2CMatrix();
+		if (flags & FLAG_SYSCALL) {
+			int p;
+
+			printf("System call overhead:\n");
+			for (i = 0; i < SYSCALL_CALLS; i++)
+				if (results->sys_call[i] > 0.0)
+					printf("\t%s: %.*f ns\n", syscall_call_name(i), prec, results->sys_call[i]);
+			printf("Context switch latency:\n");
+			for (p = 0; p < 2; p++)
+				for (i = 0; i < CTXSW_PLACEMENTS; i++)
+					if (results->sys_ctxsw[p][i] > 0.0)
+						printf("\t%s, %s (CPU %d and CPU %d): %.*f ns\n", syscall_ctxsw_name(p),
+								(i == CTXSW_SAME_CORE) ? "same core" : "cross core", results->sys_ctxsw_cpu[0],
+								results->sys_ctxsw_cpu[i + 1], prec, results->sys_ctxsw[p][i]);
+					else
+						printf("\t%s, %s: not available\n", syscall_ctxsw_name(p),
+								(i == CTXSW_SAME_CORE) ? "same core" : "cross core");
+		}
+		if ((flags & FLAG_CPU_SYNC) && (results->cpu_sync_size > 0)) {
+			int p;
+
+			printf("Synchronization primitives:\n");
+			for (p = 0; p < SYNC_PRIMITIVES; p++) {
+				printf("\t%s:\n", sync_primitive_name(p));
+				for (i = 0; i < results->cpu_sync_size; i++) {
+					tSyncResults *res = &results->cpu_sync[p][i];
+
+					printf("\t\t%d thread(s):", res->threads);
+					for (j = 0; j < SYNC_CASES; j++)
+						printf("%s %s %.*f Mops/s (fairness %.*f)", (j > 0) ? "," : "", sync_case_name(j),
+								prec, res->mops[j], prec, res->fairness[j]);
+					printf("\n");
+				}
+			}
+		}
+		if (flags & (FLAG_CPU_DHRYSTONE | FLAG_CPU_WHETSTONE | FLAG_CPU_LINPACK))
+			printf("Processor's kernels built for: %s\n", cpu_isa_name(results->cpu_isa));
+		if (flags & FLAG_CPU_DHRYSTONE)
+			printf("Processor's Dhrystone: %.*f DMIPS\n", prec, results->cpu_dhrystone);
+		if (flags & FLAG_CPU_DHRY_SCALE)
+			printScaleResults(results->cpu_dhrystone_scale, results->cpu_dhrystone_scale_size,
+						"Dhrystone", "DMIPS", 0, NULL, NULL, type);
+		if (flags & FLAG_CPU_WHETSTONE) {
+			printf("Processor's Whetstone: %ld MIPS\n", results->cpu_whetstone);
+			for (i = 0; i < WHETSTONE_MODULES; i++)
+				printf("\tModule %s: %.*f %s\n", cpu_whetstone_module_name(i), prec, results->cpu_whetstone_modules[i],
+						cpu_whetstone_module_unit(i));
+		}
+		if (flags & FLAG_CPU_WHET_SCALE)
+			printScaleResults(results->cpu_whetstone_scale, results->cpu_whetstone_scale_size,
+						"Whetstone", "MIPS", WHETSTONE_MODULES, cpu_whetstone_module_name,
+						cpu_whetstone_module_unit, type);
+		if (flags & FLAG_CPU_LINPACK) {
+			printf("Processor's LinPack 2D array score:\n");
+			printf("\tArray size: %dx%d\n", results->cpu_linpack_size, results->cpu_linpack_size);
+			io_get_size(results->cpu_linpack_mem, prec, tmp, 16);
+			printf("\tMemory used: %s\n", tmp);
+			printf("\tMinimum score: %.*f MFLOPS\n", prec, results->cpu_linpack_min);
+			printf("\tMaximum score: %.*f MFLOPS\n", prec, results->cpu_linpack_max);
+			printf("\tAverage score: %.*f MFLOPS\n", prec, results->cpu_linpack_avg);
+			if (flags & FLAG_CPU_LINPACK_BLK) {
+				printf("\tBlocked minimum score: %.*f MFLOPS\n", prec, results->cpu_linpack_blk_min);
+				printf("\tBlocked maximum score: %.*f MFLOPS\n", prec, results->cpu_linpack_blk_max);
+				printf("\tBlocked average score: %.*f MFLOPS\n", prec, results->cpu_linpack_blk_avg);
+				printf("\tBlocked engine kernels: %s\n", linpack_isa_name(results->cpu_linpack_blk_isa));
+			}
+			if (flags & FLAG_CPU_LINPACK_SIMD) {
+				printf("\tSIMD kernels selected: %s\n", linpack_isa_name(results->cpu_linpack_simd_isa));
+				for (i = 0; i < LINPACK_ISA_COUNT; i++) {
+					if (!linpack_isa_supported(i)) {
+						printf("\tSIMD %s: not supported\n", linpack_isa_name(i));
+						continue;
+					}
+					printf("\tSIMD %s score: min %.*f, max %.*f, avg %.*f MFLOPS\n", linpack_isa_name(i),
+							prec, results->cpu_linpack_simd_min[i], prec, results->cpu_linpack_simd_max[i],
+							prec, results->cpu_linpack_simd_avg[i]);
+				}
+			}
+		}
+		if (flags & FLAG_CPU_LINPACK_SCALE) {
+			printf("Linpack parallel array size: %dx%d\n", results->cpu_linpack_scale_arsize,
+					results->cpu_linpack_scale_arsize);
+			printScaleResults(results->cpu_linpack_scale, results->cpu_linpack_scale_size,
+						"Linpack", "GFLOPS", 0, NULL, NULL, type);
+		}
+		if (flags & FLAG_CPU_LINPACK_PREC) {
+			printf("Linpack precision array size: %dx%d\n", results->cpu_linpack_prec_arsize,
+					results->cpu_linpack_prec_arsize);
+			for (i = 0; i < LINPACK_PREC_COUNT; i++)
+				printf("\t%s precision: %.*f GFLOPS, residual %g, %d refinement steps\n", linpack_precision_name(i),
+						prec, results->cpu_linpack_prec_gflops[i], results->cpu_linpack_prec_residual[i],
+						results->cpu_linpack_prec_iters[i]);
+		}
+		if (flags & FLAG_CPU_LINPACK_SWEEP) {
+			char trans[16];
+
+			printf("Linpack array size sweep:\n");
+			for (i = 0; i < results->cpu_linpack_sweep_size; i++) {
+				if (linpack_sweep_transition(i, trans, sizeof(trans)) != NULL)
+					printf("\t---- %s transition ----\n", trans);
+				io_get_size_double(results->cpu_linpack_sweep[i].wset, prec, tmp, 16);
+				printf("\tSize %dx%d, working set %s (%s): %.*f MFLOPS\n", results->cpu_linpack_sweep[i].size,
+						results->cpu_linpack_sweep[i].size, tmp, linpack_level_name(results->cpu_linpack_sweep[i].level),
+						prec, results->cpu_linpack_sweep[i].mflops);
+			}
+		}
+		if (flags & FLAG_CPU_ISA)
+			printCpuIsaResults(type);
+		if (flags & FLAG_MEM_GET) {
+			io_get_size_double(results->memory_size, prec, tmp, 16);
+			printf("Memory size: %s\n", tmp);
+		}
+		if (flags & FLAG_MEM_BANDWIDTH) {
+			char name[64];
+
+			io_get_size(results->memory_bw_arsize, prec, tmp, 16);
+			printf("Memory bandwidth array size: %s\n", tmp);
+			for (j = 0; j < MEMBW_MODES; j++)
+				for (i = 0; i < MEMBW_KERNELS; i++)
+					printScaleResults(results->memory_bw_scale[j][i], results->memory_bw_scale_size[j],
+								memory_bandwidth_name(j, i, type, name, sizeof(name)), "GB/s", 0, NULL, NULL, type);
+		}
+		if (flags & FLAG_MEM_LATENCY) {
+			printf("Memory latency (cycles at %.*f MHz):\n", prec, results->memory_lat_mhz);
+			for (i = 0; i < results->memory_lat_size; i++) {
+				io_get_size_double(results->memory_lat[i].size, prec, tmp, 16);
+				printf("\tWorking set %s:", tmp);
+				for (j = 0; j < MEMPAGE_COUNT; j++)
+					if (results->memory_lat[i].ns[j] > 0.0)
+						printf("%s %s %.*f ns (%.*f cycles)", (j > 0) ? "," : "", memory_page_name(j), prec,
+								results->memory_lat[i].ns[j], prec,
+								results->memory_lat[i].ns[j] * results->memory_lat_mhz / 1000.0);
+				printf("\n");
+			}
+		}
+		if (flags & FLAG_MEM_NUMA) {
+			io_get_size(results->memory_numa_arsize, prec, tmp, 16);
+			printf("NUMA array size: %s\n", tmp);
+			printNumaMatrix("bandwidth", "GB/s", results->memory_numa_bw);
+			printNumaMatrix("latency", "ns", results->memory_numa_lat);
+		}
+		if (flags & FLAG_MEM_PAGES) {
+			io_get_size(results->memory_pages_arsize, prec, tmp, 16);
+			printf("Page size comparison (array size %s, Linpack size %dx%d):\n", tmp, results->memory_pages_lpsize,
+					results->memory_pages_lpsize);
+			for (i = 0; i < MEMPAGE_COUNT; i++) {
+				if (results->memory_pages_err[i] != 0) {
+					printf("\t%s pages: not available (%s)\n", memory_page_name(i), strerror(-results->memory_pages_err[i]));
+					continue;
+				}
+				printf("\t%s pages:\n", memory_page_name(i));
+				printf("\t\tLatency: %.*f ns", prec, results->memory_pages_lat[i]);
+				if (i != MEMPAGE_BASE)
+					printf(" (speedup %.*fx)", prec, memory_pages_speedup(results->memory_pages_lat, i, 1));
+				printf("\n\t\tTriad bandwidth: %.*f GB/s", prec, results->memory_pages_bw[i]);
+				if (i != MEMPAGE_BASE)
+					printf(" (speedup %.*fx)", prec, memory_pages_speedup(results->memory_pages_bw, i, 0));
+				printf("\n\t\tLinpack: %.*f MFLOPS", prec, results->memory_pages_linpack[i]);
+				if (i != MEMPAGE_BASE)
+					printf(" (speedup %.*fx)", prec, memory_pages_speedup(results->memory_pages_linpack, i, 0));
+				printf("\n");
+				if (i != MEMPAGE_BASE)
+					printf("\t\tImplied TLB miss cost: %.*f ns (%.*f cycles)\n", prec, memory_pages_tlb_miss(i),
+							prec, memory_pages_tlb_miss(i) * results->memory_pages_mhz / 1000.0);
+			}
+		}
+		if ((flags & FLAG_MEM_ALLOC) && (results->memory_alloc_size > 0)) {
+			printf("Memory allocator %s (peak RSS %lu KiB):\n", results->memory_alloc_name, results->memory_alloc_peak);
+			for (i = 0; i < results->memory_alloc_size; i++) {
+				printf("\t%d thread(s):", results->memory_alloc[i].threads);
+				for (j = 0; j < ALLOC_WORKLOADS; j++)
+					printf("%s %s %.*f Mops/s (RSS %lu KiB)", (j > 0) ? "," : "", alloc_workload_name(j), prec,
+							results->memory_alloc[i].mops[j], results->memory_alloc[i].rss[j]);
+				printf("\n");
+			}
+		}
+		if ((flags & FLAG_MEM_FAULTS) && (results->memory_fault_size > 0)) {
+			io_get_size(results->memory_fault_region, prec, tmp, 16);
+			printf("Memory page faults:\n");
+			for (i = 0; i < results->memory_fault_size; i++) {
+				printf("\t%d thread(s):", results->memory_fault[i].threads);
+				for (j = MEMPAGE_BASE; j <= MEMPAGE_THP; j++)
+					if (results->memory_fault_err[j] == 0)
+						printf(" %s %.*f GB/s (%.*f k faults/s),", memory_page_name(j), prec,
+								results->memory_fault[i].gbps[j], prec, results->memory_fault[i].faults[j]);
+				printf(" munmap %.*f ns\n", prec, results->memory_fault[i].unmap);
+			}
+			printf("\tMapping of %s, lazy faulting vs. populated:\n", tmp);
+			for (j = 0; j < MEMPAGE_COUNT; j++) {
+				if ((results->memory_populate[j][0] <= 0.0) || (results->memory_populate[j][1] <= 0.0)) {
+					printf("\t\t%s pages: not available\n", memory_page_name(j));
+					continue;
+				}
+				printf("\t\t%s pages: %.*f GB/s vs. %.*f GB/s (speedup %.*fx)\n", memory_page_name(j), prec,
+						results->memory_populate[j][0], prec, results->memory_populate[j][1], prec,
+						results->memory_populate[j][1] / results->memory_populate[j][0]);
+			}
+		}
+		if ((flags & FLAG_MEM_COPY) && (results->memory_copy_size > 0)) {
+			printf("Memory copy (source/destination offset):\n");
+			for (i = 0; i < results->memory_copy_size; i++) {
+				io_get_size(results->memory_copy[i].size, 0, tmp, 16);
+				printf("\t%s blocks:\n", tmp);
+				for (j = 0; j < COPY_FUNCS; j++) {
+					printf("\t\t%s:", copy_func_name(j));
+					for (k = 0; k < COPY_ALIGNS; k++) {
+						copy_align_get(k, &src, &dst);
+						printf("%s %d/%d %.*f GB/s", (k > 0) ? "," : "", src, dst, prec, results->memory_copy[i].gbps[j][k]);
+					}
+					printf("\n");
+				}
+			}
+		}
+		if (flags & FLAG_DISK_STAT) {
+			printf("Disk:\n");
+			printf("\tCan drop caches: %s\n", results->disk_drop_caches ? "True" : "False");
+			printf("\tResults:\n");
+
+			for (i = 0; i < results->disk_res_size; i++) {
+				if (strncmp(results->disk[i].operation, "File", 4) != 0) {
+					char tmp2[16] = { 0 }, tmpChunk[16] = { 0 };
+					io_get_size(results->disk[i].size, 0, tmp, 16);
+					io_get_size(results->disk[i].chunk_size, 0, tmpChunk, 16);
+					io_get_size_double(results->disk[i].throughput, prec, tmp2, 16);
+					printf("\t\t%s of %s with %s buffer: %s/s (CPU %.*f%%)\n", results->disk[i].operation, tmp,
+							tmpChunk, tmp2, prec, results->disk[i].cpu_usage);
+				}
+				else {
+					printf("\t\t%s of %lld files: %.*f files/s (CPU %.*f%%)\n", results->disk[i].operation,
+							results->disk[i].size, prec, results->disk[i].throughput, prec, results->disk[i].cpu_usage);
+				}
+			}
+		}
+		if (flags & FLAG_NETC_STAT) {
+			int i;
+
+			printf("Network results:\n");
+
+			for (i = 0; i < results->net_res_size; i++) {
+					char tmp2[16] = { 0 }, tmpChunk[16] = { 0 };
+					io_get_size(results->net[i].size, 0, tmp, 16);
+					io_get_size(results->net[i].chunk_size, 0, tmpChunk, 16);
+					io_get_size_double(results->net[i].throughput, prec, tmp2, 16);
+					printf("\t%s of %s with %s buffer: %s/s (CPU %.*f%%)\n", results->net[i].operation, tmp,
+							tmpChunk, tmp2, prec, results->net[i].cpu_usage);
+			}
+		}
+		if (flags & FLAG_STEADY)
+			printSteadyResults(type);
+		if (flags & FLAG_REPEAT)
+			printStatsResults(type);
+		if (flags & FLAG_PERF)
+			printPerfResults(type);
+
+		printf("Total run time: %.*f seconds\n", prec, results->run_time);
+	}
+	else
+	if (type == FORMAT_CSV) {
+		if ((flags & FLAG_CA_GET) || (flags & FLAG_CPU_GET) || (flags & FLAG_CPU_SPEED) || (flags & FLAG_CPU_DHRYSTONE)
+				|| (flags & FLAG_CPU_WHETSTONE) || (flags & FLAG_CPU_LINPACK) || (flags & FLAG_MEM_GET)) {
+			printf("cpus_used,cpu_mask,cpus_total,cpus_online,cpu_speed,cpu_dhrystone,cpu_whetstone,linpack_min,linpack_max,linpack_avg,memory_size,run_time\n");
+			if (flags & FLAG_CA_GET)
+				printf("%d,%s,", results->cpus, results->cpumask);
+			else
+				printf("-,-,");
+
+			if (flags & FLAG_CPU_GET)
+				printf("%d,%d,", results->cpu_total, results->cpu_online);
+			else
+				printf("-,-,");
+
+			if (flags & FLAG_CPU_SPEED)
+				printf("%.*f,", prec, results->cpu_speed);
+			else
+				printf("-,");
+
+			if (flags & FLAG_CPU_DHRYSTONE)
+				printf("%.*f,", prec, results->cpu_dhrystone);
+			else
+				printf("-,");
+
+			if (flags & FLAG_CPU_WHETSTONE)
+				printf("%ld,", results->cpu_whetstone);
+			else
+				printf("-,");
+
+			if (flags & FLAG_CPU_LINPACK)
+				printf("%.*f,%.*f,%.*f,", prec, results->cpu_linpack_min, prec, results->cpu_linpack_max,
+						prec, results->cpu_linpack_avg);
+			else
+				printf("-,-,-,");
+
+			if (flags & FLAG_MEM_GET)
+				printf("%.f,", results->memory_size);
+			else
+				printf("-,");
+
+			printf("%.*f\n", prec, results->run_time);
+			if (flags & (FLAG_CPU_DHRYSTONE | FLAG_CPU_WHETSTONE | FLAG_CPU_LINPACK))
+				printf("cpu_kernels\n%s\n", cpu_isa_name(results->cpu_isa));
+		}
+
+		if ((flags & FLAG_CPU_LINPACK) && (flags & (FLAG_CPU_LINPACK_BLK | FLAG_CPU_LINPACK_SIMD))) {
+			printf("linpack_engine,linpack_kernels,linpack_size,linpack_min,linpack_max,linpack_avg\n");
+			printf("classic,-,%d,%.*f,%.*f,%.*f\n", results->cpu_linpack_size, prec, results->cpu_linpack_min,
+					prec, results->cpu_linpack_max, prec, results->cpu_linpack_avg);
+			if (flags & FLAG_CPU_LINPACK_BLK)
+				printf("blocked,%s,%d,%.*f,%.*f,%.*f\n", linpack_isa_name(results->cpu_linpack_blk_isa),
+						results->cpu_linpack_size, prec, results->cpu_linpack_blk_min,
+						prec, results->cpu_linpack_blk_max, prec, results->cpu_linpack_blk_avg);
+			if (flags & FLAG_CPU_LINPACK_SIMD)
+				for (i = 0; i < LINPACK_ISA_COUNT; i++) {
+					if (linpack_isa_supported(i))
+						printf("simd,%s,%d,%.*f,%.*f,%.*f\n", linpack_isa_name(i), results->cpu_linpack_size,
+								prec, results->cpu_linpack_simd_min[i], prec, results->cpu_linpack_simd_max[i],
+								prec, results->cpu_linpack_simd_avg[i]);
+					else
+						printf("simd,%s,%d,-,-,-\n", linpack_isa_name(i), results->cpu_linpack_size);
+				}
+		}
+		if (flags & FLAG_CPU_DHRY_SCALE)
+			printScaleResults(results->cpu_dhrystone_scale, results->cpu_dhrystone_scale_size,
+						"dhrystone", "DMIPS", 0, NULL, NULL, type);
+		if (flags & FLAG_CPU_WHETSTONE) {
+			printf("module,unit,score\n");
+			for (i = 0; i < WHETSTONE_MODULES; i++)
+				printf("%s,%s,%.*f\n", cpu_whetstone_module_name(i), cpu_whetstone_module_unit(i),
+						prec, results->cpu_whetstone_modules[i]);
+		}
+		if (flags & FLAG_CPU_WHET_SCALE)
+			printScaleResults(results->cpu_whetstone_scale, results->cpu_whetstone_scale_size,
+						"whetstone", "MIPS", WHETSTONE_MODULES, cpu_whetstone_module_name,
+						cpu_whetstone_module_unit, type);
+		if (flags & FLAG_CPU_LINPACK_SCALE)
+			printScaleResults(results->cpu_linpack_scale, results->cpu_linpack_scale_size,
+						"linpack", "GFLOPS", 0, NULL, NULL, type);
+		if (flags & FLAG_CPU_LINPACK_PREC) {
+			printf("linpack_precision,linpack_size,gflops,residual,refinement_steps\n");
+			for (i = 0; i < LINPACK_PREC_COUNT; i++)
+				printf("%s,%d,%.*f,%g,%d\n", linpack_precision_name(i), results->cpu_linpack_prec_arsize, prec,
+						results->cpu_linpack_prec_gflops[i], results->cpu_linpack_prec_residual[i],
+						results->cpu_linpack_prec_iters[i]);
+		}
+		if (flags & FLAG_CPU_LINPACK_SWEEP) {
+			char trans[16];
+
+			printf("linpack_sweep_size,working_set,mflops,level,transition\n");
+			for (i = 0; i < results->cpu_linpack_sweep_size; i++)
+				printf("%d,%llu,%.*f,%s,%s\n", results->cpu_linpack_sweep[i].size, results->cpu_linpack_sweep[i].wset,
+						prec, results->cpu_linpack_sweep[i].mflops, linpack_level_name(results->cpu_linpack_sweep[i].level),
+						(linpack_sweep_transition(i, trans, sizeof(trans)) != NULL) ? trans : "-");
+		}
+		if (flags & FLAG_CPU_ISA)
+			printCpuIsaResults(type);
+		if (flags & FLAG_TIMER_GET) {
+			printf("timer_source,tsc_mhz,resolution,overhead\n");
+			printf("%s,", timer_source_name(results->timer_source));
+			if (results->timer_source == TIMER_SOURCE_TSC)
+				printf("%.*f,", prec, results->timer_tsc_mhz);
+			else
+				printf("-,");
+			printf("%.*f,%.*f\n", prec, results->timer_resolution, prec, results->timer_overhead);
+		}
+		if (flags & FLAG_TOPOLOGY) {
+			tTopology *topo = &results->topology;
+			char level[16];
+
+			printf("topology_cpus,packages,cores,threads_per_core,numa_nodes\n");
+			printf("%d,%d,%d,%d,%d\n", topo->cpus, topo->packages, topo->cores, topo->smt, topo->nodes);
+			printf("cache_level,type,size,line_size,ways,shared_cpus\n");
+			for (i = 0; i < topo->ncaches; i++)
+				printf("%d,%s,%ld,%d,%d,%d\n", topo->caches[i].level, topo->caches[i].type, topo->caches[i].size,
+						topo->caches[i].line, topo->caches[i].ways, topo->caches[i].shared);
+			printf("working_set,level\n");
+			for (i = 0; i < results->topology_sets_size; i++)
+				printf("%llu,%s\n", results->topology_sets[i],
+						topology_level_name(results->topology_sets_level[i], level, sizeof(level)));
+		}
+		if ((flags & FLAG_CPU_FREQ) && (results->cpu_freq_cores > 0)) {
+			printf("frequency_method,tsc_mhz\n");
+			printf("%s,%.*f\n", cpu_freq_method_name(results->cpu_freq_method), prec, results->cpu_freq_tsc);
+			printf("loaded_cores,cpu,mhz\n");
+			for (i = 0; i < results->cpu_freq_cores; i++)
+				printf("alone,%d,%.*f\n", results->cpu_freq_cpu[i], prec, results->cpu_freq_single[i]);
+			for (i = 1; i <= results->cpu_freq_loads; i++)
+				for (j = 0; j < i; j++)
+					printf("%d,%d,%.*f\n", i, results->cpu_freq_cpu[j], prec,
+							results->cpu_freq_load[(i - 1) * results->cpu_freq_cores + j]);
+		}
+		if ((flags & FLAG_CPU_C2C) && (results->cpu_c2c_size > 0)) {
+			int n = results->cpu_c2c_size;
+
+			printf("c2c_cpu1,c2c_cpu2,relation,latency\n");
+			for (i = 0; i < n; i++)
+				for (j = i + 1; j < n; j++)
+					if (results->cpu_c2c_lat[i * n + j] > 0.0)
+						printf("%d,%d,%s,%.*f\n", results->cpu_c2c_cpu[i], results->cpu_c2c_cpu[j],
+								topology_relation_name(results->cpu_c2c_rel[i * n + j]), prec, results->cpu_c2c_lat[i * n + j]);
+		}
+		if ((flags & FLAG_CPU_SYNC) && (results->cpu_sync_size > 0)) {
+			int p;
+
+			printf("sync_primitive,threads,case,mops,fairness\n");
+			for (p = 0; p < SYNC_PRIMITIVES; p++)
+				for (i = 0; i < results->cpu_sync_size; i++)
+					for (j = 0; j < SYNC_CASES; j++)
+						printf("%s,%d,%s,%.*f,%.*f\n", sync_primitive_name(p), results->cpu_sync[p][i].threads,
+								sync_case_name(j), prec, results->cpu_sync[p][i].mops[j], prec,
+								results->cpu_sync[p][i].fairness[j]);
+		}
+		if (flags & FLAG_SYSCALL) {
+			int p;
+
+			printf("syscall,latency\n");
+			for (i = 0; i < SYSCALL_CALLS; i++)
+				if (results->sys_call[i] > 0.0)
+					printf("%s,%.*f\n", syscall_call_name(i), prec, results->sys_call[i]);
+			printf("context_switch,placement,cpu1,cpu2,latency\n");
+			for (p = 0; p < 2; p++)
+				for (i = 0; i < CTXSW_PLACEMENTS; i++)
+					if (results->sys_ctxsw[p][i] > 0.0)
+						printf("%s,%s,%d,%d,%.*f\n", syscall_ctxsw_name(p), (i == CTXSW_SAME_CORE) ? "same-core" : "cross-core",
+								results->sys_ctxsw_cpu[0], results->sys_ctxsw_cpu[i + 1], prec, results->sys_ctxsw[p][i]);
+		}
+		if (flags & FLAG_MEM_BANDWIDTH) {
+			char name[64];
+
+			for (j = 0; j < MEMBW_MODES; j++)
+				for (i = 0; i < MEMBW_KERNELS; i++)
+					printScaleResults(results->memory_bw_scale[j][i], results->memory_bw_scale_size[j],
+								memory_bandwidth_name(j, i, type, name, sizeof(name)), "GB/s", 0, NULL, NULL, type);
+		}
+		if (flags & FLAG_MEM_LATENCY) {
+			printf("memory_latency_size,pages,ns,cycles,mhz\n");
+			for (i = 0; i < results->memory_lat_size; i++)
+				for (j = 0; j < MEMPAGE_COUNT; j++)
+					if (results->memory_lat[i].ns[j] > 0.0)
+						printf("%llu,%s,%.*f,%.*f,%.*f\n", results->memory_lat[i].size, memory_page_name(j), prec,
+								results->memory_lat[i].ns[j], prec,
+								results->memory_lat[i].ns[j] * results->memory_lat_mhz / 1000.0, prec, results->memory_lat_mhz);
+		}
+		if (flags & FLAG_MEM_NUMA) {
+			int n = results->memory_numa_size;
+
+			printf("numa_cpu_node,numa_memory_node,array_size,bandwidth,latency\n");
+			for (i = 0; i < n; i++)
+				for (j = 0; j < n; j++)
+					if (results->memory_numa_bw[i * n + j] > 0.0)
+						printf("%d,%d,%llu,%.*f,%.*f\n", results->memory_numa_node[i], results->memory_numa_node[j],
+								results->memory_numa_arsize, prec, results->memory_numa_bw[i * n + j],
+								prec, results->memory_numa_lat[i * n + j]);
+		}
+		if (flags & FLAG_MEM_PAGES) {
+			printf("pages,array_size,linpack_size,latency,bandwidth,linpack,latency_speedup,bandwidth_speedup,"
+					"linpack_speedup,tlb_miss_ns,tlb_miss_cycles\n");
+			for (i = 0; i < MEMPAGE_COUNT; i++) {
+				printf("%s,%llu,%d,", memory_page_name(i), results->memory_pages_arsize, results->memory_pages_lpsize);
+				if (results->memory_pages_err[i] != 0)
+					printf("-,-,-,-,-,-,-,-\n");
+				else
+					printf("%.*f,%.*f,%.*f,%.*f,%.*f,%.*f,%.*f,%.*f\n", prec, results->memory_pages_lat[i],
+							prec, results->memory_pages_bw[i], prec, results->memory_pages_linpack[i],
+							prec, memory_pages_speedup(results->memory_pages_lat, i, 1),
+							prec, memory_pages_speedup(results->memory_pages_bw, i, 0),
+							prec, memory_pages_speedup(results->memory_pages_linpack, i, 0),
+							prec, memory_pages_tlb_miss(i), prec, memory_pages_tlb_miss(i) * results->memory_pages_mhz / 1000.0);
+			}
+		}
+		if ((flags & FLAG_MEM_ALLOC) && (results->memory_alloc_size > 0)) {
+			printf("allocator,workload,threads,mops,rss_kib,peak_rss_kib\n");
+			for (i = 0; i < results->memory_alloc_size; i++)
+				for (j = 0; j < ALLOC_WORKLOADS; j++)
+					printf("%s,%s,%d,%.*f,%lu,%lu\n", results->memory_alloc_name, alloc_workload_name(j),
+							results->memory_alloc[i].threads, prec, results->memory_alloc[i].mops[j],
+							results->memory_alloc[i].rss[j], results->memory_alloc_peak);
+		}
+		if ((flags & FLAG_MEM_FAULTS) && (results->memory_fault_size > 0)) {
+			printf("fault_pages,threads,gbps,kfaults_per_sec,munmap_ns\n");
+			for (i = 0; i < results->memory_fault_size; i++)
+				for (j = MEMPAGE_BASE; j <= MEMPAGE_THP; j++)
+					printf("%s,%d,%.*f,%.*f,%.*f\n", memory_page_name(j), results->memory_fault[i].threads, prec,
+							results->memory_fault[i].gbps[j], prec, results->memory_fault[i].faults[j], prec,
+							results->memory_fault[i].unmap);
+			printf("populate_pages,size,lazy_gbps,populated_gbps\n");
+			for (j = 0; j < MEMPAGE_COUNT; j++)
+				printf("%s,%llu,%.*f,%.*f\n", memory_page_name(j), results->memory_fault_region, prec,
+						results->memory_populate[j][0], prec, results->memory_populate[j][1]);
+		}
+		if ((flags & FLAG_MEM_COPY) && (results->memory_copy_size > 0)) {
+			printf("copy_size,function,src_offset,dst_offset,gbps\n");
+			for (i = 0; i < results->memory_copy_size; i++)
+				for (j = 0; j < COPY_FUNCS; j++)
+					for (k = 0; k < COPY_ALIGNS; k++) {
+						copy_align_get(k, &src, &dst);
+						printf("%llu,%s,%d,%d,%.*f\n", results->memory_copy[i].size, copy_func_name(j), src, dst, prec,
+								results->memory_copy[i].gbps[j][k]);
+					}
+		}
+		if (flags & FLAG_DISK_STAT) {
+			printf("operation,size,chunk_size,throughput,cpu_usage\n");
+
+			for (i = 0; i < results->disk_res_size; i++) {
+				if (strncmp(results->disk[i].operation, "File", 4) != 0)
+					printf("%s,%lld,%ld,%.*f,%.*f\n", results->disk[i].operation, results->disk[i].size, results->disk[i].chunk_size,
+							prec, results->disk[i].throughput, prec, results->disk[i].cpu_usage);
+				else {
+					printf("%s,%lld,-,%.*f,%.*f\n", results->disk[i].operation, results->disk[i].size,
+							prec, results->disk[i].throughput, prec, results->disk[i].cpu_usage);
+				}
+			}
+		}
+		if (flags & FLAG_NETC_STAT) {
+			printf("operation,size,chunk_size,throughput,cpu_usage\n");
+
+			for (i = 0; i < results->net_res_size; i++)
+					printf("%s,%lld,%ld,%.*f,%.*f\n", results->net[i].operation, results->net[i].size, results->net[i].chunk_size,
+							prec, results->disk[i].throughput, prec, results->net[i].cpu_usage);
+		}
+		if (flags & FLAG_STEADY)
+			printSteadyResults(type);
+		if (flags & FLAG_REPEAT)
+			printStatsResults(type);
+		if (flags & FLAG_PERF)
+			printPerfResults(type);
+	}
+	else
+	if (type == FORMAT_XML) {
+		printf("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+		printf("<resultset time=\"%.*f\">\n", prec, results->run_time);
+		if (flags & FLAG_TIMER_GET) {
+			printf("\t<timer source=\"%s\" unit=\"ns\">\n", timer_source_name(results->timer_source));
+			if (results->timer_source == TIMER_SOURCE_TSC)
+				printf("\t\t<tsc_frequency unit=\"MHz\">%.*f</tsc_frequency>\n", prec, results->timer_tsc_mhz);
+			printf("\t\t<resolution>%.*f</resolution>\n", prec, results->timer_resolution);
+			printf("\t\t<overhead>%.*f</overhead>\n", prec, results->timer_overhead);
+			printf("\t</timer>\n");
+		}
+		if (flags & FLAG_TOPOLOGY) {
+			tTopology *topo = &results->topology;
+			char level[16];
+
+			printf("\t<topology cpus=\"%d\" packages=\"%d\" cores=\"%d\" threads_per_core=\"%d\" numa_nodes=\"%d\">\n",
+					topo->cpus, topo->packages, topo->cores, topo->smt, topo->nodes);
+			for (i = 0; i < topo->ncaches; i++)
+				printf("\t\t<cache level=\"%d\" type=\"%s\" size=\"%ld\" line_size=\"%d\" ways=\"%d\" shared_cpus=\"%d\" />\n",
+						topo->caches[i].level, topo->caches[i].type, topo->caches[i].size, topo->caches[i].line,
+						topo->caches[i].ways, topo->caches[i].shared);
+			for (i = 0; i < results->topology_sets_size; i++)
+				printf("\t\t<working_set size=\"%llu\" level=\"%s\" />\n", results->topology_sets[i],
+						topology_level_name(results->topology_sets_level[i], level, sizeof(level)));
+			printf("\t</topology>\n");
+		}
+		if ((flags & FLAG_CPU_FREQ) && (results->cpu_freq_cores > 0)) {
+			printf("\t<frequency method=\"%s\" tsc_mhz=\"%.*f\" unit=\"MHz\">\n",
+					cpu_freq_method_name(results->cpu_freq_method), prec, results->cpu_freq_tsc);
+			for (i = 0; i < results->cpu_freq_cores; i++)
+				printf("\t\t<alone cpu=\"%d\">%.*f</alone>\n", results->cpu_freq_cpu[i], prec, results->cpu_freq_single[i]);
+			for (i = 1; i <= results->cpu_freq_loads; i++) {
+				printf("\t\t<loaded cores=\"%d\" average=\"%.*f\">\n", i, prec, cpu_frequency_average(i));
+				for (j = 0; j < i; j++)
+					printf("\t\t\t<core cpu=\"%d\">%.*f</core>\n", results->cpu_freq_cpu[j], prec,
+							results->cpu_freq_load[(i - 1) * results->cpu_freq_cores + j]);
+				printf("\t\t</loaded>\n");
+			}
+			printf("\t</frequency>\n");
+		}
+		if ((flags & FLAG_CPU_C2C) && (results->cpu_c2c_size > 0)) {
+			int n = results->cpu_c2c_size, pairs;
+			float avg;
+
+			printf("\t<c2c cpus=\"%d\" unit=\"ns\">\n", n);
+			for (i = 0; i < n; i++)
+				for (j = i + 1; j < n; j++)
+					if (results->cpu_c2c_lat[i * n + j] > 0.0)
+						printf("\t\t<pair cpu1=\"%d\" cpu2=\"%d\" relation=\"%s\" latency=\"%.*f\" />\n",
+								results->cpu_c2c_cpu[i], results->cpu_c2c_cpu[j],
+								topology_relation_name(results->cpu_c2c_rel[i * n + j]), prec, results->cpu_c2c_lat[i * n + j]);
+			for (i = 0; i < TOPOLOGY_REL_COUNT; i++)
+				if ((avg = cpu_c2c_average(i, &pairs)) > 0.0)
+					printf("\t\t<average relation=\"%s\" pairs=\"%d\">%.*f</average>\n", topology_relation_name(i),
+							pairs, prec, avg);
+			printf("\t</c2c>\n");
+		}
+		if ((flags & FLAG_CPU_SYNC) && (results->cpu_sync_size > 0)) {
+			int p;
+
+			printf("\t<sync unit=\"Mops/s\">\n");
+			for (p = 0; p < SYNC_PRIMITIVES; p++) {
+				printf("\t\t<primitive name=\"%s\">\n", sync_primitive_name(p));
+				for (i = 0; i < results->cpu_sync_size; i++)
+					for (j = 0; j < SYNC_CASES; j++)
+						printf("\t\t\t<run threads=\"%d\" case=\"%s\" throughput=\"%.*f\" fairness=\"%.*f\" />\n",
+								results->cpu_sync[p][i].threads, sync_case_name(j), prec, results->cpu_sync[p][i].mops[j],
+								prec, results->cpu_sync[p][i].fairness[j]);
+				printf("\t\t</primitive>\n");
+			}
+			printf("\t</sync>\n");
+		}
+		if (flags & FLAG_SYSCALL) {
+			int p;
+
+			printf("\t<syscall unit=\"ns\">\n");
+			for (i = 0; i < SYSCALL_CALLS; i++)
+				if (results->sys_call[i] > 0.0)
+					printf("\t\t<call name=\"%s\">%.*f</call>\n", syscall_call_name(i), prec, results->sys_call[i]);
+			for (p = 0; p < 2; p++)
+				for (i = 0; i < CTXSW_PLACEMENTS; i++)
+					if (results->sys_ctxsw[p][i] > 0.0)
+						printf("\t\t<context_switch type=\"%s\" placement=\"%s\" cpu1=\"%d\" cpu2=\"%d\">%.*f</context_switch>\n",
+								syscall_ctxsw_name(p), (i == CTXSW_SAME_CORE) ? "same-core" : "cross-core",
+								results->sys_ctxsw_cpu[0], results->sys_ctxsw_cpu[i + 1], prec, results->sys_ctxsw[p][i]);
+			printf("\t</syscall>\n");
+		}
+		printf("\t<cpu>\n");
+		if (flags & FLAG_CA_GET) {
+			printf("\t\t<num_used>%d</num_used>\n", results->cpus);
+			printf("\t\t<mask>%s</mask>\n", results->cpumask);
+			printf("\t\t<list>%s</list>\n", results->cpulist);
+		}
+		else {
 			printf("\t\t<num_used />\n");
 			printf("\t\t<mask />\n");
+			printf("\t\t<list />\n");
 		}
 		if (flags & FLAG_CPU_GET) {
 			printf("\t\t<total>%d</total>\n", results->cpu_total);
@@ -606,13 +2872,21 @@ void printResults(int flags, int type)
 		else
 			printf("\t\t<speed />\n");
 
+		if (flags & (FLAG_CPU_DHRYSTONE | FLAG_CPU_WHETSTONE | FLAG_CPU_LINPACK))
+			printf("\t\t<kernels>%s</kernels>\n", cpu_isa_name(results->cpu_isa));
 		if (flags & FLAG_CPU_DHRYSTONE)
 			printf("\t\t<dhrystone>%.*f</dhrystone>\n", prec, results->cpu_dhrystone);
 		else
 			printf("\t\t<dhrystone />\n");
 
-		if (flags & FLAG_CPU_WHETSTONE)
+		if (flags & FLAG_CPU_WHETSTONE) {
 			printf("\t\t<whetstone>%ld</whetstone>\n", results->cpu_whetstone);
+			printf("\t\t<whetstone_modules>\n");
+			for (i = 0; i < WHETSTONE_MODULES; i++)
+				printf("\t\t\t<module name=\"%s\" unit=\"%s\">%.*f</module>\n", cpu_whetstone_module_name(i),
+						cpu_whetstone_module_unit(i), prec, results->cpu_whetstone_modules[i]);
+			printf("\t\t</whetstone_modules>\n");
+		}
 		else
 			printf("\t\t<whetstone />\n");
 
@@ -622,6 +2896,29 @@ void printResults(int flags, int type)
 			printf("\t\t\t<min unit=\"MFLOPS\">%.*f</min>\n", prec, results->cpu_linpack_min);
 			printf("\t\t\t<max unit=\"MFLOPS\">%.*f</max>\n", prec, results->cpu_linpack_max);
 			printf("\t\t\t<avg unit=\"MFLOPS\">%.*f</avg>\n", prec, results->cpu_linpack_avg);
+			if (flags & FLAG_CPU_LINPACK_BLK) {
+				printf("\t\t\t<blocked>\n");
+				printf("\t\t\t\t<min unit=\"MFLOPS\">%.*f</min>\n", prec, results->cpu_linpack_blk_min);
+				printf("\t\t\t\t<max unit=\"MFLOPS\">%.*f</max>\n", prec, results->cpu_linpack_blk_max);
+				printf("\t\t\t\t<avg unit=\"MFLOPS\">%.*f</avg>\n", prec, results->cpu_linpack_blk_avg);
+				printf("\t\t\t\t<kernels>%s</kernels>\n", linpack_isa_name(results->cpu_linpack_blk_isa));
+				printf("\t\t\t</blocked>\n");
+			}
+			if (flags & FLAG_CPU_LINPACK_SIMD) {
+				printf("\t\t\t<simd selected=\"%s\">\n", linpack_isa_name(results->cpu_linpack_simd_isa));
+				for (i = 0; i < LINPACK_ISA_COUNT; i++) {
+					if (!linpack_isa_supported(i)) {
+						printf("\t\t\t\t<kernels name=\"%s\" supported=\"false\" />\n", linpack_isa_name(i));
+						continue;
+					}
+					printf("\t\t\t\t<kernels name=\"%s\" supported=\"true\">\n", linpack_isa_name(i));
+					printf("\t\t\t\t\t<min unit=\"MFLOPS\">%.*f</min>\n", prec, results->cpu_linpack_simd_min[i]);
+					printf("\t\t\t\t\t<max unit=\"MFLOPS\">%.*f</max>\n", prec, results->cpu_linpack_simd_max[i]);
+					printf("\t\t\t\t\t<avg unit=\"MFLOPS\">%.*f</avg>\n", prec, results->cpu_linpack_simd_avg[i]);
+					printf("\t\t\t\t</kernels>\n");
+				}
+				printf("\t\t\t</simd>\n");
+			}
 			printf("\t\t</linpack>\n");
 		}
 		else
@@ -633,6 +2930,134 @@ void printResults(int flags, int type)
 		else
 			printf("\t<memory />\n");
 
+		if (flags & FLAG_CPU_DHRY_SCALE)
+			printScaleResults(results->cpu_dhrystone_scale, results->cpu_dhrystone_scale_size,
+						"dhrystone", "DMIPS", 0, NULL, NULL, type);
+		if (flags & FLAG_CPU_WHET_SCALE)
+			printScaleResults(results->cpu_whetstone_scale, results->cpu_whetstone_scale_size,
+						"whetstone", "MIPS", WHETSTONE_MODULES, cpu_whetstone_module_name,
+						cpu_whetstone_module_unit, type);
+		if (flags & FLAG_CPU_LINPACK_SCALE)
+			printScaleResults(results->cpu_linpack_scale, results->cpu_linpack_scale_size,
+						"linpack", "GFLOPS", 0, NULL, NULL, type);
+		if (flags & FLAG_CPU_LINPACK_PREC) {
+			printf("\t<results type=\"linpack_precision\" size=\"%d\" unit=\"GFLOPS\">\n",
+					results->cpu_linpack_prec_arsize);
+			for (i = 0; i < LINPACK_PREC_COUNT; i++)
+				printf("\t\t<result precision=\"%s\" score=\"%.*f\" residual=\"%g\" refinement_steps=\"%d\" />\n",
+						linpack_precision_name(i), prec, results->cpu_linpack_prec_gflops[i],
+						results->cpu_linpack_prec_residual[i], results->cpu_linpack_prec_iters[i]);
+			printf("\t</results>\n");
+		}
+		if (flags & FLAG_CPU_LINPACK_SWEEP) {
+			char trans[16];
+
+			printf("\t<results type=\"linpack_sweep\" unit=\"MFLOPS\">\n");
+			for (i = 0; i < results->cpu_linpack_sweep_size; i++) {
+				printf("\t\t<point size=\"%d\" working_set=\"%llu\" score=\"%.*f\" level=\"%s\"",
+						results->cpu_linpack_sweep[i].size, results->cpu_linpack_sweep[i].wset, prec,
+						results->cpu_linpack_sweep[i].mflops, linpack_level_name(results->cpu_linpack_sweep[i].level));
+				if (linpack_sweep_transition(i, trans, sizeof(trans)) != NULL)
+					printf(" transition=\"%s\"", trans);
+				printf(" />\n");
+			}
+			printf("\t</results>\n");
+		}
+		if (flags & FLAG_CPU_ISA)
+			printCpuIsaResults(type);
+		if (flags & FLAG_MEM_BANDWIDTH) {
+			char name[64];
+
+			for (j = 0; j < MEMBW_MODES; j++)
+				for (i = 0; i < MEMBW_KERNELS; i++)
+					printScaleResults(results->memory_bw_scale[j][i], results->memory_bw_scale_size[j],
+								memory_bandwidth_name(j, i, type, name, sizeof(name)), "GB/s", 0, NULL, NULL, type);
+		}
+		if (flags & FLAG_MEM_LATENCY) {
+			printf("\t<results type=\"memory_latency\" unit=\"ns\" mhz=\"%.*f\">\n", prec, results->memory_lat_mhz);
+			for (i = 0; i < results->memory_lat_size; i++)
+				for (j = 0; j < MEMPAGE_COUNT; j++)
+					if (results->memory_lat[i].ns[j] > 0.0)
+						printf("\t\t<point size=\"%llu\" pages=\"%s\" score=\"%.*f\" cycles=\"%.*f\" />\n",
+								results->memory_lat[i].size, memory_page_name(j), prec, results->memory_lat[i].ns[j],
+								prec, results->memory_lat[i].ns[j] * results->memory_lat_mhz / 1000.0);
+			printf("\t</results>\n");
+		}
+		if (flags & FLAG_MEM_NUMA) {
+			int n = results->memory_numa_size;
+
+			printf("\t<results type=\"numa\" array_size=\"%llu\">\n", results->memory_numa_arsize);
+			for (i = 0; i < n; i++)
+				for (j = 0; j < n; j++)
+					if (results->memory_numa_bw[i * n + j] > 0.0)
+						printf("\t\t<pair cpu_node=\"%d\" memory_node=\"%d\" bandwidth=\"%.*f\" latency=\"%.*f\" />\n",
+								results->memory_numa_node[i], results->memory_numa_node[j], prec,
+								results->memory_numa_bw[i * n + j], prec, results->memory_numa_lat[i * n + j]);
+			printf("\t</results>\n");
+		}
+		if (flags & FLAG_MEM_PAGES) {
+			printf("\t<results type=\"memory_pages\" array_size=\"%llu\" linpack_size=\"%d\" mhz=\"%.*f\">\n",
+					results->memory_pages_arsize, results->memory_pages_lpsize, prec, results->memory_pages_mhz);
+			for (i = 0; i < MEMPAGE_COUNT; i++) {
+				if (results->memory_pages_err[i] != 0) {
+					printf("\t\t<pages type=\"%s\" error=\"%s\" />\n", memory_page_name(i),
+							strerror(-results->memory_pages_err[i]));
+					continue;
+				}
+				printf("\t\t<pages type=\"%s\" latency=\"%.*f\" bandwidth=\"%.*f\" linpack=\"%.*f\"", memory_page_name(i),
+						prec, results->memory_pages_lat[i], prec, results->memory_pages_bw[i], prec, results->memory_pages_linpack[i]);
+				if (i != MEMPAGE_BASE)
+					printf(" latency_speedup=\"%.*f\" bandwidth_speedup=\"%.*f\" linpack_speedup=\"%.*f\" tlb_miss_ns=\"%.*f\""
+							" tlb_miss_cycles=\"%.*f\"", prec, memory_pages_speedup(results->memory_pages_lat, i, 1),
+							prec, memory_pages_speedup(results->memory_pages_bw, i, 0),
+							prec, memory_pages_speedup(results->memory_pages_linpack, i, 0), prec, memory_pages_tlb_miss(i),
+							prec, memory_pages_tlb_miss(i) * results->memory_pages_mhz / 1000.0);
+				printf(" />\n");
+			}
+			printf("\t</results>\n");
+		}
+		if ((flags & FLAG_MEM_ALLOC) && (results->memory_alloc_size > 0)) {
+			printf("\t<results type=\"memory_alloc\" allocator=\"%s\" peak_rss=\"%lu\" unit=\"Mops/s\">\n",
+					results->memory_alloc_name, results->memory_alloc_peak);
+			for (i = 0; i < results->memory_alloc_size; i++)
+				for (j = 0; j < ALLOC_WORKLOADS; j++)
+					printf("\t\t<run workload=\"%s\" threads=\"%d\" throughput=\"%.*f\" rss=\"%lu\" />\n",
+							alloc_workload_name(j), results->memory_alloc[i].threads, prec, results->memory_alloc[i].mops[j],
+							results->memory_alloc[i].rss[j]);
+			printf("\t</results>\n");
+		}
+		if ((flags & FLAG_MEM_FAULTS) && (results->memory_fault_size > 0)) {
+			printf("\t<results type=\"memory_faults\" unit=\"GB/s\">\n");
+			for (i = 0; i < results->memory_fault_size; i++) {
+				printf("\t\t<threads num=\"%d\" munmap=\"%.*f\">\n", results->memory_fault[i].threads, prec,
+						results->memory_fault[i].unmap);
+				for (j = MEMPAGE_BASE; j <= MEMPAGE_THP; j++)
+					if (results->memory_fault_err[j] == 0)
+						printf("\t\t\t<fault pages=\"%s\" throughput=\"%.*f\" kfaults=\"%.*f\" />\n", memory_page_name(j),
+								prec, results->memory_fault[i].gbps[j], prec, results->memory_fault[i].faults[j]);
+				printf("\t\t</threads>\n");
+			}
+			for (j = 0; j < MEMPAGE_COUNT; j++)
+				printf("\t\t<populate pages=\"%s\" size=\"%llu\" lazy=\"%.*f\" populated=\"%.*f\" />\n",
+						memory_page_name(j), results->memory_fault_region, prec, results->memory_populate[j][0], prec,
+						results->memory_populate[j][1]);
+			printf("\t</results>\n");
+		}
+		if ((flags & FLAG_MEM_COPY) && (results->memory_copy_size > 0)) {
+			printf("\t<results type=\"memory_copy\" unit=\"GB/s\">\n");
+			for (i = 0; i < results->memory_copy_size; i++) {
+				printf("\t\t<block size=\"%llu\">\n", results->memory_copy[i].size);
+				for (j = 0; j < COPY_FUNCS; j++)
+					for (k = 0; k < COPY_ALIGNS; k++) {
+						copy_align_get(k, &src, &dst);
+						printf("\t\t\t<copy function=\"%s\" src_offset=\"%d\" dst_offset=\"%d\">%.*f</copy>\n",
+								copy_func_name(j), src, dst, prec, results->memory_copy[i].gbps[j][k]);
+					}
+				printf("\t\t</block>\n");
+			}
+			printf("\t</results>\n");
+		}
+
 		if (flags & FLAG_DISK_STAT) {
 			printf("\t<results type=\"disk\" can_drop_caches=\"%d\">\n", results->disk_drop_caches);
 
@@ -653,6 +3078,12 @@ void printResults(int flags, int type)
 
 			printf("\t</results>\n");
 		}
+		if (flags & FLAG_STEADY)
+			printSteadyResults(type);
+		if (flags & FLAG_REPEAT)
+			printStatsResults(type);
+		if (flags & FLAG_PERF)
+			printPerfResults(type);
 
 		printf("</resultset>\n");
 	}
@@ -662,7 +3093,8 @@ void printResults(int flags, int type)
 
 int main(int argc, char *argv[])
 {
-	int flags;
+	unsigned long long flags;
+	int i, j;
 	unsigned long long start = 0;
 
 	start = nanotime();
@@ -676,8 +3108,42 @@ int main(int argc, char *argv[])
 		return 1;
 	}
 
+	if (flags & FLAG_PERF) {
+		int err;
+
+		if ((err = perf_open(&perf)) < 0) {
+			fprintf(stderr, "Warning: Performance counters are not available (%s), running without them\n",
+					strerror(-err));
+			results->perf_err = err;
+		}
+		else
+			perfOn = 1;
+	}
+
+	if (timerSrc != TIMER_SOURCE_AUTO)
+		if (timer_init(timerSrc) != timerSrc)
+			fprintf(stderr, "Warning: Timer source %s cannot be used, falling back to %s\n",
+					timer_source_name(timerSrc), timer_source_name(TIMER_SOURCE_CLOCK));
+	if (flags & FLAG_TIMER_GET) {
+		results->timer_source = timer_info_get(&results->timer_resolution, &results->timer_overhead,
+					&results->timer_tsc_mhz);
+
+		DPRINTF("Timer: %s, resolution %.*f ns, overhead %.*f ns\n", timer_source_name(results->timer_source),
+				prec, results->timer_resolution, prec, results->timer_overhead);
+	}
+	results->cpu_isa = cpu_isa_best();
+	if (cpuIsa >= 0) {
+		if (cpu_isa_supported(cpuIsa))
+			results->cpu_isa = cpuIsa;
+		else
+			fprintf(stderr, "Warning: CPU kernels %s are not supported, falling back to %s\n", cpu_isa_name(cpuIsa),
+					cpu_isa_name(results->cpu_isa));
+	}
+
 	if (flags & FLAG_CA_GET)
 		get_affinity();
+	if (flags & FLAG_TOPOLOGY)
+		topology_process();
 	if (flags & FLAG_CPU_GET) {
 		uint32_t proc;
 		proc = cpu_get_count();
@@ -689,33 +3155,75 @@ int main(int argc, char *argv[])
 				PROCESSOR_COUNT_ONLINE(proc));
 	}
 	if (flags & FLAG_CPU_SPEED) {
-		results->cpu_speed = cpu_get_speed_mhz();
+		double speed;
+
+		repeat_run("cpu_speed", "MHz", repeat_cpu_speed, NULL, 1, NULL, NULL, &speed);
+		results->cpu_speed = speed;
 
-		DPRINTF("Measured CPU Speed is: %.*f Mhz\n", prec, cpu_get_speed_mhz());
+		DPRINTF("Measured CPU Speed is: %.*f Mhz\n", prec, results->cpu_speed);
 	}
+	if (flags & FLAG_CPU_FREQ)
+		cpu_frequency_process(freqCores);
+	if (flags & FLAG_CPU_C2C)
+		cpu_c2c_process(c2cCpus);
+	if (flags & FLAG_CPU_SYNC)
+		cpu_sync_process(syncThreads);
+	if (flags & FLAG_SYSCALL)
+		syscall_process();
 	if (flags & FLAG_CPU_DHRYSTONE) {
-		unsigned long dhrystone, loops, btime;
-		cpu_dhrystone_get(&dhrystone, &loops, &btime);
+		unsigned long dhry[3] = { 0 };
+		double dmips = 0.0;
+		int runs;
 
-		results->cpu_dhrystone = (float)dhrystone / 1757;
+		perf_region_start();
+		runs = repeat_run("dhrystone", "DMIPS", repeat_dhrystone, dhry, 1, NULL, NULL, &dmips);
+		perf_region_stop("dhrystone", "-", 0, dhry[1] * (runs > 0 ? runs : 1), "loop");
 
-		DPRINTF("Dhrystone: %.*f DMIPS(*), loops: %lu, benchmark time: %ld\n", prec, (float)dhrystone / 1757, loops, btime);
-		DPRINTF("* Calculated as dhrystone store divided by 1757 (see: http://en.wikipedia.org/wiki/Dhrystone)\n");
+		results->cpu_dhrystone = dmips;
+
+		DPRINTF("Dhrystone: %.*f DMIPS(*), loops: %lu, benchmark time: %ld\n", prec, results->cpu_dhrystone, dhry[1], dhry[2]);
+		DPRINTF("* Calculated as dhrystone store divided by %d (see: http://en.wikipedia.org/wiki/Dhrystone)\n", DHRYSTONE_VAX_SCORE);
 	}
+	if (flags & FLAG_CPU_DHRY_SCALE)
+		cpu_dhrystone_scale_process(dhryThreads);
 	if (flags & FLAG_CPU_WHETSTONE) {
-		unsigned long loops, iter, btime, mips;
+		unsigned long whet[4] = { 0 };
+		double values[WHETSTONE_MODULES + 1] = { 0 };
+		int runs;
 
-		cpu_whetstone_get(&loops, &iter, &btime, &mips);
+		perf_region_start();
+		runs = repeat_run("whetstone", "MIPS", repeat_whetstone, whet, WHETSTONE_MODULES + 1, cpu_whetstone_module_name,
+					cpu_whetstone_module_unit, values);
+		perf_region_stop("whetstone", "-", 0, whet[0] * whet[1] * (runs > 0 ? runs : 1), "loop");
 
-		results->cpu_whetstone = mips;
+		results->cpu_whetstone = values[0];
+		for (i = 0; i < WHETSTONE_MODULES; i++)
+			results->cpu_whetstone_modules[i] = values[i + 1];
 
-		DPRINTF("Whetstone: %lu MIPS, loops: %lu, iteration count: %ld, benchmark time: %ld sec\n", mips, loops, iter, btime);
+		DPRINTF("Whetstone: %ld MIPS, loops: %lu, iteration count: %ld, benchmark time: %ld sec\n", results->cpu_whetstone,
+				whet[0], whet[1], whet[2]);
 	}
+	if (flags & FLAG_CPU_WHET_SCALE)
+		cpu_whetstone_scale_process(whetThreads);
 	if (flags & FLAG_CPU_LINPACK) {
 		unsigned long memory;
 		float minMFLOPS, maxMFLOPS, avgMFLOPS;
+		tLinpackRun lp;
+		double avg = 0.0;
+
+		if (lpArrSize <= 0)
+			lpArrSize = linpack_size_auto();
 
-		get_linpack_score(lpArrSize, &memory, &minMFLOPS, &maxMFLOPS, &avgMFLOPS);
+		memset(&lp, 0, sizeof(lp));
+		lp.arsize = lpArrSize;
+		perf_region_start();
+		repeat_run("linpack", "MFLOPS", repeat_linpack, &lp, 1, NULL, NULL, &avg);
+		perf_region_stop("linpack", "-", 0, 0, NULL);
+
+		memory = lp.memory;
+		minMFLOPS = lp.min;
+		maxMFLOPS = lp.max;
+		avgMFLOPS = avg;
 
 		results->cpu_linpack_size = lpArrSize;
 		results->cpu_linpack_mem = memory;
@@ -726,29 +3234,117 @@ int main(int argc, char *argv[])
 		DPRINTF("Linpack array size: %dx%d, memory %ld KB, MFLOPS: min=%.*f, max=%.*f, average=%.*f\n", lpArrSize, lpArrSize,
 				memory >> 10, prec, minMFLOPS, prec, maxMFLOPS, prec, avgMFLOPS);
 		DPRINTF("* For more information about LINPACK benchmarking see http://en.wikipedia.org/wiki/Linpack\n");
+
+		if (flags & FLAG_CPU_LINPACK_BLK) {
+			get_linpack_blocked_score(lpArrSize, &memory, &minMFLOPS, &maxMFLOPS, &avgMFLOPS);
+
+			results->cpu_linpack_blk_min = minMFLOPS;
+			results->cpu_linpack_blk_max = maxMFLOPS;
+			results->cpu_linpack_blk_avg = avgMFLOPS;
+			results->cpu_linpack_blk_isa = linpack_isa_best();
+
+			DPRINTF("Blocked Linpack array size: %dx%d, MFLOPS: min=%.*f, max=%.*f, average=%.*f\n", lpArrSize, lpArrSize,
+					prec, minMFLOPS, prec, maxMFLOPS, prec, avgMFLOPS);
+		}
+		if (flags & FLAG_CPU_LINPACK_SIMD) {
+			int isa;
+
+			results->cpu_linpack_simd_isa = linpack_isa_best();
+			for (isa = 0; isa < LINPACK_ISA_COUNT; isa++) {
+				if (!get_linpack_simd_score(isa, lpArrSize, &memory, &minMFLOPS, &maxMFLOPS, &avgMFLOPS)) {
+					DPRINTF("Linpack SIMD kernels %s are not supported on this CPU\n", linpack_isa_name(isa));
+					continue;
+				}
+
+				results->cpu_linpack_simd_min[isa] = minMFLOPS;
+				results->cpu_linpack_simd_max[isa] = maxMFLOPS;
+				results->cpu_linpack_simd_avg[isa] = avgMFLOPS;
+
+				DPRINTF("Linpack SIMD kernels %s, MFLOPS: min=%.*f, max=%.*f, average=%.*f\n", linpack_isa_name(isa),
+						prec, minMFLOPS, prec, maxMFLOPS, prec, avgMFLOPS);
+			}
+		}
 	}
+	if (flags & FLAG_CPU_LINPACK_SCALE)
+		cpu_linpack_scale_process(lpThreads, lpArrSize);
+	if (flags & FLAG_CPU_LINPACK_PREC)
+		cpu_linpack_precision_process(lpArrSize);
+	if (flags & FLAG_CPU_LINPACK_SWEEP)
+		cpu_linpack_sweep_process(lpSweepPct);
+	if (flags & FLAG_CPU_ISA)
+		cpu_isa_process(lpArrSize);
 	if (flags & FLAG_MEM_GET) {
 		results->memory_size = memory_size_get(MEMTYPE_B);
 
 		DPRINTF("Physical memory size: %.*f MB\n", prec, memory_size_get(MEMTYPE_MB));
 	}
+	if (flags & FLAG_MEM_BANDWIDTH)
+		memory_bandwidth_process(membwThreads, membwSize);
+	if (flags & FLAG_MEM_LATENCY)
+		memory_latency_process(memlatSize);
+	if (flags & FLAG_MEM_NUMA)
+		memory_numa_process(membwSize);
+	if (flags & FLAG_MEM_PAGES)
+		memory_pages_process(membwSize, lpArrSize);
+	if (flags & FLAG_MEM_ALLOC)
+		memory_alloc_process(allocThreads);
+	if (flags & FLAG_MEM_FAULTS)
+		memory_faults_process(faultThreads);
+	if (flags & FLAG_MEM_COPY)
+		memory_copy_process(copySize);
 	if (flags & FLAG_DISK_STAT)
 		disk_io_process( dioBufSize, 131072 );
 	if (flags & FLAG_NETS_STAT)
 		net_io_process( 1 );
 	if (flags & FLAG_NETC_STAT)
 		net_io_process( 0 );
+	if (flags & FLAG_STEADY)
+		steady_process(steadyTime, (flags & FLAG_DISK_STAT) ? dioBufSize : 0);
 
-	results->run_time = (nanotime() - start) / 1000000.0;
-	DPRINTF("Run finished in %.*f seconds\n", prec, (nanotime() - start) / 1000000.0);
+	results->run_time = (nanotime() - start) / (float)NSEC_PER_SEC;
+	DPRINTF("Run finished in %.*f seconds\n", prec, results->run_time);
 
 	printResults(flags, outType);
 
 	/* Free all the memory for results */
+	if (perfOn)
+		perf_close(&perf);
+	free(results->perf);
+	free(results->stats);
+	steady_results_free(&results->steady_cpu);
+	steady_results_free(&results->steady_disk);
 	if (results->disk_res_size > 0)
 		free(results->disk);
 	if (results->net_res_size > 0)
 		free(results->net);
+	if (results->cpu_dhrystone_scale != NULL)
+		scale_results_free(results->cpu_dhrystone_scale, results->cpu_dhrystone_scale_size);
+	if (results->cpu_whetstone_scale != NULL)
+		scale_results_free(results->cpu_whetstone_scale, results->cpu_whetstone_scale_size);
+	if (results->cpu_linpack_scale != NULL)
+		scale_results_free(results->cpu_linpack_scale, results->cpu_linpack_scale_size);
+	for (i = 0; i < MEMBW_MODES; i++)
+		for (j = 0; j < MEMBW_KERNELS; j++)
+			if (results->memory_bw_scale[i][j] != NULL)
+				scale_results_free(results->memory_bw_scale[i][j], results->memory_bw_scale_size[i]);
+	free(results->cpumask);
+	free(results->cpulist);
+	free(results->cpu_freq_cpu);
+	free(results->cpu_freq_single);
+	free(results->cpu_freq_load);
+	free(results->cpu_c2c_cpu);
+	free(results->cpu_c2c_rel);
+	free(results->cpu_c2c_lat);
+	for (i = 0; i < SYNC_PRIMITIVES; i++)
+		free(results->cpu_sync[i]);
+	free(results->cpu_linpack_sweep);
+	free(results->memory_lat);
+	free(results->memory_alloc);
+	free(results->memory_fault);
+	free(results->memory_copy);
+	free(results->memory_numa_node);
+	free(results->memory_numa_bw);
+	free(results->memory_numa_lat);
 	free(results);
 
 	return 0;
@@ -22,6 +22,91 @@
  */
 
 #include "utils.h"
+#include <sys/mman.h>
+
+/* Non-temporal stores are available on x86 with SSE2 only */
+#ifdef __SSE2__
+#define MEMBW_STREAM_STORES
+#include <emmintrin.h>
+#endif
+
+/* Number of the repetitions of every kernel, the best one is reported as in STREAM */
+#define MEMBW_NTIMES			10
+/* Minimal size of one array in bytes */
+#define MEMBW_MIN_SIZE			(64ULL << 20)
+/* Elements of every thread's chunk are aligned to the cache line */
+#define MEMBW_ALIGN				8
+#define MEMBW_SCALAR			3.0
+
+/* Keeps gcc from replacing the Copy loop by the memcpy() call which may use non-temporal stores on its own */
+#if defined(__GNUC__) && !defined(__clang__)
+#define MEMBW_NO_MEMCPY			__attribute__((optimize("no-tree-loop-distribute-patterns")))
+#else
+#define MEMBW_NO_MEMCPY
+#endif
+
+/* Size of one node of the pointer-chasing ring, one cache line */
+#define MEMLAT_LINE				64
+/* Minimal time of one latency measurement in nanoseconds */
+#define MEMLAT_MIN_TIME			50000000ULL
+/* Alignment and size granularity of the mappings backed by huge pages */
+#define MEMPAGE_HUGE_SIZE		(2UL << 20)
+
+/* Memory policy of mbind(), defined here to not depend on libnuma headers */
+#ifndef MPOL_BIND
+#define MPOL_BIND				2
+#endif
+#ifndef MPOL_MF_STRICT
+#define MPOL_MF_STRICT			(1 << 0)
+#endif
+#define MEMNODE_MAX				64
+#define MEMNODE_SYSFS			"/sys/devices/system/node"
+
+/* Size of the region faulted in by every thread, all the regions take a quarter of the memory at most */
+#define MEMFAULT_SIZE			(64UL << 20)
+#define MEMFAULT_PAGE			4096
+#define MEMFAULT_REPEAT			3
+/* Unmaps of the touched region measured and the size of the region */
+#define MEMFAULT_UNMAPS			1000
+#define MEMFAULT_UNMAP_SIZE		(16 * MEMFAULT_PAGE)
+
+static const char *membwKernelNames[] = { "Copy", "Scale", "Add", "Triad" };
+/* Number of the arrays accessed by the kernel, i.e. STREAM bytes per element divided by sizeof(double) */
+static const int membwKernelArrays[] = { 2, 2, 3, 3 };
+
+static const char *memPageNames[] = { "4K", "THP", "HugeTLB" };
+
+/* Keeps the result of the pointer chase alive so the loads cannot be optimized out */
+void * volatile memlatSink;
+
+typedef struct {
+	double *a;
+	double *b;
+	double *c;
+	long n;
+	int nt;
+	int node;
+	unsigned long long *start;				/* start and end time of the kernel in every thread */
+	unsigned long long *end;
+	unsigned long long time[MEMBW_KERNELS];	/* best wall time of all threads */
+} tMemBandwidth;
+
+typedef struct {
+	tThread thread;
+	tMemBandwidth *bw;
+	long first;
+	long last;
+	unsigned long long time[MEMBW_KERNELS];	/* best time of this thread */
+} tMemBandwidthThread;
+
+typedef struct {
+	tThread thread;
+	int pages;
+	size_t size;
+	int *stop;
+	unsigned long long ns;
+	int err;
+} tMemFaultThread;
 
 float memory_size_get(int type)
 {
@@ -72,3 +157,697 @@ void memory_display(char *address, int length) {
 	puts("");
 }
 
+
+MEMBW_NO_MEMCPY
+static void membw_kernel(int kernel, double *a, double *b, double *c, long first, long last)
+{
+	long i;
+
+	switch (kernel) {
+		case MEMBW_COPY:
+					for (i = first; i < last; i++)
+						c[i] = a[i];
+					break;
+		case MEMBW_SCALE:
+					for (i = first; i < last; i++)
+						b[i] = MEMBW_SCALAR * c[i];
+					break;
+		case MEMBW_ADD:
+					for (i = first; i < last; i++)
+						c[i] = a[i] + b[i];
+					break;
+		case MEMBW_TRIAD:
+					for (i = first; i < last; i++)
+						a[i] = b[i] + MEMBW_SCALAR * c[i];
+					break;
+	}
+}
+
+/* The same kernels writing around the caches, the chunks have to be aligned to 16 bytes */
+static void membw_kernel_nt(int kernel, double *a, double *b, double *c, long first, long last)
+{
+#ifdef MEMBW_STREAM_STORES
+	__m128d s = _mm_set1_pd(MEMBW_SCALAR);
+	long i;
+
+	switch (kernel) {
+		case MEMBW_COPY:
+					for (i = first; i < last; i += 2)
+						_mm_stream_pd(&c[i], _mm_load_pd(&a[i]));
+					break;
+		case MEMBW_SCALE:
+					for (i = first; i < last; i += 2)
+						_mm_stream_pd(&b[i], _mm_mul_pd(s, _mm_load_pd(&c[i])));
+					break;
+		case MEMBW_ADD:
+					for (i = first; i < last; i += 2)
+						_mm_stream_pd(&c[i], _mm_add_pd(_mm_load_pd(&a[i]), _mm_load_pd(&b[i])));
+					break;
+		case MEMBW_TRIAD:
+					for (i = first; i < last; i += 2)
+						_mm_stream_pd(&a[i], _mm_add_pd(_mm_load_pd(&b[i]), _mm_mul_pd(s, _mm_load_pd(&c[i]))));
+					break;
+	}
+	_mm_sfence();
+#else
+	membw_kernel(kernel, a, b, c, first, last);
+#endif
+}
+
+static void *memory_bandwidth_thread(void *arg)
+{
+	tMemBandwidthThread *t = (tMemBandwidthThread *)arg;
+	tMemBandwidth *bw = t->bw;
+	unsigned long long tm, tt;
+	int i, k, rep, idx;
+	long j;
+
+	idx = t->thread.idx;
+
+	/* First touch by the thread running the kernel places the pages on its NUMA node */
+	for (j = t->first; j < t->last; j++) {
+		bw->a[j] = 1.0;
+		bw->b[j] = 2.0;
+		bw->c[j] = 0.0;
+	}
+
+	for (k = 0; k < MEMBW_KERNELS; k++)
+		t->time[k] = ~0ULL;
+
+	for (rep = 0; rep < MEMBW_NTIMES; rep++) {
+		for (k = 0; k < MEMBW_KERNELS; k++) {
+			pthread_barrier_wait(t->thread.barrier);
+			bw->start[idx] = nanotime();
+
+			if (bw->nt)
+				membw_kernel_nt(k, bw->a, bw->b, bw->c, t->first, t->last);
+			else
+				membw_kernel(k, bw->a, bw->b, bw->c, t->first, t->last);
+
+			bw->end[idx] = nanotime();
+			pthread_barrier_wait(t->thread.barrier);
+
+			/* The first repetition only warms up the caches and TLBs */
+			if (rep == 0)
+				continue;
+			if (bw->end[idx] - bw->start[idx] < t->time[k])
+				t->time[k] = bw->end[idx] - bw->start[idx];
+			if (idx != 0)
+				continue;
+
+			/* The threads may not run all at once so the overall time spans from the first start to the last end */
+			tm = bw->start[0];
+			tt = bw->end[0];
+			for (i = 1; i < t->thread.num; i++) {
+				if (bw->start[i] < tm)
+					tm = bw->start[i];
+				if (bw->end[i] > tt)
+					tt = bw->end[i];
+			}
+			if (tt - tm < bw->time[k])
+				bw->time[k] = tt - tm;
+		}
+	}
+
+	return NULL;
+}
+
+/*
+ * Returns the default size of one array, four times the size of the last level cache as STREAM requires
+ * but at least MEMBW_MIN_SIZE. All the three arrays never take more than a quarter of the physical memory.
+ */
+unsigned long long memory_bandwidth_size_default(void)
+{
+	unsigned long long size, maxsize;
+	int level;
+
+	size = MEMBW_MIN_SIZE;
+	for (level = 3; level > 0; level--)
+		if (cpu_cache_size_get(level) > 0) {
+			if (4ULL * cpu_cache_size_get(level) > size)
+				size = 4ULL * cpu_cache_size_get(level);
+			break;
+		}
+
+	maxsize = (unsigned long long)memory_size_get(MEMTYPE_B) / 12;
+	if ((maxsize > 0) && (size > maxsize))
+		size = maxsize;
+
+	return size;
+}
+
+/*
+ * Runs the STREAM Copy, Scale, Add and Triad kernels in threads pinned threads on three arrays of size bytes
+ * each, with non-temporal stores when nt is set. Every thread first touches and then works on its own chunk
+ * of the arrays. The arrays are mapped in the pages of type pages and bound to the NUMA node when it's not -1.
+ * The best bandwidth of each thread is stored to gbps[] as threads x MEMBW_KERNELS values,
+ * the CPU it was running on to cpus[] and the best overall bandwidth of each kernel to total[], all in GB/s.
+ */
+int memory_bandwidth_get(int threads, int nt, unsigned long long size, int pages, int node, int *cpus, float *gbps,
+			float *total)
+{
+	tMemBandwidthThread *t;
+	tMemBandwidth bw;
+	size_t memreq, mapped;
+	void *pool;
+	long chunk;
+	int i, k, rc;
+
+	if ((threads <= 0) || (size == 0))
+		return -EINVAL;
+
+	memset(&bw, 0, sizeof(bw));
+	bw.n = size / sizeof(double);
+	bw.n -= bw.n % (threads * MEMBW_ALIGN);
+	bw.nt = nt;
+	if (bw.n == 0)
+		return -EINVAL;
+
+	memreq = 3 * bw.n * sizeof(double);
+	if ((pool = memory_map(memreq, pages, node, &mapped)) == NULL)
+		return -errno;
+
+	t = (tMemBandwidthThread *)malloc( threads * sizeof(tMemBandwidthThread) );
+	bw.start = (unsigned long long *)malloc( threads * sizeof(unsigned long long) );
+	bw.end = (unsigned long long *)malloc( threads * sizeof(unsigned long long) );
+	if ((t == NULL) || (bw.start == NULL) || (bw.end == NULL)) {
+		free(t);
+		free(bw.start);
+		free(bw.end);
+		munmap(pool, mapped);
+		return -ENOMEM;
+	}
+
+	bw.a = (double *)pool;
+	bw.b = bw.a + bw.n;
+	bw.c = bw.b + bw.n;
+	for (k = 0; k < MEMBW_KERNELS; k++)
+		bw.time[k] = ~0ULL;
+
+	chunk = bw.n / threads;
+	memset(t, 0, threads * sizeof(tMemBandwidthThread));
+	for (i = 0; i < threads; i++) {
+		t[i].bw = &bw;
+		t[i].first = i * chunk;
+		t[i].last = (i + 1) * chunk;
+	}
+
+	rc = cpu_threads_run(threads, memory_bandwidth_thread, t, sizeof(tMemBandwidthThread));
+	munmap(pool, mapped);
+
+	if (rc == 0) {
+		for (i = 0; i < threads; i++) {
+			if (cpus != NULL)
+				cpus[i] = t[i].thread.cpu;
+			for (k = 0; (gbps != NULL) && (k < MEMBW_KERNELS); k++)
+				gbps[i * MEMBW_KERNELS + k] = (double)membwKernelArrays[k] * chunk * sizeof(double) / t[i].time[k];
+		}
+		for (k = 0; (total != NULL) && (k < MEMBW_KERNELS); k++)
+			total[k] = (double)membwKernelArrays[k] * bw.n * sizeof(double) / bw.time[k];
+	}
+
+	free(bw.start);
+	free(bw.end);
+	free(t);
+	return rc;
+}
+
+const char *memory_bandwidth_kernel_name(int kernel)
+{
+	if ((kernel < 0) || (kernel >= MEMBW_KERNELS))
+		return NULL;
+
+	return membwKernelNames[kernel];
+}
+
+/* Returns the mask of the online NUMA nodes, node 0 only when the kernel has no NUMA support */
+int memory_nodes_get(uint64_t *mask)
+{
+	char buf[256];
+	tCpuSet nodes;
+	FILE *fp;
+	int i, num;
+
+	*mask = 1;
+	if ((fp = fopen(MEMNODE_SYSFS "/online", "r")) == NULL)
+		return 1;
+
+	if ((num = cpu_set_init(&nodes, MEMNODE_MAX)) == 0) {
+		num = (fgets(buf, sizeof(buf), fp) != NULL) ? cpu_list_parse(buf, &nodes) : -EINVAL;
+
+		/* The node list is parsed as the CPU list, the nodes have to fit the mask */
+		if ((num > 0) && (cpu_set_next(&nodes, MEMNODE_MAX - 1) >= 0))
+			num = -EINVAL;
+
+		*mask = 0;
+		for (i = 0; (num > 0) && (i < MEMNODE_MAX); i++)
+			if (cpu_set_isset(&nodes, i))
+				*mask |= (uint64_t)1 << i;
+		cpu_set_free(&nodes);
+	}
+	fclose(fp);
+
+	return num;
+}
+
+/*
+ * Gets the set of the CPUs of the NUMA node and returns their number. The set is allocated here and has to be
+ * freed by cpu_set_free() when the number is not negative.
+ */
+int memory_node_cpus(int node, tCpuSet *cpus)
+{
+	char path[256], buf[4096];
+	FILE *fp;
+	int num;
+
+	snprintf(path, sizeof(path), MEMNODE_SYSFS "/node%d/cpulist", node);
+	if ((fp = fopen(path, "r")) == NULL) {
+		if (node != 0)
+			return -errno;
+
+		/* No NUMA support, all the CPUs are on node 0 */
+		return cpu_affinity_get(getpid(), cpus);
+	}
+
+	if ((num = cpu_set_init(cpus, 0)) == 0) {
+		num = (fgets(buf, sizeof(buf), fp) != NULL) ? cpu_list_parse(buf, cpus) : 0;
+		if (num < 0)
+			cpu_set_free(cpus);
+	}
+	fclose(fp);
+
+	return num;
+}
+
+/* Returns the size of the memory of the NUMA node in bytes */
+unsigned long long memory_node_size(int node)
+{
+	char path[256], buf[256];
+	unsigned long long size = 0;
+	FILE *fp;
+
+	snprintf(path, sizeof(path), MEMNODE_SYSFS "/node%d/meminfo", node);
+	if ((fp = fopen(path, "r")) == NULL)
+		return (node == 0) ? (unsigned long long)memory_size_get(MEMTYPE_B) : 0;
+
+	while (fgets(buf, sizeof(buf), fp) != NULL)
+		if (strstr(buf, "MemTotal:") != NULL) {
+			size = strtoull(strstr(buf, "MemTotal:") + 9, NULL, 10) << 10;
+			break;
+		}
+	fclose(fp);
+
+	return size;
+}
+
+/*
+ * Binds the memory range to the NUMA node using the mbind() system call directly so no libnuma is needed.
+ * The range must not be touched yet, the pages are then allocated on the node on the first touch.
+ */
+int memory_node_bind(void *addr, size_t len, int node)
+{
+#ifdef SYS_mbind
+	unsigned long nodemask[MEMNODE_MAX / (8 * sizeof(unsigned long))] = { 0 };
+
+	if ((node < 0) || (node >= MEMNODE_MAX))
+		return -EINVAL;
+
+	nodemask[node / (8 * sizeof(unsigned long))] |= 1UL << (node % (8 * sizeof(unsigned long)));
+	if (syscall(SYS_mbind, addr, len, MPOL_BIND, nodemask, MEMNODE_MAX + 1, MPOL_MF_STRICT) != 0)
+		return -errno;
+
+	return 0;
+#else
+	return -ENOSYS;
+#endif
+}
+
+/* Returns the size of the default huge page in bytes */
+unsigned long memory_hugepage_size(void)
+{
+	char buf[256];
+	unsigned long size = 0;
+	FILE *fp;
+
+	if ((fp = fopen("/proc/meminfo", "r")) != NULL) {
+		while (fgets(buf, sizeof(buf), fp) != NULL)
+			if (strncmp(buf, "Hugepagesize:", 13) == 0) {
+				size = strtoul(buf + 13, NULL, 10) << 10;
+				break;
+			}
+		fclose(fp);
+	}
+
+	return (size > 0) ? size : MEMPAGE_HUGE_SIZE;
+}
+
+/*
+ * Maps the memory like memory_map() and populates all of it when populate is set. The mappings with the page
+ * size advice are populated by MADV_POPULATE_WRITE after the advice, MAP_POPULATE would fault them in before
+ * the advice applies.
+ */
+static void *memory_map_flags(size_t size, int pages, int node, int populate, size_t *mapped)
+{
+	int rc, flags = MAP_PRIVATE | MAP_ANONYMOUS;
+	unsigned long huge;
+	void *ptr;
+
+	if ((pages == MEMPAGE_THP) || (pages == MEMPAGE_HUGETLB)) {
+		huge = memory_hugepage_size();
+		size = (size + huge - 1) & ~(huge - 1);
+	}
+	if (pages == MEMPAGE_HUGETLB) {
+#ifdef MAP_HUGETLB
+		flags |= MAP_HUGETLB;
+#else
+		errno = ENOTSUP;
+		return NULL;
+#endif
+	}
+
+	if (populate && (pages != MEMPAGE_BASE) && (pages != MEMPAGE_THP) && (node < 0))
+		flags |= MAP_POPULATE;
+
+	ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+	if (ptr == MAP_FAILED)
+		return NULL;
+
+	if ((pages == MEMPAGE_BASE) || (pages == MEMPAGE_THP)) {
+#ifdef MADV_HUGEPAGE
+		if ((madvise(ptr, size, (pages == MEMPAGE_THP) ? MADV_HUGEPAGE : MADV_NOHUGEPAGE) != 0)
+				&& (pages == MEMPAGE_THP)) {
+			rc = errno;
+			munmap(ptr, size);
+			errno = rc;
+			return NULL;
+		}
+#else
+		if (pages == MEMPAGE_THP) {
+			munmap(ptr, size);
+			errno = ENOTSUP;
+			return NULL;
+		}
+#endif
+	}
+
+	if ((node >= 0) && ((rc = memory_node_bind(ptr, size, node)) != 0)) {
+		munmap(ptr, size);
+		errno = -rc;
+		return NULL;
+	}
+
+	if (populate && !(flags & MAP_POPULATE)) {
+#ifdef MADV_POPULATE_WRITE
+		if (madvise(ptr, size, MADV_POPULATE_WRITE) != 0) {
+			rc = errno;
+			munmap(ptr, size);
+			errno = rc;
+			return NULL;
+		}
+#else
+		munmap(ptr, size);
+		errno = ENOTSUP;
+		return NULL;
+#endif
+	}
+
+	if (mapped != NULL)
+		*mapped = size;
+	return ptr;
+}
+
+/*
+ * Maps size bytes of anonymous memory backed by the pages of type pages on the NUMA node or using the default
+ * policy when node is -1. MEMPAGE_DEFAULT leaves the page size to the system THP setting, MEMPAGE_BASE and
+ * MEMPAGE_THP disable or request the transparent huge pages by madvise() and MEMPAGE_HUGETLB maps the huge
+ * pages reserved in the hugetlbfs pool. The size is rounded up to the huge page size for the huge pages.
+ * Returns NULL on error with errno set.
+ */
+void *memory_map(size_t size, int pages, int node, size_t *mapped)
+{
+	return memory_map_flags(size, pages, node, 0, mapped);
+}
+
+const char *memory_page_name(int pages)
+{
+	if ((pages < 0) || (pages >= MEMPAGE_COUNT))
+		return NULL;
+
+	return memPageNames[pages];
+}
+
+static void *memlat_chase(void **p, long loads)
+{
+	for (; loads > 0; loads -= 16) {
+		p = (void **)*p; p = (void **)*p; p = (void **)*p; p = (void **)*p;
+		p = (void **)*p; p = (void **)*p; p = (void **)*p; p = (void **)*p;
+		p = (void **)*p; p = (void **)*p; p = (void **)*p; p = (void **)*p;
+		p = (void **)*p; p = (void **)*p; p = (void **)*p; p = (void **)*p;
+	}
+
+	return p;
+}
+
+/*
+ * Measures the load-to-use latency of the working set of size bytes in the pages of type pages. The cache
+ * lines of the working set are linked into one ring in the random order (Sattolo's algorithm) so every load
+ * depends on the previous one and the hardware prefetchers cannot guess the next line. The working set is
+ * bound to the NUMA node unless it's -1. The latency of one load in nanoseconds is stored to ns.
+ */
+int memory_latency_get(unsigned long long size, int pages, int node, double *ns)
+{
+	unsigned long long tm, seed = 0x2545F4914F6CDD1DULL;
+	size_t mapped;
+	char *mem;
+	void *tmp;
+	long i, j, n, loads;
+
+	n = size / MEMLAT_LINE;
+	if (n < 2)
+		return -EINVAL;
+
+	if ((mem = (char *)memory_map(n * MEMLAT_LINE, pages, node, &mapped)) == NULL)
+		return -errno;
+
+	for (i = 0; i < n; i++)
+		*(void **)(mem + i * MEMLAT_LINE) = mem + i * MEMLAT_LINE;
+	for (i = n - 1; i > 0; i--) {
+		seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+		j = (seed >> 33) % i;
+		tmp = *(void **)(mem + i * MEMLAT_LINE);
+		*(void **)(mem + i * MEMLAT_LINE) = *(void **)(mem + j * MEMLAT_LINE);
+		*(void **)(mem + j * MEMLAT_LINE) = tmp;
+	}
+
+	/* Walk the whole ring once to get it to the caches and TLBs it fits in */
+	memlatSink = memlat_chase((void **)mem, n);
+
+	for (loads = 1 << 16; ; loads *= 2) {
+		tm = nanotime();
+		memlatSink = memlat_chase((void **)memlatSink, loads);
+		tm = nanotime() - tm;
+		if (tm >= MEMLAT_MIN_TIME)
+			break;
+	}
+
+	munmap(mem, mapped);
+
+	if (ns != NULL)
+		*ns = (double)tm / loads;
+
+	return 0;
+}
+
+/* Writes one byte to every base page so every page not mapped yet is faulted in */
+static void memory_fault_touch(char *p, size_t size)
+{
+	size_t i;
+
+	for (i = 0; i < size; i += MEMFAULT_PAGE)
+		p[i] = 1;
+}
+
+static unsigned long memory_fault_count(void)
+{
+	struct rusage usage;
+
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0;
+
+	return usage.ru_minflt;
+}
+
+/* Returns the size of the region of every thread, all the regions fit a quarter of the memory */
+size_t memory_fault_size(int threads)
+{
+	unsigned long long size = MEMFAULT_SIZE, max;
+
+	max = (unsigned long long)memory_size_get(MEMTYPE_B) / 4 / threads;
+	if (size > max)
+		size = max & ~(MEMPAGE_HUGE_SIZE - 1);
+	if (size < MEMPAGE_HUGE_SIZE)
+		size = MEMPAGE_HUGE_SIZE;
+
+	return size;
+}
+
+static void *memory_fault_thread(void *arg)
+{
+	tMemFaultThread *t = (tMemFaultThread *)arg;
+	unsigned long long tm;
+	size_t mapped;
+	char *p;
+
+	tm = nanotime();
+	if ((p = (char *)memory_map(t->size, t->pages, -1, &mapped)) == NULL) {
+		t->err = -errno;
+		return NULL;
+	}
+	memory_fault_touch(p, mapped);
+	t->ns = nanotime() - tm;
+
+	/* Keep the memory until all the threads are done so the unmaps don't interfere */
+	pthread_barrier_wait(t->thread.barrier);
+	munmap(p, mapped);
+
+	return NULL;
+}
+
+/*
+ * Gets the first-touch throughput of threads faulting in their own anonymous regions of pages at once. The
+ * throughput of the memory made available is stored in GB/s to gbps and the number of the page faults per
+ * second (in thousands) to faults. The best of a few runs is taken.
+ */
+int memory_fault_get(int threads, int pages, float *gbps, float *faults)
+{
+	tMemFaultThread *t;
+	unsigned long long ns;
+	unsigned long minflt;
+	size_t size;
+	int i, r, rc = 0;
+
+	if ((threads <= 0) || (gbps == NULL) || (faults == NULL))
+		return -EINVAL;
+
+	t = (tMemFaultThread *)malloc( threads * sizeof(tMemFaultThread) );
+	if (t == NULL)
+		return -ENOMEM;
+
+	size = memory_fault_size(threads);
+	*gbps = *faults = 0.0;
+	for (r = 0; (rc == 0) && (r < MEMFAULT_REPEAT); r++) {
+		memset(t, 0, threads * sizeof(tMemFaultThread));
+		for (i = 0; i < threads; i++) {
+			t[i].pages = pages;
+			t[i].size = size;
+		}
+
+		minflt = memory_fault_count();
+		if ((rc = cpu_threads_run(threads, memory_fault_thread, t, sizeof(tMemFaultThread))) != 0)
+			break;
+		minflt = memory_fault_count() - minflt;
+
+		for (i = 0, ns = 0; i < threads; i++) {
+			if (t[i].err != 0)
+				rc = t[i].err;
+			if (t[i].ns > ns)
+				ns = t[i].ns;
+		}
+
+		if ((rc == 0) && (ns > 0) && ((double)threads * size / ns > *gbps)) {
+			*gbps = (double)threads * size / ns;
+			*faults = (double)minflt * 1000000.0 / ns;
+		}
+	}
+
+	free(t);
+	return rc;
+}
+
+/*
+ * Gets the throughput in GB/s of mapping size bytes of pages and touching all of it by one thread, either
+ * with the lazy faulting on the first touch or populated by the kernel when the memory is mapped
+ */
+int memory_populate_get(int pages, int populate, size_t size, float *gbps)
+{
+	unsigned long long tm;
+	size_t mapped;
+	char *p;
+	int r;
+
+	*gbps = 0.0;
+	for (r = 0; r < MEMFAULT_REPEAT; r++) {
+		tm = nanotime();
+		if ((p = (char *)memory_map_flags(size, pages, -1, populate, &mapped)) == NULL)
+			return -errno;
+		memory_fault_touch(p, mapped);
+		tm = nanotime() - tm;
+		munmap(p, mapped);
+
+		if ((double)mapped / tm > *gbps)
+			*gbps = (double)mapped / tm;
+	}
+
+	return 0;
+}
+
+/* The first thread maps, touches and unmaps the region, the other threads keep the address space busy */
+static void *memory_unmap_thread(void *arg)
+{
+	tMemFaultThread *t = (tMemFaultThread *)arg;
+	unsigned long long tm;
+	char *p;
+	int i;
+
+	if (t->thread.idx != 0) {
+		while (!__atomic_load_n(t->stop, __ATOMIC_RELAXED))
+			;
+		return NULL;
+	}
+
+	for (i = 0; i < MEMFAULT_UNMAPS; i++) {
+		p = (char *)mmap(NULL, MEMFAULT_UNMAP_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (p == MAP_FAILED) {
+			t->err = -errno;
+			break;
+		}
+		memory_fault_touch(p, MEMFAULT_UNMAP_SIZE);
+
+		tm = nanotime();
+		munmap(p, MEMFAULT_UNMAP_SIZE);
+		t->ns += nanotime() - tm;
+	}
+
+	__atomic_store_n(t->stop, 1, __ATOMIC_RELAXED);
+	return NULL;
+}
+
+/*
+ * Gets the time in nanoseconds of munmap() of a small touched region while the other threads of the process
+ * run on their CPUs. The TLB of all their CPUs has to be flushed by the IPIs, i.e. the TLB shootdown.
+ */
+int memory_unmap_get(int threads, double *ns)
+{
+	tMemFaultThread *t;
+	int i, rc, stop = 0;
+
+	if ((threads <= 0) || (ns == NULL))
+		return -EINVAL;
+
+	t = (tMemFaultThread *)malloc( threads * sizeof(tMemFaultThread) );
+	if (t == NULL)
+		return -ENOMEM;
+
+	memset(t, 0, threads * sizeof(tMemFaultThread));
+	for (i = 0; i < threads; i++)
+		t[i].stop = &stop;
+
+	rc = cpu_threads_run(threads, memory_unmap_thread, t, sizeof(tMemFaultThread));
+	if (rc == 0)
+		rc = t[0].err;
+	if (rc == 0)
+		*ns = (double)t[0].ns / MEMFAULT_UNMAPS;
+
+	free(t);
+	return rc;
+}
@@ -432,7 +432,7 @@ int net_write_command(int sock, unsigned long long size, unsigned long chunksize
 	while (net_sock_have_data(sock, 5) == 1)
 		total += read(sock, buf, bufsize);
 
-	tm = (nanotime() - start) / 1000000.0;
+	tm = (nanotime() - start) / (float)NSEC_PER_SEC;
 	cpu = calc_cpu_usage(cpu_time_get() - cpu_start, tm);
 
 	if (otm != NULL)
@@ -0,0 +1,154 @@
+/*
+ * perf.c: Hardware performance counters of the benchmark regions
+ *
+ * Author: Michal Novotny <minovotn@redhat.com>
+ *
+ * Copyright (C) 2010 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+ *
+ */
+
+#include "utils.h"
+#include <sys/ioctl.h>
+#include <linux/perf_event.h>
+
+static const char *perfEventNames[] = { "cycles", "instructions", "cache-misses", "branch-misses", "context-switches" };
+static const unsigned int perfEventTypes[] = { PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+	PERF_TYPE_HARDWARE, PERF_TYPE_SOFTWARE };
+static const unsigned long long perfEventConfigs[] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+	PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_SW_CONTEXT_SWITCHES };
+
+/*
+ * Opens the counter of the calling thread and of all the threads it creates later, counting only the user
+ * space when the kernel is not allowed to be counted by perf_event_paranoid
+ */
+static int perf_event_open_one(int event, int user)
+{
+	struct perf_event_attr attr;
+
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = perfEventTypes[event];
+	attr.config = perfEventConfigs[event];
+	attr.disabled = 1;
+	attr.inherit = 1;
+	attr.exclude_hv = 1;
+	attr.exclude_kernel = user;
+	attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+	return syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC);
+}
+
+/*
+ * Opens all the counters available, e.g. only the software ones in most of the virtual machines. Returns the
+ * number of the counters opened or a negative errno value of the first counter when none of them is available.
+ */
+int perf_open(tPerf *p)
+{
+	int i, fd, num = 0, err = 0;
+
+	for (i = 0; i < PERF_EVENTS; i++) {
+		fd = perf_event_open_one(i, 0);
+		if ((fd < 0) && ((errno == EACCES) || (errno == EPERM)))
+			fd = perf_event_open_one(i, 1);
+		if ((fd < 0) && (err == 0))
+			err = -errno;
+
+		p->fd[i] = fd;
+		if (fd >= 0)
+			num++;
+	}
+
+	return (num > 0) ? num : err;
+}
+
+void perf_close(tPerf *p)
+{
+	int i;
+
+	for (i = 0; i < PERF_EVENTS; i++) {
+		if (p->fd[i] >= 0)
+			close(p->fd[i]);
+		p->fd[i] = -1;
+	}
+}
+
+void perf_start(tPerf *p)
+{
+	int i;
+
+	for (i = 0; i < PERF_EVENTS; i++)
+		if (p->fd[i] >= 0) {
+			ioctl(p->fd[i], PERF_EVENT_IOC_RESET, 0);
+			ioctl(p->fd[i], PERF_EVENT_IOC_ENABLE, 0);
+		}
+}
+
+/*
+ * Stops the counters and stores their values to c, the values are scaled up when the counters had to share
+ * the hardware with other events. Only the counters with the bit set in c->valid were counted.
+ */
+void perf_stop(tPerf *p, tPerfCounts *c)
+{
+	unsigned long long val[3];
+	int i;
+
+	for (i = 0; i < PERF_EVENTS; i++)
+		if (p->fd[i] >= 0)
+			ioctl(p->fd[i], PERF_EVENT_IOC_DISABLE, 0);
+
+	c->valid = 0;
+	for (i = 0; i < PERF_EVENTS; i++) {
+		c->value[i] = 0;
+		if ((p->fd[i] < 0) || (read(p->fd[i], val, sizeof(val)) != sizeof(val)))
+			continue;
+
+		if ((val[2] > 0) && (val[2] < val[1]))
+			val[0] = (unsigned long long)((double)val[0] * val[1] / val[2]);
+		else
+		if ((val[2] == 0) && (val[1] > 0))
+			continue;
+
+		c->value[i] = val[0];
+		c->valid |= 1 << i;
+	}
+}
+
+/* Returns the instructions per cycle or a negative value when any of the counters is not available */
+double perf_ipc(tPerfCounts *c)
+{
+	if (!PERF_VALID(c, PERF_CYCLES) || !PERF_VALID(c, PERF_INSTRUCTIONS) || (c->value[PERF_CYCLES] == 0))
+		return -1.0;
+
+	return (double)c->value[PERF_INSTRUCTIONS] / c->value[PERF_CYCLES];
+}
+
+/* Returns the cycles per unit of the work done, e.g. per byte, or a negative value when not available */
+double perf_cycles_per(tPerfCounts *c, unsigned long long work)
+{
+	if (!PERF_VALID(c, PERF_CYCLES) || (work == 0))
+		return -1.0;
+
+	return (double)c->value[PERF_CYCLES] / work;
+}
+
+const char *perf_event_name(int event)
+{
+	if ((event < 0) || (event >= PERF_EVENTS))
+		return NULL;
+
+	return perfEventNames[event];
+}
@@ -0,0 +1,189 @@
+/*
+ * stats.c: Repetition of the benchmarks and statistics of their results
+ *
+ * Author: Michal Novotny <minovotn@redhat.com>
+ *
+ * Copyright (C) 2010 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+ *
+ */
+
+#include "utils.h"
+#include <math.h>
+
+/* Runs discarded before the samples are taken, e.g. to fill the caches and to get the CPU out of idle */
+#define STATS_WARMUP			1
+/* The confidence interval is not checked for less samples, and no more samples are taken */
+#define STATS_MIN_RUNS			5
+#define STATS_MAX_RUNS			100
+/* Samples beyond this number of the interquartile ranges from the quartiles are outliers (Tukey's fences) */
+#define STATS_FENCE				1.5
+
+/* Two-sided 95% quantiles of Student's t distribution for 1..30 degrees of freedom */
+static const double statsT95[] = { 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+	2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086, 2.080, 2.074, 2.069, 2.064, 2.060,
+	2.056, 2.052, 2.048, 2.045, 2.042 };
+
+static double stats_t95(int df)
+{
+	if (df <= 0)
+		return 0.0;
+	if (df <= sizeof(statsT95) / sizeof(statsT95[0]))
+		return statsT95[df - 1];
+	if (df <= 60)
+		return 2.000;
+
+	return 1.960;
+}
+
+static int stats_cmp(const void *a, const void *b)
+{
+	double x = *(const double *)a, y = *(const double *)b;
+
+	return (x > y) - (x < y);
+}
+
+/* Returns the percentile of the sorted samples interpolated between the closest ranks */
+static double stats_percentile(double *sorted, int n, double pct)
+{
+	double pos = pct / 100.0 * (n - 1);
+	int i = (int)pos;
+
+	if (i >= n - 1)
+		return sorted[n - 1];
+
+	return sorted[i] + (pos - i) * (sorted[i + 1] - sorted[i]);
+}
+
+/*
+ * Computes the statistics of n samples, the confidence interval is the 95% interval of the mean. The samples
+ * outside of the Tukey's fences are counted as outliers, they are still part of the statistics and the median
+ * is not affected by them.
+ */
+int stats_compute(double *samples, int n, tStats *st)
+{
+	double *sorted, sum = 0.0, sq = 0.0, q1, q3, half;
+	int i;
+
+	if ((samples == NULL) || (n <= 0) || (st == NULL))
+		return -EINVAL;
+
+	if ((sorted = (double *)malloc( n * sizeof(double) )) == NULL)
+		return -ENOMEM;
+	memcpy(sorted, samples, n * sizeof(double));
+	qsort(sorted, n, sizeof(double), stats_cmp);
+
+	for (i = 0; i < n; i++)
+		sum += sorted[i];
+	st->mean = sum / n;
+	for (i = 0; i < n; i++)
+		sq += (sorted[i] - st->mean) * (sorted[i] - st->mean);
+	st->stddev = (n > 1) ? sqrt(sq / (n - 1)) : 0.0;
+
+	st->runs = n;
+	st->median = stats_percentile(sorted, n, 50.0);
+	st->p5 = stats_percentile(sorted, n, 5.0);
+	st->p95 = stats_percentile(sorted, n, 95.0);
+
+	half = stats_t95(n - 1) * st->stddev / sqrt(n);
+	st->ci_low = st->mean - half;
+	st->ci_high = st->mean + half;
+
+	q1 = stats_percentile(sorted, n, 25.0);
+	q3 = stats_percentile(sorted, n, 75.0);
+	st->outliers = 0;
+	for (i = 0; i < n; i++)
+		if ((sorted[i] < q1 - STATS_FENCE * (q3 - q1)) || (sorted[i] > q3 + STATS_FENCE * (q3 - q1)))
+			st->outliers++;
+
+	free(sorted);
+	return 0;
+}
+
+/* Returns the half-width of the confidence interval in percent of the mean */
+double stats_ci_pct(tStats *st)
+{
+	if (st->mean == 0.0)
+		return 0.0;
+
+	return (st->ci_high - st->mean) * 100.0 / fabs(st->mean);
+}
+
+/*
+ * Runs the benchmark function repeatedly, every run stores num metrics to the array passed and returns 0 or a
+ * negative errno value. The warm-up runs are discarded, then the runs go on until the confidence interval of
+ * every metric is within ci percent of its mean, until the budget in nanoseconds is over or until the maximal
+ * number of the runs. The statistics of every metric are stored to st and the converged flag is set when the
+ * confidence interval was met. Returns 0 or the error of the first failed run.
+ */
+int stats_repeat(int (*func)(void *, double *), void *arg, int num, double ci, unsigned long long budget,
+			tStats *st)
+{
+	unsigned long long start;
+	double *samples, *values, *metric;
+	int i, m, run, n = 0, rc = 0, converged = 0;
+
+	if ((func == NULL) || (num <= 0) || (st == NULL))
+		return -EINVAL;
+
+	samples = (double *)malloc( STATS_MAX_RUNS * num * sizeof(double) );
+	values = (double *)malloc( num * sizeof(double) );
+	metric = (double *)malloc( STATS_MAX_RUNS * sizeof(double) );
+	if ((samples == NULL) || (values == NULL) || (metric == NULL)) {
+		free(samples);
+		free(values);
+		free(metric);
+		return -ENOMEM;
+	}
+
+	start = nanotime();
+	for (run = 0; (n < STATS_MAX_RUNS) && !converged; run++) {
+		if ((rc = func(arg, values)) != 0)
+			break;
+		if (run < STATS_WARMUP)
+			continue;
+
+		memcpy(&samples[n * num], values, num * sizeof(double));
+		n++;
+
+		if (n >= STATS_MIN_RUNS) {
+			converged = 1;
+			for (m = 0; (m < num) && converged; m++) {
+				for (i = 0; i < n; i++)
+					metric[i] = samples[i * num + m];
+				if ((stats_compute(metric, n, &st[m]) != 0) || (stats_ci_pct(&st[m]) > ci))
+					converged = 0;
+			}
+		}
+
+		if ((n >= 2) && (nanotime() - start >= budget))
+			break;
+	}
+
+	for (m = 0; (n > 0) && (m < num); m++) {
+		for (i = 0; i < n; i++)
+			metric[i] = samples[i * num + m];
+		stats_compute(metric, n, &st[m]);
+		st[m].warmup = STATS_WARMUP;
+		st[m].converged = converged;
+	}
+
+	free(samples);
+	free(values);
+	free(metric);
+
+	return (n > 0) ? 0 : rc;
+}
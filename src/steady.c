@@ -0,0 +1,148 @@
+/*
+ * steady.c: Sampling of sustained runs and steady-state detection
+ *
+ * Author: Michal Novotny <minovotn@redhat.com>
+ *
+ * Copyright (C) 2010 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+ *
+ */
+
+#include "utils.h"
+#include <math.h>
+
+/* The throughput is averaged over this number of the intervals to smooth the noise of the short intervals */
+#define STEADY_WINDOW			4
+/* Throughput within this percentage of the steady state is steady, a bigger drop in the second half degrades */
+#define STEADY_TOLERANCE		5.0
+
+/*
+ * Prepares the sampler of a run of duration nanoseconds split to intervals of interval nanoseconds, the run
+ * starts at start. The samplers of several threads are merged when they share the start and the interval.
+ */
+int steady_init(tSteady *s, unsigned long long start, unsigned long long duration, unsigned long long interval)
+{
+	if ((interval == 0) || (duration < interval))
+		return -EINVAL;
+
+	s->start = start;
+	s->interval = interval;
+	s->size = duration / interval;
+	s->work = (double *)malloc( s->size * sizeof(double) );
+	if (s->work == NULL)
+		return -ENOMEM;
+	memset(s->work, 0, s->size * sizeof(double));
+
+	return 0;
+}
+
+void steady_free(tSteady *s)
+{
+	free(s->work);
+	s->work = NULL;
+	s->size = 0;
+}
+
+/* Accounts the work done now to its interval, the work done after the end of the run is ignored */
+void steady_tick(tSteady *s, double work)
+{
+	unsigned long long idx = (nanotime() - s->start) / s->interval;
+
+	if (idx < s->size)
+		s->work[idx] += work;
+}
+
+/* Adds the work of all the intervals of the src sampler to the dst sampler */
+void steady_merge(tSteady *dst, tSteady *src)
+{
+	int i;
+
+	for (i = 0; (i < dst->size) && (i < src->size); i++)
+		dst->work[i] += src->work[i];
+}
+
+static double steady_window(double *rate, int first, int num)
+{
+	double sum = 0.0;
+	int i;
+
+	for (i = first; i < first + num; i++)
+		sum += rate[i];
+
+	return sum / num;
+}
+
+/*
+ * Gets the throughput of every interval in the work units per second divided by scale and splits the run to
+ * the burst (the first window), the steady state (the mean of the last quarter) and the time to get there, i.e.
+ * the start of the first window after which all the windows are within STEADY_TOLERANCE of the steady state.
+ * The slope of the second half in percent of the steady state per minute tells a run that keeps degrading.
+ * The rates are allocated to r->rate and freed by steady_results_free().
+ */
+int steady_analyze(tSteady *s, double scale, tSteadyResults *r)
+{
+	double secs = (double)s->interval / NSEC_PER_SEC;
+	double sx = 0.0, sy = 0.0, sxy = 0.0, sxx = 0.0, x, w;
+	int i, n, quarter, half;
+
+	memset(r, 0, sizeof(tSteadyResults));
+	n = s->size;
+	if (n < 2 * STEADY_WINDOW)
+		return -EINVAL;
+
+	r->rate = (double *)malloc( n * sizeof(double) );
+	if (r->rate == NULL)
+		return -ENOMEM;
+
+	for (i = 0; i < n; i++)
+		r->rate[i] = s->work[i] / secs / scale;
+	r->samples = n;
+	r->interval = secs;
+
+	quarter = (n / 4 > STEADY_WINDOW) ? n / 4 : STEADY_WINDOW;
+	r->burst = steady_window(r->rate, 0, STEADY_WINDOW);
+	r->steady = steady_window(r->rate, n - quarter, quarter);
+
+	/* Walk back from the end while the windows stay close to the steady state */
+	for (i = n - STEADY_WINDOW; i >= 0; i--) {
+		w = steady_window(r->rate, i, STEADY_WINDOW);
+		if ((r->steady <= 0.0) || (fabs(w - r->steady) * 100.0 / r->steady > STEADY_TOLERANCE))
+			break;
+	}
+	r->settle = (i + 1) * secs;
+	r->settled = (i + 1 <= n - quarter);
+
+	half = n / 2;
+	for (i = half; i < n; i++) {
+		x = (i - half) * secs;
+		sx += x;
+		sy += r->rate[i];
+		sxy += x * r->rate[i];
+		sxx += x * x;
+	}
+	i = n - half;
+	if ((r->steady > 0.0) && (i * sxx - sx * sx > 0.0))
+		r->slope = (i * sxy - sx * sy) / (i * sxx - sx * sx) * 60.0 * 100.0 / r->steady;
+	r->degrading = (r->slope * (i * secs / 60.0) < -STEADY_TOLERANCE);
+
+	return 0;
+}
+
+void steady_results_free(tSteadyResults *r)
+{
+	free(r->rate);
+	r->rate = NULL;
+}
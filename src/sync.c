@@ -0,0 +1,287 @@
+/*
+ * sync.c: Synchronization primitive contention benchmark
+ *
+ * Author: Michal Novotny <minovotn@redhat.com>
+ *
+ * Copyright (C) 2010 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+ *
+ */
+
+#include "utils.h"
+#include <linux/futex.h>
+
+/* Time of one run in nanoseconds */
+#define SYNC_TIME				100000000ULL
+/* Operations done between the checks of the stop flag */
+#define SYNC_BATCH				256
+/* Every lock is alone in its cache line (and the adjacent line prefetched with it) */
+#define SYNC_LINE				128
+/* One of this number of the rwlock operations takes the write lock, the others take the read lock */
+#define SYNC_RW_RATIO			8
+
+static const char *syncPrimitiveNames[] = { "mutex", "spinlock", "rwlock", "futex", "cas", "fetch-add" };
+static const char *syncCaseNames[] = { "contended", "uncontended" };
+
+typedef struct {
+	union {
+		pthread_mutex_t mutex;
+		pthread_spinlock_t spin;
+		pthread_rwlock_t rwlock;
+		int futex;
+	} lock;
+	unsigned long counter;
+} __attribute__((aligned(SYNC_LINE))) tSyncLock;
+
+typedef struct {
+	tThread thread;
+	unsigned long (*func)(tSyncLock *, int);
+	tSyncLock *lock;
+	int *stop;
+	unsigned long ops;
+	unsigned long long ns;
+} tSyncThread;
+
+static unsigned long sync_mutex(tSyncLock *l, int num)
+{
+	int i;
+
+	for (i = 0; i < num; i++) {
+		pthread_mutex_lock(&l->lock.mutex);
+		l->counter++;
+		pthread_mutex_unlock(&l->lock.mutex);
+	}
+
+	return l->counter;
+}
+
+static unsigned long sync_spinlock(tSyncLock *l, int num)
+{
+	int i;
+
+	for (i = 0; i < num; i++) {
+		pthread_spin_lock(&l->lock.spin);
+		l->counter++;
+		pthread_spin_unlock(&l->lock.spin);
+	}
+
+	return l->counter;
+}
+
+static unsigned long sync_rwlock(tSyncLock *l, int num)
+{
+	unsigned long val = 0;
+	int i;
+
+	for (i = 0; i < num; i++) {
+		if ((i % SYNC_RW_RATIO) == 0) {
+			pthread_rwlock_wrlock(&l->lock.rwlock);
+			l->counter++;
+		}
+		else {
+			pthread_rwlock_rdlock(&l->lock.rwlock);
+			val += l->counter;
+		}
+		pthread_rwlock_unlock(&l->lock.rwlock);
+	}
+
+	return val;
+}
+
+/*
+ * The futex based mutex from "Futexes Are Tricky" by Ulrich Drepper: 0 is unlocked, 1 is locked and 2 is
+ * locked with waiters, the kernel is entered only when there may be waiters.
+ */
+static void sync_futex_lock(int *f)
+{
+	int c = 0;
+
+	if (__atomic_compare_exchange_n(f, &c, 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+		return;
+
+	if (c != 2)
+		c = __atomic_exchange_n(f, 2, __ATOMIC_ACQUIRE);
+	while (c != 0) {
+		syscall(SYS_futex, f, FUTEX_WAIT_PRIVATE, 2, NULL, NULL, 0);
+		c = __atomic_exchange_n(f, 2, __ATOMIC_ACQUIRE);
+	}
+}
+
+static void sync_futex_unlock(int *f)
+{
+	if (__atomic_fetch_sub(f, 1, __ATOMIC_RELEASE) != 1) {
+		__atomic_store_n(f, 0, __ATOMIC_RELEASE);
+		syscall(SYS_futex, f, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+	}
+}
+
+static unsigned long sync_futex(tSyncLock *l, int num)
+{
+	int i;
+
+	for (i = 0; i < num; i++) {
+		sync_futex_lock(&l->lock.futex);
+		l->counter++;
+		sync_futex_unlock(&l->lock.futex);
+	}
+
+	return l->counter;
+}
+
+static unsigned long sync_cas(tSyncLock *l, int num)
+{
+	unsigned long val = 0;
+	int i;
+
+	for (i = 0; i < num; i++) {
+		val = __atomic_load_n(&l->counter, __ATOMIC_RELAXED);
+		while (!__atomic_compare_exchange_n(&l->counter, &val, val + 1, 1, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+			;
+	}
+
+	return val;
+}
+
+static unsigned long sync_fetch_add(tSyncLock *l, int num)
+{
+	int i;
+
+	for (i = 0; i < num; i++)
+		__atomic_fetch_add(&l->counter, 1, __ATOMIC_ACQ_REL);
+
+	return l->counter;
+}
+
+static unsigned long (*syncFuncs[])(tSyncLock *, int) = { sync_mutex, sync_spinlock, sync_rwlock, sync_futex,
+	sync_cas, sync_fetch_add };
+
+static void sync_lock_init(int primitive, tSyncLock *l)
+{
+	memset(l, 0, sizeof(tSyncLock));
+	if (primitive == SYNC_MUTEX)
+		pthread_mutex_init(&l->lock.mutex, NULL);
+	else
+	if (primitive == SYNC_SPINLOCK)
+		pthread_spin_init(&l->lock.spin, PTHREAD_PROCESS_PRIVATE);
+	else
+	if (primitive == SYNC_RWLOCK)
+		pthread_rwlock_init(&l->lock.rwlock, NULL);
+}
+
+static void sync_lock_destroy(int primitive, tSyncLock *l)
+{
+	if (primitive == SYNC_MUTEX)
+		pthread_mutex_destroy(&l->lock.mutex);
+	else
+	if (primitive == SYNC_SPINLOCK)
+		pthread_spin_destroy(&l->lock.spin);
+	else
+	if (primitive == SYNC_RWLOCK)
+		pthread_rwlock_destroy(&l->lock.rwlock);
+}
+
+/* The first thread stops all the threads once the time is over */
+static void *sync_thread(void *arg)
+{
+	tSyncThread *t = (tSyncThread *)arg;
+	unsigned long long tm;
+
+	tm = nanotime();
+	while (!__atomic_load_n(t->stop, __ATOMIC_RELAXED)) {
+		t->func(t->lock, SYNC_BATCH);
+		t->ops += SYNC_BATCH;
+
+		if ((t->thread.idx == 0) && (nanotime() - tm >= SYNC_TIME))
+			__atomic_store_n(t->stop, 1, __ATOMIC_RELAXED);
+	}
+	t->ns = nanotime() - tm;
+
+	return NULL;
+}
+
+/*
+ * Runs the primitive in the threads, either all of them on one lock (SYNC_CONTENDED) or each of them on its
+ * own lock (SYNC_UNCONTENDED). The total throughput in millions of the operations per second is stored to
+ * mops and Jain's fairness index of the operations done by the threads (1.0 when all of them did the same
+ * number of the operations, 1 / threads when one thread did all of them) to fairness.
+ */
+int sync_get(int primitive, int scase, int threads, float *mops, float *fairness)
+{
+	tSyncThread *t;
+	tSyncLock *locks;
+	unsigned long long ns = 0;
+	double sum = 0.0, sumsq = 0.0;
+	int i, rc, nlocks, stop = 0;
+
+	if ((primitive < 0) || (primitive >= SYNC_PRIMITIVES) || (threads <= 0))
+		return -EINVAL;
+
+	nlocks = (scase == SYNC_CONTENDED) ? 1 : threads;
+	if (posix_memalign((void **)&locks, SYNC_LINE, nlocks * sizeof(tSyncLock)) != 0)
+		return -ENOMEM;
+
+	t = (tSyncThread *)malloc( threads * sizeof(tSyncThread) );
+	if (t == NULL) {
+		free(locks);
+		return -ENOMEM;
+	}
+
+	for (i = 0; i < nlocks; i++)
+		sync_lock_init(primitive, &locks[i]);
+
+	memset(t, 0, threads * sizeof(tSyncThread));
+	for (i = 0; i < threads; i++) {
+		t[i].func = syncFuncs[primitive];
+		t[i].lock = &locks[(scase == SYNC_CONTENDED) ? 0 : i];
+		t[i].stop = &stop;
+	}
+
+	rc = cpu_threads_run(threads, sync_thread, t, sizeof(tSyncThread));
+	if (rc == 0) {
+		for (i = 0; i < threads; i++) {
+			sum += t[i].ops;
+			sumsq += (double)t[i].ops * t[i].ops;
+			if (t[i].ns > ns)
+				ns = t[i].ns;
+		}
+
+		*mops = (ns > 0) ? sum * 1000.0 / ns : 0.0;
+		*fairness = (sumsq > 0.0) ? sum * sum / (threads * sumsq) : 0.0;
+	}
+
+	for (i = 0; i < nlocks; i++)
+		sync_lock_destroy(primitive, &locks[i]);
+	free(locks);
+	free(t);
+
+	return rc;
+}
+
+const char *sync_primitive_name(int primitive)
+{
+	if ((primitive < 0) || (primitive >= SYNC_PRIMITIVES))
+		return NULL;
+
+	return syncPrimitiveNames[primitive];
+}
+
+const char *sync_case_name(int scase)
+{
+	if ((scase < 0) || (scase >= SYNC_CASES))
+		return NULL;
+
+	return syncCaseNames[scase];
+}
@@ -0,0 +1,224 @@
+/*
+ * syscall.c: System call and context switch overhead benchmark
+ *
+ * Author: Michal Novotny <minovotn@redhat.com>
+ *
+ * Copyright (C) 2010 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+ *
+ */
+
+#include "utils.h"
+
+/* Calls per sample and the number of the samples, the best sample is taken */
+#define SYSCALL_LOOPS			20000
+#define SYSCALL_SAMPLES			5
+/* Round trips of the context switch measurement, the warm-up ones are not timed */
+#define CTXSW_ROUNDS			10000
+#define CTXSW_WARMUP			1000
+
+static const char *syscallNames[] = { "getpid", "read-dev-zero", "clock-vdso", "clock-syscall" };
+static const char *ctxswNames[] = { "thread", "process" };
+
+typedef struct {
+	tThread thread;
+	int process;
+	int cpu;
+	int ping[2];
+	int pong[2];
+	double ns;
+	int rc;
+} tCtxswThread;
+
+/* Runs the call loops times, the fd is /dev/zero opened for the read() */
+static void syscall_loop(int call, int fd, int loops)
+{
+	struct timespec ts;
+	char buf[1];
+	int i;
+
+	for (i = 0; i < loops; i++)
+		switch (call) {
+			case SYSCALL_GETPID:
+				syscall(SYS_getpid);
+				break;
+			case SYSCALL_READ:
+				if (read(fd, buf, 1) != 1)
+					return;
+				break;
+			case SYSCALL_CLOCK_VDSO:
+				clock_gettime(CLOCK_MONOTONIC, &ts);
+				break;
+			case SYSCALL_CLOCK_RAW:
+				syscall(SYS_clock_gettime, CLOCK_MONOTONIC, &ts);
+				break;
+		}
+}
+
+/*
+ * Gets the cost of one call in nanoseconds. The getpid() and clock_gettime() system calls are made directly
+ * by syscall() to avoid any caching in the C library, while clock_gettime() of the C library goes through
+ * the vDSO and doesn't enter the kernel at all.
+ */
+int syscall_latency_get(int call, double *ns)
+{
+	unsigned long long tm;
+	int i, fd = -1;
+	double val;
+
+	if ((call < 0) || (call >= SYSCALL_CALLS) || (ns == NULL))
+		return -EINVAL;
+
+	if ((call == SYSCALL_READ) && ((fd = open("/dev/zero", O_RDONLY)) < 0))
+		return -errno;
+
+	*ns = 0.0;
+	syscall_loop(call, fd, SYSCALL_LOOPS / 10);
+	for (i = 0; i < SYSCALL_SAMPLES; i++) {
+		tm = nanotime();
+		syscall_loop(call, fd, SYSCALL_LOOPS);
+		tm = nanotime() - tm;
+
+		val = (double)tm / SYSCALL_LOOPS;
+		if ((*ns == 0.0) || (val < *ns))
+			*ns = val;
+	}
+
+	if (fd >= 0)
+		close(fd);
+
+	return 0;
+}
+
+/* Bounces one byte through the pipes, the initiator writes to ping and waits for the reply from pong */
+static int ctxsw_bounce(int rfd, int wfd, int rounds, int initiator)
+{
+	char c = 0;
+	int i;
+
+	for (i = 0; i < rounds; i++) {
+		if (initiator && (write(wfd, &c, 1) != 1))
+			return -EIO;
+		if (read(rfd, &c, 1) != 1)
+			return -EIO;
+		if (!initiator && (write(wfd, &c, 1) != 1))
+			return -EIO;
+	}
+
+	return 0;
+}
+
+/*
+ * The first thread is the initiator, the second one replies either itself or from the child process pinned
+ * to its CPU. A round trip is two context switches when both sides share the CPU.
+ */
+static void *ctxsw_thread(void *arg)
+{
+	tCtxswThread *t = (tCtxswThread *)arg;
+	unsigned long long tm;
+	pid_t pid = -1;
+	int status;
+
+	if (t->thread.idx == 1) {
+		if (!t->process) {
+			t->rc = ctxsw_bounce(t->ping[0], t->pong[1], CTXSW_WARMUP + CTXSW_ROUNDS, 0);
+			return NULL;
+		}
+
+		if ((pid = fork()) == 0) {
+			cpu_affinity_set_cpu(0, t->cpu);
+			_exit(ctxsw_bounce(t->ping[0], t->pong[1], CTXSW_WARMUP + CTXSW_ROUNDS, 0) == 0 ? 0 : 1);
+		}
+		if (pid < 0)
+			t->rc = -errno;
+
+		/* Only the child writes the replies so the initiator gets EOF if the child is gone */
+		close(t->pong[1]);
+		t->pong[1] = -1;
+		if ((pid > 0) && ((waitpid(pid, &status, 0) < 0) || !WIFEXITED(status) || (WEXITSTATUS(status) != 0)))
+			t->rc = -EIO;
+		return NULL;
+	}
+
+	if ((t->rc = ctxsw_bounce(t->pong[0], t->ping[1], CTXSW_WARMUP, 1)) != 0)
+		return NULL;
+
+	tm = nanotime();
+	t->rc = ctxsw_bounce(t->pong[0], t->ping[1], CTXSW_ROUNDS, 1);
+	tm = nanotime() - tm;
+
+	t->ns = (double)tm / (2 * CTXSW_ROUNDS);
+	return NULL;
+}
+
+/*
+ * Gets the latency in nanoseconds of the switch between two threads (or two processes when process is set)
+ * pinned to the CPUs, i.e. the half of the round trip of one byte through a pair of pipes. Both CPUs may be
+ * the same to get the cost of the context switch itself.
+ */
+int syscall_ctxsw_get(int process, int cpu1, int cpu2, double *ns)
+{
+	tCtxswThread t[2];
+	int cpus[2], ping[2], pong[2], rc;
+
+	if (ns == NULL)
+		return -EINVAL;
+
+	if (pipe(ping) != 0)
+		return -errno;
+	if (pipe(pong) != 0) {
+		rc = -errno;
+		close(ping[0]);
+		close(ping[1]);
+		return rc;
+	}
+
+	memset(t, 0, sizeof(t));
+	t[0].process = t[1].process = process;
+	t[0].cpu = cpus[0] = cpu1;
+	t[1].cpu = cpus[1] = cpu2;
+	memcpy(t[0].ping, ping, sizeof(ping));
+	memcpy(t[1].ping, ping, sizeof(ping));
+	memcpy(t[0].pong, pong, sizeof(pong));
+	memcpy(t[1].pong, pong, sizeof(pong));
+
+	rc = cpu_threads_run_on(2, cpus, ctxsw_thread, t, sizeof(tCtxswThread));
+	if (rc == 0)
+		rc = (t[0].rc != 0) ? t[0].rc : t[1].rc;
+	if (rc == 0)
+		*ns = t[0].ns;
+
+	close(ping[0]);
+	close(ping[1]);
+	close(pong[0]);
+	if (t[1].pong[1] >= 0)
+		close(pong[1]);
+
+	return rc;
+}
+
+const char *syscall_call_name(int call)
+{
+	if ((call < 0) || (call >= SYSCALL_CALLS))
+		return NULL;
+
+	return syscallNames[call];
+}
+
+const char *syscall_ctxsw_name(int process)
+{
+	return ctxswNames[process ? 1 : 0];
+}
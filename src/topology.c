@@ -0,0 +1,378 @@
+/*
+ * topology.c: CPU cache and topology discovery
+ *
+ * Author: Michal Novotny <minovotn@redhat.com>
+ *
+ * Copyright (C) 2010 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+ *
+ */
+
+#include "utils.h"
+
+#define TOPOLOGY_SYSFS			"/sys/devices/system/cpu"
+
+static const char *topologyRelations[] = { "smt", "llc", "package", "remote" };
+
+static tTopology topology;
+static int topologyValid = 0;
+
+/* Reads the first line of the sysfs file of the CPU to buf, returns -1 when the file cannot be read */
+static int topology_read(int cpu, const char *name, char *buf, int len)
+{
+	char path[256];
+	FILE *fp;
+	int rc = 0;
+
+	snprintf(path, sizeof(path), TOPOLOGY_SYSFS "/cpu%d/%s", cpu, name);
+	if ((fp = fopen(path, "r")) == NULL)
+		return -1;
+	if (fgets(buf, len, fp) == NULL)
+		rc = -1;
+	fclose(fp);
+
+	if (rc == 0)
+		buf[strcspn(buf, "\n")] = 0;
+	return rc;
+}
+
+static long topology_read_long(int cpu, const char *name)
+{
+	char buf[64];
+
+	if (topology_read(cpu, name, buf, sizeof(buf)) != 0)
+		return -1;
+
+	return atol(buf);
+}
+
+/* Returns the number of the CPUs in the list like "0-3,8", the list may have any number of CPUs */
+static int topology_list_count(const char *list)
+{
+	char *end;
+	long first, last;
+	int num = 0;
+
+	while (*list != 0) {
+		first = last = strtol(list, &end, 10);
+		if (end == list)
+			break;
+		if (*end == '-')
+			last = strtol(end + 1, &end, 10);
+		if (last >= first)
+			num += last - first + 1;
+
+		list = (*end == ',') ? end + 1 : end;
+	}
+
+	return num;
+}
+
+static void topology_caches_get(tTopology *topo, int cpu)
+{
+	char name[64], buf[1024];
+	tCache *c;
+	int i;
+
+	for (i = 0; topo->ncaches < TOPOLOGY_MAX_CACHES; i++) {
+		c = &topo->caches[topo->ncaches];
+
+		snprintf(name, sizeof(name), "cache/index%d/level", i);
+		if ((c->level = topology_read_long(cpu, name)) < 0)
+			break;
+
+		snprintf(name, sizeof(name), "cache/index%d/type", i);
+		if (topology_read(cpu, name, c->type, sizeof(c->type)) != 0)
+			strcpy(c->type, "Unified");
+
+		snprintf(name, sizeof(name), "cache/index%d/size", i);
+		if (topology_read(cpu, name, buf, sizeof(buf)) != 0)
+			continue;
+		c->size = atol(buf);
+		if (strchr(buf, 'K') != NULL)
+			c->size <<= 10;
+		else
+		if (strchr(buf, 'M') != NULL)
+			c->size <<= 20;
+
+		snprintf(name, sizeof(name), "cache/index%d/coherency_line_size", i);
+		c->line = topology_read_long(cpu, name);
+		snprintf(name, sizeof(name), "cache/index%d/ways_of_associativity", i);
+		c->ways = topology_read_long(cpu, name);
+		snprintf(name, sizeof(name), "cache/index%d/shared_cpu_list", i);
+		c->shared = (topology_read(cpu, name, buf, sizeof(buf)) == 0) ? topology_list_count(buf) : 1;
+		if (c->shared <= 0)
+			c->shared = 1;
+
+		topo->ncaches++;
+	}
+}
+
+/* Fills the caches from sysconf() when sysfs has no cache information */
+static void topology_caches_sysconf(tTopology *topo)
+{
+	long sizes[3];
+	int i;
+
+	sizes[0] = sysconf(_SC_LEVEL1_DCACHE_SIZE);
+	sizes[1] = sysconf(_SC_LEVEL2_CACHE_SIZE);
+	sizes[2] = sysconf(_SC_LEVEL3_CACHE_SIZE);
+
+	for (i = 0; i < 3; i++) {
+		if (sizes[i] <= 0)
+			continue;
+
+		topo->caches[topo->ncaches].level = i + 1;
+		topo->caches[topo->ncaches].size = sizes[i];
+		topo->caches[topo->ncaches].line = sysconf(_SC_LEVEL1_DCACHE_LINESIZE);
+		topo->caches[topo->ncaches].ways = -1;
+		topo->caches[topo->ncaches].shared = 1;
+		strcpy(topo->caches[topo->ncaches].type, (i == 0) ? "Data" : "Unified");
+		topo->ncaches++;
+	}
+}
+
+/*
+ * Discovers the CPU topology from sysfs: the number of online CPUs, packages, cores and the SMT siblings
+ * per core, the NUMA nodes and the caches seen by the first online CPU. The topology is read only once and
+ * the cached copy is returned by next calls.
+ */
+int topology_get(tTopology *topo)
+{
+	int *pkgs, *cores, i, j, cpu, conf, pkg, core;
+	uint64_t nodes;
+
+	if (topologyValid) {
+		if (topo != NULL)
+			memcpy(topo, &topology, sizeof(tTopology));
+		return 0;
+	}
+
+	conf = sysconf(_SC_NPROCESSORS_CONF);
+	if (conf <= 0)
+		return -EINVAL;
+
+	pkgs = (int *)malloc( conf * sizeof(int) );
+	cores = (int *)malloc( conf * sizeof(int) );
+	if ((pkgs == NULL) || (cores == NULL)) {
+		free(pkgs);
+		free(cores);
+		return -ENOMEM;
+	}
+
+	memset(&topology, 0, sizeof(tTopology));
+	topology.first = -1;
+	for (cpu = 0; cpu < conf; cpu++) {
+		/* Offline CPUs have no topology directory */
+		if ((pkg = topology_read_long(cpu, "topology/physical_package_id")) < 0)
+			continue;
+		if ((core = topology_read_long(cpu, "topology/core_id")) < 0)
+			continue;
+
+		if (topology.first < 0)
+			topology.first = cpu;
+		topology.cpus++;
+
+		for (i = 0; (i < topology.packages) && (pkgs[i] != pkg); i++)
+			;
+		if (i == topology.packages)
+			pkgs[topology.packages++] = pkg;
+
+		/* The core IDs are unique within the package only */
+		for (j = 0; (j < topology.cores) && (cores[j] != pkg * conf + core); j++)
+			;
+		if (j == topology.cores)
+			cores[topology.cores++] = pkg * conf + core;
+	}
+	free(pkgs);
+	free(cores);
+
+	if (topology.cpus == 0) {
+		topology.first = 0;
+		topology.cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		topology.packages = 1;
+		topology.cores = topology.cpus;
+	}
+	topology.smt = (topology.cores > 0) ? topology.cpus / topology.cores : 1;
+	topology.nodes = memory_nodes_get(&nodes);
+	if (topology.nodes <= 0)
+		topology.nodes = 1;
+
+	topology_caches_get(&topology, topology.first);
+	if (topology.ncaches == 0)
+		topology_caches_sysconf(&topology);
+
+	topologyValid = 1;
+	if (topo != NULL)
+		memcpy(topo, &topology, sizeof(tTopology));
+
+	return 0;
+}
+
+/*
+ * Returns the size in bytes of the data (or unified) cache of the level seen by the first online CPU, 0 if
+ * there's no such cache. The sizes are read from sysfs, sysconf() is used when sysfs is not available.
+ */
+long cpu_cache_size_get(int level)
+{
+	int i;
+
+	if (topology_get(NULL) != 0)
+		return 0;
+
+	for (i = 0; i < topology.ncaches; i++)
+		if ((topology.caches[i].level == level) && (strcmp(topology.caches[i].type, "Instruction") != 0))
+			return topology.caches[i].size;
+
+	return 0;
+}
+
+/* Returns the last cache level with the data, 0 when no cache is known */
+int topology_cache_levels(void)
+{
+	int level;
+
+	for (level = TOPOLOGY_MAX_LEVEL; level > 0; level--)
+		if (cpu_cache_size_get(level) > 0)
+			return level;
+
+	return 0;
+}
+
+/*
+ * Gets the working set sizes just under and just over every data cache level, i.e. 3/4 and 3/2 of the cache
+ * size, and four times the last level cache for the main memory. The sizes don't overlap the next level so
+ * a size is left out when it would be already over the next cache. The levels of the sizes (1 to the number
+ * of the levels plus one for the memory) are stored to levels when not NULL. Returns the number of the sizes.
+ */
+int topology_working_sets(unsigned long long *sizes, int *levels, int max)
+{
+	unsigned long long under, over;
+	long size, next;
+	int level, last, num = 0;
+
+	last = topology_cache_levels();
+	for (level = 1; level <= last; level++) {
+		if ((size = cpu_cache_size_get(level)) <= 0)
+			continue;
+		next = (level < last) ? cpu_cache_size_get(level + 1) : 0;
+
+		under = (unsigned long long)size * 3 / 4;
+		over = (unsigned long long)size * 3 / 2;
+		if ((num < max) && ((num == 0) || (under > sizes[num - 1]))) {
+			if (levels != NULL)
+				levels[num] = level;
+			sizes[num++] = under;
+		}
+		if ((num < max) && ((next <= 0) || (over < (unsigned long long)next * 3 / 4))) {
+			if (levels != NULL)
+				levels[num] = level + 1;
+			sizes[num++] = over;
+		}
+	}
+
+	if ((last > 0) && (num < max)) {
+		if (levels != NULL)
+			levels[num] = last + 1;
+		sizes[num++] = 4ULL * cpu_cache_size_get(last);
+	}
+
+	return num;
+}
+
+/*
+ * Gets the first CPU of every physical core the process may run on, i.e. one CPU per core with the SMT
+ * siblings left out. Returns the number of the CPUs stored to cpus.
+ */
+int topology_core_cpus(int *cpus, int max)
+{
+	tCpuSet set;
+	char buf[1024];
+	int cpu, num = 0;
+
+	if ((num = cpu_affinity_get(0, &set)) < 0)
+		return num;
+
+	num = 0;
+	for (cpu = cpu_set_next(&set, -1); (cpu >= 0) && (num < max); cpu = cpu_set_next(&set, cpu)) {
+		if ((topology_read(cpu, "topology/thread_siblings_list", buf, sizeof(buf)) == 0) && (atoi(buf) != cpu))
+			continue;
+
+		cpus[num++] = cpu;
+	}
+
+	cpu_set_free(&set);
+	return num;
+}
+
+/* Returns 1 when the CPU is in the CPU list in the sysfs file of the other CPU, 0 otherwise */
+static int topology_list_has(int cpu, const char *name, int other)
+{
+	char buf[4096];
+	tCpuSet set;
+	int rc = 0;
+
+	if (topology_read(cpu, name, buf, sizeof(buf)) != 0)
+		return 0;
+	if (cpu_set_init(&set, 0) != 0)
+		return 0;
+
+	if (cpu_list_parse(buf, &set) > 0)
+		rc = cpu_set_isset(&set, other);
+
+	cpu_set_free(&set);
+	return rc;
+}
+
+/*
+ * Returns how close the two CPUs are: SMT siblings of one core, cores sharing the last level cache (e.g. one
+ * CCX), cores in one package or in the different packages.
+ */
+int topology_cpu_relation(int cpu1, int cpu2)
+{
+	char name[64], llc[64];
+	long level, last = 0;
+	int i;
+
+	if (topology_list_has(cpu1, "topology/thread_siblings_list", cpu2))
+		return TOPOLOGY_REL_SMT;
+
+	llc[0] = 0;
+	for (i = 0; ; i++) {
+		snprintf(name, sizeof(name), "cache/index%d/level", i);
+		if ((level = topology_read_long(cpu1, name)) < 0)
+			break;
+		if (level > last) {
+			last = level;
+			snprintf(llc, sizeof(llc), "cache/index%d/shared_cpu_list", i);
+		}
+	}
+	if ((llc[0] != 0) && topology_list_has(cpu1, llc, cpu2))
+		return TOPOLOGY_REL_LLC;
+
+	if (topology_read_long(cpu1, "topology/physical_package_id") == topology_read_long(cpu2, "topology/physical_package_id"))
+		return TOPOLOGY_REL_PACKAGE;
+
+	return TOPOLOGY_REL_REMOTE;
+}
+
+const char *topology_relation_name(int rel)
+{
+	if ((rel < 0) || (rel >= TOPOLOGY_REL_COUNT))
+		return NULL;
+
+	return topologyRelations[rel];
+}
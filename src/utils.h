@@ -21,6 +21,9 @@
  *
  */
 
+#ifndef MBENCH_UTILS_H
+#define MBENCH_UTILS_H
+
 #define _GNU_SOURCE
 #define _USE_GNU
 
@@ -36,7 +39,11 @@
 #include <fcntl.h>
 #include <netdb.h>
 #include <dirent.h>
+#include <pthread.h>
+#include <time.h>
+#include <ctype.h>
 #include <sys/time.h>
+#include <sys/syscall.h>
 #include <sys/resource.h>
 #include <sys/types.h>
 #include <sys/wait.h>
@@ -52,12 +59,337 @@
 #define PROCESSOR_COUNT_TOTAL(mask)		(mask & 0xffff)
 #define PROCESSOR_COUNT_ONLINE(mask)	(mask >> 16)
 
+/* Timer defines */
+#define NSEC_PER_SEC					1000000000ULL
+#define TIMER_SOURCE_AUTO				-1
+#define TIMER_SOURCE_CLOCK				0
+#define TIMER_SOURCE_TSC				1
+
+/* Whetstone modules */
+#define WHETSTONE_MODULE_ARRAY			0
+#define WHETSTONE_MODULE_ARRAY_PARAM	1
+#define WHETSTONE_MODULE_CONDITIONAL	2
+#define WHETSTONE_MODULE_INTEGER		3
+#define WHETSTONE_MODULE_TRIG			4
+#define WHETSTONE_MODULE_PROCEDURE		5
+#define WHETSTONE_MODULE_ARRAY_REF		6
+#define WHETSTONE_MODULE_STDFUNC		7
+#define WHETSTONE_MODULES				8
+
+/* Dhrystone score of VAX 11/780 used to get the DMIPS value */
+#define DHRYSTONE_VAX_SCORE				1757
+
+/*
+ * Microarchitecture levels the Dhrystone, Whetstone and classic Linpack kernels are built for. The kernel
+ * sources are built once more by isa-v2.c, isa-v3.c and isa-v4.c for every level above the baseline, with
+ * CPU_ISA_SUFFIX appended to all their global symbols. GCC 12 is needed to check the levels at runtime.
+ */
+#define CPU_ISA_BASELINE				0
+#define CPU_ISA_X86_64_V2				1
+#define CPU_ISA_X86_64_V3				2
+#define CPU_ISA_X86_64_V4				3
+#define CPU_ISA_COUNT					4
+
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(__clang__) && (__GNUC__ >= 12)
+#define CPU_ISA_VARIANTS
+#endif
+
+#ifdef CPU_ISA_SUFFIX
+#define CPU_ISA_CONCAT(name, suffix)	name##suffix
+#define CPU_ISA_NAME(name, suffix)		CPU_ISA_CONCAT(name, suffix)
+#define Proc0							CPU_ISA_NAME(Proc0, CPU_ISA_SUFFIX)
+#define Proc1							CPU_ISA_NAME(Proc1, CPU_ISA_SUFFIX)
+#define Proc2							CPU_ISA_NAME(Proc2, CPU_ISA_SUFFIX)
+#define Proc3							CPU_ISA_NAME(Proc3, CPU_ISA_SUFFIX)
+#define Proc4							CPU_ISA_NAME(Proc4, CPU_ISA_SUFFIX)
+#define Proc5							CPU_ISA_NAME(Proc5, CPU_ISA_SUFFIX)
+#define Proc6							CPU_ISA_NAME(Proc6, CPU_ISA_SUFFIX)
+#define Proc7							CPU_ISA_NAME(Proc7, CPU_ISA_SUFFIX)
+#define Proc8							CPU_ISA_NAME(Proc8, CPU_ISA_SUFFIX)
+#define Func1							CPU_ISA_NAME(Func1, CPU_ISA_SUFFIX)
+#define Func2							CPU_ISA_NAME(Func2, CPU_ISA_SUFFIX)
+#define Func3							CPU_ISA_NAME(Func3, CPU_ISA_SUFFIX)
+#define cpu_dhrystone_get				CPU_ISA_NAME(cpu_dhrystone_get, CPU_ISA_SUFFIX)
+#define cpu_dhrystone_threads_get		CPU_ISA_NAME(cpu_dhrystone_threads_get, CPU_ISA_SUFFIX)
+#define cpu_dhrystone_steady			CPU_ISA_NAME(cpu_dhrystone_steady, CPU_ISA_SUFFIX)
+#define cpu_whetstone_get				CPU_ISA_NAME(cpu_whetstone_get, CPU_ISA_SUFFIX)
+#define cpu_whetstone_threads_get		CPU_ISA_NAME(cpu_whetstone_threads_get, CPU_ISA_SUFFIX)
+#define cpu_whetstone_module_name		CPU_ISA_NAME(cpu_whetstone_module_name, CPU_ISA_SUFFIX)
+#define cpu_whetstone_module_unit		CPU_ISA_NAME(cpu_whetstone_module_unit, CPU_ISA_SUFFIX)
+#define get_linpack_score				CPU_ISA_NAME(get_linpack_score, CPU_ISA_SUFFIX)
+#define get_linpack_blocked_score		CPU_ISA_NAME(get_linpack_blocked_score, CPU_ISA_SUFFIX)
+#define get_linpack_threads_score		CPU_ISA_NAME(get_linpack_threads_score, CPU_ISA_SUFFIX)
+#define get_linpack_sweep				CPU_ISA_NAME(get_linpack_sweep, CPU_ISA_SUFFIX)
+#define get_linpack_precision_score		CPU_ISA_NAME(get_linpack_precision_score, CPU_ISA_SUFFIX)
+#define get_linpack_pages_score			CPU_ISA_NAME(get_linpack_pages_score, CPU_ISA_SUFFIX)
+#define get_linpack_simd_score			CPU_ISA_NAME(get_linpack_simd_score, CPU_ISA_SUFFIX)
+#define linpack_level_name				CPU_ISA_NAME(linpack_level_name, CPU_ISA_SUFFIX)
+#define linpack_precision_name			CPU_ISA_NAME(linpack_precision_name, CPU_ISA_SUFFIX)
+#define linpack_isa_name				CPU_ISA_NAME(linpack_isa_name, CPU_ISA_SUFFIX)
+#define linpack_isa_supported			CPU_ISA_NAME(linpack_isa_supported, CPU_ISA_SUFFIX)
+#define linpack_isa_best				CPU_ISA_NAME(linpack_isa_best, CPU_ISA_SUFFIX)
+#endif
+
+/* Linpack SIMD kernel instruction sets */
+#define LINPACK_ISA_GENERIC				0
+#define LINPACK_ISA_SSE2				1
+#define LINPACK_ISA_AVX2				2
+#define LINPACK_ISA_AVX512				3
+#define LINPACK_ISA_COUNT				4
+
+/* Linpack precisions */
+#define LINPACK_PREC_SINGLE				0
+#define LINPACK_PREC_DOUBLE				1
+#define LINPACK_PREC_MIXED				2
+#define LINPACK_PREC_COUNT				3
+
+/* Levels of the memory hierarchy of the Linpack size sweep */
+#define LINPACK_LEVEL_L1				0
+#define LINPACK_LEVEL_L2				1
+#define LINPACK_LEVEL_L3				2
+#define LINPACK_LEVEL_DRAM				3
+#define LINPACK_LEVEL_COUNT				4
+
+typedef struct {
+	int size;						/* the matrix is size x size */
+	unsigned long long wset;		/* working set in bytes */
+	float mflops;
+	int level;						/* LINPACK_LEVEL_* the working set fits into */
+} tLinpackSweep;
+
+/* Default Linpack array size of the parallel and precision runs */
+#define LINPACK_DEFAULT_SIZE			2000
+
+/* Thread defines */
+/* Relations of two CPUs, from the closest one */
+#define TOPOLOGY_REL_SMT				0
+#define TOPOLOGY_REL_LLC				1
+#define TOPOLOGY_REL_PACKAGE			2
+#define TOPOLOGY_REL_REMOTE				3
+#define TOPOLOGY_REL_COUNT				4
+
+/* Synchronization primitives and the contention cases */
+#define SYNC_MUTEX						0
+#define SYNC_SPINLOCK					1
+#define SYNC_RWLOCK						2
+#define SYNC_FUTEX						3
+#define SYNC_CAS						4
+#define SYNC_FETCH_ADD					5
+#define SYNC_PRIMITIVES					6
+#define SYNC_CONTENDED					0
+#define SYNC_UNCONTENDED				1
+#define SYNC_CASES						2
+
+/* Synchronization primitive throughput and fairness for the number of threads */
+typedef struct {
+	int threads;
+	float mops[SYNC_CASES];
+	float fairness[SYNC_CASES];
+} tSyncResults;
+
+/* System calls measured by the overhead benchmark and the context switch placements */
+#define SYSCALL_GETPID					0
+#define SYSCALL_READ					1
+#define SYSCALL_CLOCK_VDSO				2
+#define SYSCALL_CLOCK_RAW				3
+#define SYSCALL_CALLS					4
+#define CTXSW_SAME_CORE					0
+#define CTXSW_CROSS_CORE				1
+#define CTXSW_PLACEMENTS				2
+
+/* CPU frequency measurement methods */
+#define CPU_FREQ_MSR					0
+#define CPU_FREQ_LOOP					1
+
+/* CPU topology */
+#define TOPOLOGY_MAX_CACHES				16
+#define TOPOLOGY_MAX_LEVEL				4
+#define TOPOLOGY_MAX_SETS				(2 * TOPOLOGY_MAX_LEVEL + 1)
+
+typedef struct {
+	int level;
+	char type[16];					/* Data, Instruction or Unified */
+	long size;
+	int line;
+	int ways;
+	int shared;						/* number of the CPUs sharing the cache */
+} tCache;
+
+typedef struct {
+	int first;						/* first online CPU */
+	int cpus;
+	int packages;
+	int cores;
+	int smt;						/* threads per core */
+	int nodes;
+	int ncaches;
+	tCache caches[TOPOLOGY_MAX_CACHES];
+} tTopology;
+
+typedef struct tThreadGate tThreadGate;
+
+typedef struct {
+	int idx;						/* index of the thread in the run */
+	int num;						/* number of threads in the run */
+	int cpu;						/* CPU the thread is pinned to, -1 if not pinned */
+	pthread_barrier_t *barrier;		/* barrier shared by all threads of the run */
+	void *(*func)(void *);
+	tThreadGate *gate;
+} tThread;
+
+/* Dynamically sized set of CPUs, the machines may have more CPUs than fit cpu_set_t */
+typedef struct {
+	cpu_set_t *set;
+	size_t size;
+	int max;
+} tCpuSet;
+
 /* Memory defines */
 #define MEMTYPE_B						1
 #define MEMTYPE_KB						2
 #define MEMTYPE_MB						4
 #define MEMTYPE_GB						8
 
+/* Memory bandwidth (STREAM) kernels and store modes */
+#define MEMBW_COPY						0
+#define MEMBW_SCALE						1
+#define MEMBW_ADD						2
+#define MEMBW_TRIAD						3
+#define MEMBW_KERNELS					4
+#define MEMBW_MODE_REGULAR				0
+#define MEMBW_MODE_NT					1
+#define MEMBW_MODES						2
+
+/* Memory page types */
+#define MEMPAGE_DEFAULT					-1
+#define MEMPAGE_BASE					0
+#define MEMPAGE_THP						1
+#define MEMPAGE_HUGETLB					2
+#define MEMPAGE_COUNT					3
+
+/* Memory allocator workloads */
+#define ALLOC_MALLOC					0
+#define ALLOC_REALLOC					1
+#define ALLOC_MEMALIGN					2
+#define ALLOC_CROSS						3
+#define ALLOC_WORKLOADS					4
+
+/* Allocator throughput and the resident set size for the number of threads */
+typedef struct {
+	int threads;
+	float mops[ALLOC_WORKLOADS];
+	unsigned long rss[ALLOC_WORKLOADS];
+} tAllocResults;
+
+/* Statistics of the samples of one metric of a repeated benchmark */
+typedef struct {
+	int runs;
+	int warmup;
+	int outliers;
+	int converged;			/* the confidence interval was met */
+	double median;
+	double mean;
+	double stddev;
+	double p5;
+	double p95;
+	double ci_low;			/* 95% confidence interval of the mean */
+	double ci_high;
+} tStats;
+
+typedef struct {
+	char name[40];
+	const char *unit;
+	tStats stats;
+} tStatsResult;
+
+/* Sustained runs are sampled in these intervals, the disk is written by the chunks of this size */
+#define STEADY_TIME						60
+#define STEADY_INTERVAL					250000000ULL
+#define STEADY_DISK_CHUNK				(1 << 20)
+
+/* Work done in the short intervals of a sustained run */
+typedef struct {
+	unsigned long long start;
+	unsigned long long interval;
+	int size;
+	double *work;
+} tSteady;
+
+/* Burst and steady-state throughput of a sustained run, the rates are per interval */
+typedef struct {
+	int samples;
+	float interval;			/* seconds */
+	double burst;
+	double steady;
+	float settle;			/* seconds to the steady state */
+	float slope;			/* change in the second half, % of the steady state per minute */
+	int settled;
+	int degrading;
+	double *rate;
+} tSteadyResults;
+
+/* Performance counters of the benchmark regions */
+#define PERF_CYCLES						0
+#define PERF_INSTRUCTIONS				1
+#define PERF_CACHE_MISSES				2
+#define PERF_BRANCH_MISSES				3
+#define PERF_CTX_SWITCHES				4
+#define PERF_EVENTS						5
+#define PERF_VALID(c, event)			((c)->valid & (1 << (event)))
+
+typedef struct {
+	int fd[PERF_EVENTS];
+} tPerf;
+
+typedef struct {
+	int valid;
+	unsigned long long value[PERF_EVENTS];
+} tPerfCounts;
+
+/* Counters of one benchmark region and the work done by it, e.g. the bytes written */
+typedef struct {
+	char benchmark[16];
+	char operation[16];
+	unsigned long chunk_size;
+	unsigned long long work;
+	const char *unit;
+	tPerfCounts counts;
+} tPerfRegion;
+
+/* Memory copy and fill functions and the source/destination alignment cases */
+#define COPY_MEMCPY						0
+#define COPY_MEMCPY_NT					1
+#define COPY_MEMMOVE					2
+#define COPY_MEMSET						3
+#define COPY_MEMSET_NT					4
+#define COPY_FUNCS						5
+#define COPY_ALIGNS						4
+#define COPY_MIN_SIZE					8ULL
+#define COPY_SIZE_STEP					4
+#define COPY_MAX_SIZE					(512ULL << 20)
+
+/* Throughput in GB/s of every function and alignment for the block size */
+typedef struct {
+	unsigned long long size;
+	float gbps[COPY_FUNCS][COPY_ALIGNS];
+} tCopyResults;
+
+/* Memory latency for the working set */
+typedef struct {
+	unsigned long long size;
+	float ns[MEMPAGE_COUNT];
+} tMemLatency;
+
+#define MEMLAT_MIN_SIZE					(4ULL << 10)
+
+/* First-touch page fault throughput and the munmap cost for the number of threads */
+typedef struct {
+	int threads;
+	float gbps[MEMPAGE_COUNT];
+	float faults[MEMPAGE_COUNT];	/* thousands of the page faults per second */
+	float unmap;					/* munmap of a touched region in ns */
+} tFaultResults;
+
 #define DISPLAY_VARMEM(var) memory_display((char*) &( var ), (sizeof( var )));
 #define DISPLAY_PTRMEM(ptr) memory_display((char*) ( ptr ), (sizeof( *ptr )));
 
@@ -75,24 +407,138 @@
 #define NET_IPV6						2
 
 /* Common functions */
+int					timer_init(int source);
+int					timer_info_get(double *resolution, double *overhead, double *tscMHz);
+const char			*timer_source_name(int source);
 unsigned long long	nanotime(void);
 int					io_get_size(unsigned long long size, int prec, char *sizestr, int maxlen);
 int					io_get_size_double(double size, int prec, char *sizestr, int maxlen);
 double				cpu_time_get();
 float				calc_cpu_usage(float cpu, float tm);
 
+/* Statistics functions */
+int			stats_compute(double *samples, int n, tStats *st);
+double		stats_ci_pct(tStats *st);
+int			stats_repeat(int (*func)(void *, double *), void *arg, int num, double ci, unsigned long long budget,
+				tStats *st);
+
 /* CPU functions */
-int 		cpu_affinity_set(pid_t pid, uint64_t cmask);
-int 		cpu_affinity_get(pid_t pid, uint64_t *cmask);
+unsigned long long	rdtsc(void);
+int			cpu_set_init(tCpuSet *set, int max);
+void		cpu_set_free(tCpuSet *set);
+int			cpu_set_add(tCpuSet *set, int cpu);
+int			cpu_set_isset(const tCpuSet *set, int cpu);
+int			cpu_set_count(const tCpuSet *set);
+int			cpu_set_next(const tCpuSet *set, int cpu);
+char		*cpu_set_format(const tCpuSet *set, int list);
+int			cpu_set_parse(const char *str, tCpuSet *set);
+int 		cpu_affinity_set(pid_t pid, const tCpuSet *set);
+int 		cpu_affinity_get(pid_t pid, tCpuSet *set);
+int			cpu_affinity_set_cpu(pid_t pid, int cpu);
+int			cpu_thread_count(void);
+int			cpu_thread_get_cpu(int idx);
+int			cpu_threads_run(int num, void *(*func)(void *), void *args, size_t argsize);
+int			cpu_threads_run_on(int num, int *cpus, void *(*func)(void *), void *args, size_t argsize);
+long		cpu_cache_size_get(int level);
+int			cpu_list_parse(const char *list, tCpuSet *set);
 float 		cpu_get_speed_mhz(void);
+int			cpu_freq_method(int cpu);
+const char	*cpu_freq_method_name(int method);
+int			cpu_freq_get(int num, int *cpus, int method, double tscMHz, float *mhz);
+int			cpu_c2c_latency_get(int cpu1, int cpu2, double *ns);
+int			sync_get(int primitive, int scase, int threads, float *mops, float *fairness);
+const char	*sync_primitive_name(int primitive);
+const char	*sync_case_name(int scase);
+int			syscall_latency_get(int call, double *ns);
+int			syscall_ctxsw_get(int process, int cpu1, int cpu2, double *ns);
+const char	*syscall_call_name(int call);
+const char	*syscall_ctxsw_name(int process);
 void 		cpu_dhrystone_get(unsigned long *dhry, unsigned long *loops, unsigned long *tm);
-void	 	cpu_whetstone_get(unsigned long *loops, unsigned long *iter, unsigned long *btime, unsigned long *mips);
+int			cpu_dhrystone_threads_get(int threads, int *cpus, unsigned long *dhry);
+int			cpu_dhrystone_steady(int threads, unsigned long long duration, unsigned long long interval, tSteady *s);
+void	 	cpu_whetstone_get(unsigned long *loops, unsigned long *iter, unsigned long *btime, unsigned long *mips, float *modules);
+int			cpu_whetstone_threads_get(int threads, int *cpus, unsigned long *mips, float *modules);
+const char	*cpu_whetstone_module_name(int idx);
+const char	*cpu_whetstone_module_unit(int idx);
 int 		get_linpack_score(int arsize, unsigned long *memory, float *minMFLOPS, float *maxMFLOPS, float *avgMFLOPS);
+int 		get_linpack_blocked_score(int arsize, unsigned long *memory, float *minMFLOPS, float *maxMFLOPS, float *avgMFLOPS);
+int			get_linpack_threads_score(int threads, int arsize, unsigned long *memory, int *cpus, float *gflops, float *total);
+int			get_linpack_sweep(unsigned long long maxmem, tLinpackSweep **points);
+const char	*linpack_level_name(int level);
+int			get_linpack_precision_score(int precision, int arsize, unsigned long *memory, float *gflops, double *residual,
+						int *iters);
+const char	*linpack_precision_name(int precision);
+int			get_linpack_pages_score(int pages, int arsize, unsigned long *memory, float *minMFLOPS, float *maxMFLOPS,
+				float *avgMFLOPS);
+int 		get_linpack_simd_score(int isa, int arsize, unsigned long *memory, float *minMFLOPS, float *maxMFLOPS, float *avgMFLOPS);
+const char	*linpack_isa_name(int isa);
+int			linpack_isa_supported(int isa);
+int			linpack_isa_best(void);
 uint32_t 	cpu_get_count(void);
 
+/* Kernels of the microarchitecture levels */
+const char	*cpu_isa_name(int level);
+int			cpu_isa_parse(const char *name);
+int			cpu_isa_supported(int level);
+int			cpu_isa_best(void);
+int			cpu_isa_dhrystone_get(int level, unsigned long *dhry, unsigned long *loops, unsigned long *tm);
+int			cpu_isa_whetstone_get(int level, unsigned long *loops, unsigned long *iter, unsigned long *btime,
+				unsigned long *mips, float *modules);
+int			cpu_isa_linpack_score(int level, int arsize, unsigned long *memory, float *minMFLOPS, float *maxMFLOPS,
+				float *avgMFLOPS);
+
+/* Topology functions */
+int			topology_get(tTopology *topo);
+int			topology_cache_levels(void);
+int			topology_working_sets(unsigned long long *sizes, int *levels, int max);
+int			topology_core_cpus(int *cpus, int max);
+int			topology_cpu_relation(int cpu1, int cpu2);
+const char	*topology_relation_name(int rel);
+
 /* Memory functions */
 float 		memory_size_get(int type);
 void 		memory_display(char *address, int length);
+unsigned long long	memory_bandwidth_size_default(void);
+int			memory_bandwidth_get(int threads, int nt, unsigned long long size, int pages, int node, int *cpus, float *gbps,
+				float *total);
+const char	*memory_bandwidth_kernel_name(int kernel);
+unsigned long	memory_hugepage_size(void);
+void		*memory_map(size_t size, int pages, int node, size_t *mapped);
+const char	*memory_page_name(int pages);
+int			memory_latency_get(unsigned long long size, int pages, int node, double *ns);
+int			memory_nodes_get(uint64_t *mask);
+int			memory_node_cpus(int node, tCpuSet *cpus);
+unsigned long long	memory_node_size(int node);
+int			memory_node_bind(void *addr, size_t len, int node);
+size_t		memory_fault_size(int threads);
+int			memory_fault_get(int threads, int pages, float *gbps, float *faults);
+int			memory_populate_get(int pages, int populate, size_t size, float *gbps);
+int			memory_unmap_get(int threads, double *ns);
+int			alloc_get(int workload, int threads, float *mops, unsigned long *rss);
+unsigned long	alloc_peak_rss(void);
+char		*alloc_name(char *buf, int len);
+const char	*alloc_workload_name(int workload);
+int			copy_get(unsigned long long maxsize, tCopyResults *res, int num);
+int			copy_sizes(unsigned long long maxsize);
+const char	*copy_func_name(int func);
+void		copy_align_get(int align, int *src, int *dst);
+
+/* Steady-state functions */
+int			steady_init(tSteady *s, unsigned long long start, unsigned long long duration, unsigned long long interval);
+void		steady_free(tSteady *s);
+void		steady_tick(tSteady *s, double work);
+void		steady_merge(tSteady *dst, tSteady *src);
+int			steady_analyze(tSteady *s, double scale, tSteadyResults *r);
+void		steady_results_free(tSteadyResults *r);
+
+/* Performance counter functions */
+int			perf_open(tPerf *p);
+void		perf_close(tPerf *p);
+void		perf_start(tPerf *p);
+void		perf_stop(tPerf *p, tPerfCounts *c);
+double		perf_ipc(tPerfCounts *c);
+double		perf_cycles_per(tPerfCounts *c, unsigned long long work);
+const char	*perf_event_name(int event);
 
 /* Disk I/O functions */
 void 		disk_set_temp(char *tmp);
@@ -102,6 +548,7 @@ float 		disk_throughput_putc(long size, float *fcpu);
 float		disk_throughput_read(long chunkSize, float *fcpu);
 float 		disk_throughput_read_random(long chunkSize, int numSequences, float *fcpu);
 void 		disk_temp_cleanup();
+float		disk_throughput_steady(int chunkSize, long size, tSteady *s, float *fcpu);
 float		disk_benchmark_create(int numFiles, float *fcpu);
 float		disk_benchmark_delete(long *numFiles, float *fcpu);
 
@@ -123,21 +570,121 @@ typedef struct {
 	float cpu_usage;
 } tIOResults;
 
+typedef struct {
+	int threads;
+	float total;
+	float efficiency;
+	int *cpu;
+	float *score;
+	float *detail;					/* per-thread details, threads * number of details */
+} tScaleResults;
+
 typedef struct {
 	float run_time;
+	tTopology topology;
+	int topology_sets_size;
+	unsigned long long topology_sets[TOPOLOGY_MAX_SETS];
+	int topology_sets_level[TOPOLOGY_MAX_SETS];
+	int timer_source;
+	double timer_resolution;
+	double timer_overhead;
+	double timer_tsc_mhz;
 	int cpus;
-	uint64_t cpumask;
+	char *cpumask;
+	char *cpulist;
 	int cpu_total;
 	int cpu_online;
 	float cpu_speed;
+	int cpu_freq_method;
+	float cpu_freq_tsc;
+	int cpu_freq_cores;
+	int cpu_freq_loads;
+	int *cpu_freq_cpu;
+	float *cpu_freq_single;
+	float *cpu_freq_load;			/* cpu_freq_loads rows of cpu_freq_cores, the MHz of the first n cores with n loaded */
+	int cpu_c2c_size;
+	int *cpu_c2c_cpu;
+	int *cpu_c2c_rel;
+	float *cpu_c2c_lat;				/* cpu_c2c_size x cpu_c2c_size, one-way latency in ns */
+	int cpu_sync_size;
+	tSyncResults *cpu_sync[SYNC_PRIMITIVES];
+	float sys_call[SYSCALL_CALLS];
+	int sys_ctxsw_cpu[CTXSW_PLACEMENTS + 1];	/* the first CPU and the second CPU of every placement */
+	float sys_ctxsw[2][CTXSW_PLACEMENTS];		/* threads and processes, 0 when not available */
 	float cpu_dhrystone;
+	int cpu_dhrystone_scale_size;
+	tScaleResults *cpu_dhrystone_scale;
 	unsigned long cpu_whetstone;
+	float cpu_whetstone_modules[WHETSTONE_MODULES];
+	int cpu_whetstone_scale_size;
+	tScaleResults *cpu_whetstone_scale;
+	int cpu_linpack_scale_arsize;
+	int cpu_linpack_scale_size;
+	tScaleResults *cpu_linpack_scale;
+	int cpu_linpack_prec_arsize;
+	float cpu_linpack_prec_gflops[LINPACK_PREC_COUNT];
+	double cpu_linpack_prec_residual[LINPACK_PREC_COUNT];
+	int cpu_linpack_prec_iters[LINPACK_PREC_COUNT];
+	int cpu_linpack_sweep_size;
+	tLinpackSweep *cpu_linpack_sweep;
 	int cpu_linpack_size;
 	long cpu_linpack_mem;
 	float cpu_linpack_min;
 	float cpu_linpack_max;
 	float cpu_linpack_avg;
+	float cpu_linpack_blk_min;
+	float cpu_linpack_blk_max;
+	float cpu_linpack_blk_avg;
+	int cpu_linpack_blk_isa;
+	int cpu_linpack_simd_isa;
+	float cpu_linpack_simd_min[LINPACK_ISA_COUNT];
+	float cpu_linpack_simd_max[LINPACK_ISA_COUNT];
+	float cpu_linpack_simd_avg[LINPACK_ISA_COUNT];
+	int cpu_isa;					/* level of the kernels of the single-threaded scores */
+	int cpu_isa_linpack_size;
+	float cpu_isa_dhrystone[CPU_ISA_COUNT];
+	unsigned long cpu_isa_whetstone[CPU_ISA_COUNT];
+	float cpu_isa_linpack[CPU_ISA_COUNT];
 	float memory_size;
+	unsigned long long memory_bw_arsize;
+	int memory_bw_scale_size[MEMBW_MODES];
+	tScaleResults *memory_bw_scale[MEMBW_MODES][MEMBW_KERNELS];
+	float memory_lat_mhz;
+	int memory_lat_size;
+	tMemLatency *memory_lat;
+	unsigned long long memory_numa_arsize;
+	int memory_fault_size;
+	unsigned long long memory_fault_region;
+	int memory_fault_err[MEMPAGE_COUNT];
+	float memory_populate[MEMPAGE_COUNT][2];	/* lazy faulting and populated, GB/s */
+	tFaultResults *memory_fault;
+	char memory_alloc_name[32];
+	int memory_alloc_size;
+	unsigned long memory_alloc_peak;
+	tAllocResults *memory_alloc;
+	int memory_copy_size;
+	tCopyResults *memory_copy;
+	int memory_numa_size;
+	int *memory_numa_node;
+	float *memory_numa_bw;
+	float *memory_numa_lat;
+	unsigned long long memory_pages_arsize;
+	int memory_pages_lpsize;
+	float memory_pages_mhz;
+	int memory_pages_err[MEMPAGE_COUNT];
+	float memory_pages_lat[MEMPAGE_COUNT];
+	float memory_pages_bw[MEMPAGE_COUNT];
+	float memory_pages_linpack[MEMPAGE_COUNT];
+	int steady_time;
+	int steady_cpu_threads;
+	tSteadyResults steady_cpu;
+	int steady_disk_done;
+	tSteadyResults steady_disk;
+	int stats_size;
+	tStatsResult *stats;
+	int perf_err;
+	int perf_size;
+	tPerfRegion *perf;
 	int disk_drop_caches;
 	int disk_res_size;
 	tIOResults *disk;
@@ -146,3 +693,5 @@ typedef struct {
 } tResults;
 
 tResults *results;
+
+#endif
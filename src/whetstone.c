@@ -73,14 +73,9 @@ C**********************************************************************
 */
 
 /* standard C library headers required */
-#include <stdlib.h>
-#include <stdio.h>
-#include <string.h>
+#include "utils.h"
 #include <math.h>
 
-/* the following is optional depending on the timing function used */
-#include <time.h>
-
 /* map the FORTRAN math functions, etc. to the C versions */
 #define DSIN	sin
 #define DCOS	cos
@@ -90,26 +85,80 @@ C**********************************************************************
 #define DSQRT	sqrt
 #define IF		if
 
-/* function prototypes */
-void POUT(long N, long J, long K, double X1, double X2, double X3, double X4);
-void PA(double E[]);
-void P0(void);
-void P3(double X, double Y, double *Z);
-#define USAGE	"usage: whetdc [-c] [loops]\n"
+/* Minimal time of the benchmark run in nanoseconds, the loop count is doubled until it's reached */
+#define WHETSTONE_MIN_TIME	200000000ULL
 
 /*
 	COMMON T,T1,T2,E1(4),J,K,L
+
+	The COMMON block lives in the context structure instead of globals so
+	the benchmark is reentrant and several instances can run at once.
 */
-double T,T1,T2,E1[5];
-int J,K,L;
+typedef struct {
+	double T,T1,T2,E1[5];
+	int J,K,L;
+
+	unsigned long wuLoops;
+	unsigned long wuIterations;
+	unsigned long wuTime;
+	unsigned long wuMIPS;
+	unsigned long long wuModuleTime[WHETSTONE_MODULES];
+} tWhetContext;
+
+/*
+ * Module table, indexed by WHETSTONE_MODULE_* values. The number of operations per loop iteration is
+ * the count of floating point operations for the floating point modules, integer operations/statements
+ * for the integer modules and math library calls for the trigonometric and standard function modules.
+ */
+static const struct {
+	const char *name;
+	const char *unit;
+	long mult;		/* loop count is mult * LOOP */
+	long ops;		/* operations per loop iteration */
+} whetModules[WHETSTONE_MODULES] = {
+	{ "array",			"MFLOPS",	12,		16 },	/* Module 2 */
+	{ "array-param",	"MFLOPS",	14,		96 },	/* Module 3 */
+	{ "conditional",	"MOPS",		345,	3 },	/* Module 4 */
+	{ "integer",		"MOPS",		210,	15 },	/* Module 6 */
+	{ "trig",			"MOPS",		32,		10 },	/* Module 7 */
+	{ "procedure",		"MFLOPS",	899,	6 },	/* Module 8 */
+	{ "array-ref",		"MOPS",		616,	3 },	/* Module 9 */
+	{ "sqrt-exp-log",	"MOPS",		93,		3 },	/* Module 11 */
+};
+
+/* function prototypes */
+void POUT(long N, long J, long K, double X1, double X2, double X3, double X4);
+static void PA(tWhetContext *ctx, double E[]);
+static void P0(tWhetContext *ctx);
+static void P3(tWhetContext *ctx, double X, double Y, double *Z);
+#define USAGE	"usage: whetdc [-c] [loops]\n"
 
-unsigned long wuLoops;
-unsigned long wuIterations;
-unsigned long wuTime;
-unsigned long wuMIPS;
+/* map the COMMON block variables to the context */
+#define T	(ctx->T)
+#define T1	(ctx->T1)
+#define T2	(ctx->T2)
+#define E1	(ctx->E1)
+#define J	(ctx->J)
+#define K	(ctx->K)
+#define L	(ctx->L)
 
-int
-get_whetstone()
+/* mark the end of the module in the context and start timing of the next one */
+#define MODULE_END(idx)	{ unsigned long long now = nanotime(); ctx->wuModuleTime[idx] += now - modstart; modstart = now; }
+
+/*
+ * Modern compilers fold or drop whole modules whose results are never used (e.g. the trigonometric loop)
+ * which makes the per-module timing meaningless. KEEP_INT() and KEEP_FP() make the value opaque to the
+ * optimizer without emitting any instruction so every loop iteration is really executed.
+ */
+#define KEEP_INT(x)	__asm__ __volatile__("" : "+r" (x))
+#if defined(__x86_64__) || defined(__i386__)
+#define KEEP_FP(x)	__asm__ __volatile__("" : "+x" (x))
+#else
+#define KEEP_FP(x)	__asm__ __volatile__("" : "+m" (x))
+#endif
+
+static int
+get_whetstone(tWhetContext *ctx)
 {
 	/* used in the FORTRAN version */
 	long I;
@@ -120,20 +169,20 @@ get_whetstone()
 
 	/* added for this version */
 	long loopstart;
-	long startsec, finisec;
+	unsigned long long startsec, finisec, modstart;
 	float MIPS;
-	int continuous;
 
 	loopstart = 250000;		/* see the note about LOOP below */
-	continuous = 0;
 
 LCONT:
+	memset(ctx->wuModuleTime, 0, sizeof(ctx->wuModuleTime));
 /*
 C
 C	Start benchmark timing at this point.
 C
 */
-	startsec = time(0);
+	startsec = nanotime();
+	modstart = startsec;
 
 /*
 C
@@ -186,6 +235,7 @@ C
 #ifdef PRINTOUT
 	IF (JJ==II)POUT(N1,N1,N1,X1,X2,X3,X4);
 #endif
+	modstart = nanotime();
 
 /*
 C
@@ -203,6 +253,7 @@ C
 	    E1[3] = ( E1[1] - E1[2] + E1[3] + E1[4]) * T;
 	    E1[4] = (-E1[1] + E1[2] + E1[3] + E1[4]) * T;
 	}
+	MODULE_END(WHETSTONE_MODULE_ARRAY);
 
 #ifdef PRINTOUT
 	IF (JJ==II)POUT(N2,N3,N2,E1[1],E1[2],E1[3],E1[4]);
@@ -214,7 +265,8 @@ C	Module 3: Array as parameter
 C
 */
 	for (I = 1; I <= N3; I++)
-		PA(E1);
+		PA(ctx, E1);
+	MODULE_END(WHETSTONE_MODULE_ARRAY_PARAM);
 
 #ifdef PRINTOUT
 	IF (JJ==II)POUT(N3,N2,N2,E1[1],E1[2],E1[3],E1[4]);
@@ -241,7 +293,9 @@ C
 			J = 1;
 		else
 			J = 0;
+		KEEP_INT(J);
 	}
+	MODULE_END(WHETSTONE_MODULE_CONDITIONAL);
 
 #ifdef PRINTOUT
 	IF (JJ==II)POUT(N4,J,J,X1,X2,X3,X4);
@@ -264,7 +318,9 @@ C
 	    L = (L-K) * (K+J);
 	    E1[L-1] = J + K + L;
 	    E1[K-1] = J * K * L;
+	    KEEP_INT(J);
 	}
+	MODULE_END(WHETSTONE_MODULE_INTEGER);
 
 #ifdef PRINTOUT
 	IF (JJ==II)POUT(N6,J,K,E1[1],E1[2],E1[3],E1[4]);
@@ -282,6 +338,9 @@ C
 		X = T * DATAN(T2*DSIN(X)*DCOS(X)/(DCOS(X+Y)+DCOS(X-Y)-1.0));
 		Y = T * DATAN(T2*DSIN(Y)*DCOS(Y)/(DCOS(X+Y)+DCOS(X-Y)-1.0));
 	}
+	KEEP_FP(X);
+	KEEP_FP(Y);
+	MODULE_END(WHETSTONE_MODULE_TRIG);
 
 #ifdef PRINTOUT
 	IF (JJ==II)POUT(N7,J,K,X,X,Y,Y);
@@ -296,8 +355,12 @@ C
 	Y = 1.0;
 	Z = 1.0;
 
-	for (I = 1; I <= N8; I++)
-		P3(X,Y,&Z);
+	for (I = 1; I <= N8; I++) {
+		KEEP_FP(X);
+		P3(ctx,X,Y,&Z);
+		KEEP_FP(Z);
+	}
+	MODULE_END(WHETSTONE_MODULE_PROCEDURE);
 
 #ifdef PRINTOUT
 	IF (JJ==II)POUT(N8,J,K,X,Y,Z,Z);
@@ -316,7 +379,8 @@ C
 	E1[3] = 3.0;
 
 	for (I = 1; I <= N9; I++)
-		P0();
+		P0(ctx);
+	MODULE_END(WHETSTONE_MODULE_ARRAY_REF);
 
 #ifdef PRINTOUT
 	IF (JJ==II)POUT(N9,J,K,E1[1],E1[2],E1[3],E1[4]);
@@ -336,6 +400,7 @@ C
 	    J = K - J;
 	    K = K - J - J;
 	}
+	modstart = nanotime();
 
 #ifdef PRINTOUT
 	IF (JJ==II)POUT(N10,J,K,X1,X2,X3,X4);
@@ -350,6 +415,8 @@ C
 
 	for (I = 1; I <= N11; I++)
 		X = DSQRT(DEXP(DLOG(X)/T1));
+	KEEP_FP(X);
+	MODULE_END(WHETSTONE_MODULE_STDFUNC);
 
 #ifdef PRINTOUT
 	IF (JJ==II)POUT(N11,J,K,X,X,X,X);
@@ -368,7 +435,7 @@ C
 C      Stop benchmark timing at this point.
 C
 */
-	finisec = time(0);
+	finisec = nanotime();
 
 /*
 C----------------------------------------------------------------
@@ -379,38 +446,113 @@ C
 C      where TIME is in seconds.
 C--------------------------------------------------------------------
 */
-	if (finisec-startsec <= 0) {
+	if (finisec-startsec < WHETSTONE_MIN_TIME) {
 		loopstart *= 2;
 		goto LCONT;
 	}
 
-	MIPS = ((100.0*LOOP*II)/(float)(finisec-startsec) / 1000.0);
+	MIPS = ((100.0*LOOP*II)/((double)(finisec-startsec) / NSEC_PER_SEC) / 1000.0);
 
-	wuLoops = LOOP;
-	wuIterations = II;
-	wuTime = finisec-startsec;
-	wuMIPS = (unsigned long)MIPS;
+	ctx->wuLoops = LOOP;
+	ctx->wuIterations = II;
+	ctx->wuTime = (finisec-startsec) / NSEC_PER_SEC;
+	ctx->wuMIPS = (unsigned long)MIPS;
 
 	return(0);
 }
 
-void cpu_whetstone_get(unsigned long *loops, unsigned long *iter, unsigned long *btime, unsigned long *mips)
+const char *cpu_whetstone_module_name(int idx)
+{
+	return ((idx >= 0) && (idx < WHETSTONE_MODULES)) ? whetModules[idx].name : NULL;
+}
+
+const char *cpu_whetstone_module_unit(int idx)
+{
+	return ((idx >= 0) && (idx < WHETSTONE_MODULES)) ? whetModules[idx].unit : NULL;
+}
+
+/* Fills the modules[] array with per-module throughput in millions of operations per second */
+static void whetstone_modules_get(tWhetContext *ctx, float *modules)
 {
-	get_whetstone();
+	int i;
+
+	if (modules == NULL)
+		return;
+
+	for (i = 0; i < WHETSTONE_MODULES; i++) {
+		double ops = (double)whetModules[i].mult * ctx->wuLoops * ctx->wuIterations * whetModules[i].ops;
+
+		modules[i] = (ctx->wuModuleTime[i] > 0) ? (float)(ops * 1000.0 / ctx->wuModuleTime[i]) : 0.0;
+	}
+}
+
+void cpu_whetstone_get(unsigned long *loops, unsigned long *iter, unsigned long *btime, unsigned long *mips, float *modules)
+{
+	tWhetContext ctx;
+
+	memset(&ctx, 0, sizeof(ctx));
+	get_whetstone(&ctx);
 
 	if (loops != NULL)
-		*loops = wuLoops;
+		*loops = ctx.wuLoops;
 	if (iter != NULL)
-		*iter = wuIterations;
+		*iter = ctx.wuIterations;
 	if (btime != NULL)
-		*btime = wuTime;
+		*btime = ctx.wuTime;
 	if (mips != NULL)
-		*mips = wuMIPS;
+		*mips = ctx.wuMIPS;
 
+	whetstone_modules_get(&ctx, modules);
 }
 
-void
-PA(double E[])
+typedef struct {
+	tThread thread;
+	tWhetContext ctx;
+} tWhetThread;
+
+static void *cpu_whetstone_thread(void *arg)
+{
+	tWhetThread *t = (tWhetThread *)arg;
+
+	get_whetstone(&t->ctx);
+	return NULL;
+}
+
+/*
+ * Runs threads instances of the Whetstone benchmark at once, each pinned to its own CPU. The MIPS value of
+ * each thread goes to mips[], per-module throughput to modules[] (WHETSTONE_MODULES entries per thread)
+ * and the CPU the thread was running on to cpus[].
+ */
+int cpu_whetstone_threads_get(int threads, int *cpus, unsigned long *mips, float *modules)
+{
+	tWhetThread *t;
+	int i, rc;
+
+	if (threads <= 0)
+		return -EINVAL;
+
+	t = (tWhetThread *)malloc( threads * sizeof(tWhetThread) );
+	if (t == NULL)
+		return -ENOMEM;
+	memset(t, 0, threads * sizeof(tWhetThread));
+
+	rc = cpu_threads_run(threads, cpu_whetstone_thread, t, sizeof(tWhetThread));
+
+	for (i = 0; i < threads; i++) {
+		if (cpus != NULL)
+			cpus[i] = t[i].thread.cpu;
+		if (mips != NULL)
+			mips[i] = t[i].ctx.wuMIPS;
+		if (modules != NULL)
+			whetstone_modules_get(&t[i].ctx, &modules[i * WHETSTONE_MODULES]);
+	}
+
+	free(t);
+	return rc;
+}
+
+static void
+PA(tWhetContext *ctx, double E[])
 {
 	J = 0;
 
@@ -425,16 +567,16 @@ L10:
 		goto L10;
 }
 
-void
-P0(void)
+static void
+P0(tWhetContext *ctx)
 {
 	E1[J] = E1[K];
 	E1[K] = E1[L];
 	E1[L] = E1[J];
 }
 
-void
-P3(double X, double Y, double *Z)
+static void
+P3(tWhetContext *ctx, double X, double Y, double *Z)
 {
 	double X1, Y1;
 
@@ -445,6 +587,14 @@ P3(double X, double Y, double *Z)
 	*Z  = (X1 + Y1) / T2;
 }
 
+#undef T
+#undef T1
+#undef T2
+#undef E1
+#undef J
+#undef K
+#undef L
+
 #ifdef PRINTOUT
 void
 POUT(long N, long J, long K, double X1, double X2, double X3, double X4)